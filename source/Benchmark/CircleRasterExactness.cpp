@@ -0,0 +1,77 @@
+// Copyright (c) 2010 - 2014 Leap Motion. All rights reserved. Proprietary and confidential.
+#include "common.h"
+#include "Overlay/CircleRaster.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static const char USAGE[] =
+  "Usage: CircleRasterExactness [circles [seed]]\n"
+  "Draws seeded random circles with every CircleRaster path this processor supports, and fails unless each\n"
+  "path writes exactly the pixels of the scalar one";
+
+// Compares the paths on one circle, reporting the first pixel which differs
+static bool CompareCircle(const CircleRaster& circle, long width, long height, int index) {
+  std::vector<uint32_t> expected(width*height, 0xDEADBEEF);
+  circle.DrawWith(CircleRaster::PATH_SCALAR, &expected[0]);
+
+  const CircleRaster::Path paths[] = {CircleRaster::PATH_SSE, CircleRaster::PATH_AVX2};
+  for (size_t p = 0; p < sizeof(paths)/sizeof(paths[0]); p++) {
+    if (paths[p] == CircleRaster::PATH_AVX2 && CircleRaster::BestPath() != CircleRaster::PATH_AVX2) {
+      continue;
+    }
+    std::vector<uint32_t> actual(width*height, 0xDEADBEEF);
+    circle.DrawWith(paths[p], &actual[0]);
+    for (long i = 0; i < width*height; i++) {
+      if (actual[i] != expected[i]) {
+        std::cerr << "Circle " << index << ": " << CircleRaster::PathName(paths[p]) << " wrote " << std::hex
+                  << actual[i] << " at (" << std::dec << i % width << ", " << i / width << "), where "
+                  << CircleRaster::PathName(CircleRaster::PATH_SCALAR) << " wrote " << std::hex << expected[i]
+                  << std::dec << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 3) {
+    std::cerr << USAGE << std::endl;
+    return 1;
+  }
+  const int circles = argc > 1 ? std::atoi(argv[1]) : 2000;
+  const unsigned long seed = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1;
+
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  int failures = 0;
+  for (int i = 0; i < circles; i++) {
+    // odd sizes and offsets, so that the vector paths also draw partial groups at the ends of rows
+    const long width = 16 + static_cast<long>(unit(random)*240);
+    const long height = 16 + static_cast<long>(unit(random)*240);
+    const Vector2 centerOffset((unit(random) - 0.5)*width/2, (unit(random) - 0.5)*height/2);
+    const double angle = unit(random)*2*3.14159265358979323846;
+    const Vector2 direction(std::cos(angle), std::sin(angle));
+    const double velocity = unit(random) < 0.25 ? 0.0 : unit(random)*2500;
+    const double outerRadius = 2 + unit(random)*40;
+    const double borderRadius = unit(random)*outerRadius;
+    const double glow = unit(random) < 0.1 ? -unit(random)*3 : unit(random)*3;
+    const float r = static_cast<float>(unit(random)*255);
+    const float g = static_cast<float>(unit(random)*255);
+    const float b = static_cast<float>(unit(random)*255);
+    const float a = static_cast<float>(unit(random));
+
+    CircleRaster circle;
+    circle.Setup(width, height, centerOffset, direction, velocity, outerRadius, borderRadius, glow, r, g, b, a);
+    if (!CompareCircle(circle, width, height, i)) {
+      failures++;
+    }
+  }
+
+  std::cout << circles - failures << " of " << circles << " circles drawn exactly by every path (best "
+            << CircleRaster::PathName(CircleRaster::BestPath()) << ")" << std::endl;
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2010 - 2014 Leap Motion. All rights reserved. Proprietary and confidential.
+#include "common.h"
+#include "Overlay/CircleRaster.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static const char USAGE[] =
+  "Usage: CircleRasterPremultiplied [circles [seed]]\n"
+  "Draws seeded random circles with the fixed-point premultiplied CircleRaster path, and fails unless every\n"
+  "channel is within one of the single-precision reference, whose alpha channel must be exactly that of the\n"
+  "scalar straight path";
+
+static uint32_t Channel(uint32_t pixel, int c) {
+  return pixel >> (8*c) & 0xFF;
+}
+
+static void Report(int index, const char* what, long width, long i, uint32_t actual, uint32_t expected) {
+  std::cerr << "Circle " << index << ": " << what << " at (" << i % width << ", " << i / width << "), "
+            << std::hex << actual << " where the reference is " << expected << std::dec << std::endl;
+}
+
+// Compares the paths on one circle, reporting the first pixel which is out of tolerance
+static bool CompareCircle(const CircleRaster& circle, long width, long height, int index) {
+  std::vector<uint32_t> straight(width*height, 0xDEADBEEF);
+  std::vector<uint32_t> reference(width*height, 0xDEADBEEF);
+  std::vector<uint32_t> actual(width*height, 0xDEADBEEF);
+  circle.DrawScalar(&straight[0]);
+  circle.DrawPremultipliedScalar(&reference[0]);
+  circle.DrawPremultiplied(&actual[0]);
+
+  for (long i = 0; i < width*height; i++) {
+    // the golden image: the straight path's coverage and alpha, with every color scaled by that alpha
+    if (Channel(reference[i], 3) != Channel(straight[i], 3) || (straight[i] == 0xDEADBEEF) != (reference[i] == 0xDEADBEEF)) {
+      Report(index, "the reference's alpha differs from the straight path's", width, i, straight[i], reference[i]);
+      return false;
+    }
+    if ((actual[i] == 0xDEADBEEF) != (reference[i] == 0xDEADBEEF)) {
+      Report(index, "the fixed-point path's coverage differs", width, i, actual[i], reference[i]);
+      return false;
+    }
+    if (reference[i] == 0xDEADBEEF) {
+      continue; // outside of the bounds
+    }
+    for (int c = 0; c < 4; c++) {
+      const int difference = static_cast<int>(Channel(actual[i], c)) - static_cast<int>(Channel(reference[i], c));
+      if (difference < -1 || difference > 1 || (c < 3 && Channel(actual[i], c) > Channel(actual[i], 3))) {
+        Report(index, "the fixed-point path is out of tolerance", width, i, actual[i], reference[i]);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 3) {
+    std::cerr << USAGE << std::endl;
+    return 1;
+  }
+  const int circles = argc > 1 ? std::atoi(argv[1]) : 2000;
+  const unsigned long seed = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1;
+
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  int failures = 0;
+  for (int i = 0; i < circles; i++) {
+    // odd sizes and offsets, so that the vector path also draws partial groups at the ends of rows
+    const long width = 16 + static_cast<long>(unit(random)*240);
+    const long height = 16 + static_cast<long>(unit(random)*240);
+    const Vector2 centerOffset((unit(random) - 0.5)*width/2, (unit(random) - 0.5)*height/2);
+    const double angle = unit(random)*2*3.14159265358979323846;
+    const Vector2 direction(std::cos(angle), std::sin(angle));
+    const double velocity = unit(random) < 0.25 ? 0.0 : unit(random)*2500;
+    const double outerRadius = 2 + unit(random)*40;
+    const double borderRadius = unit(random)*outerRadius;
+    const double glow = unit(random) < 0.1 ? -unit(random)*3 : unit(random)*3;
+    const float r = static_cast<float>(unit(random)*255);
+    const float g = static_cast<float>(unit(random)*255);
+    const float b = static_cast<float>(unit(random)*255);
+    const float a = static_cast<float>(unit(random));
+
+    CircleRaster circle;
+    circle.Setup(width, height, centerOffset, direction, velocity, outerRadius, borderRadius, glow, r, g, b, a);
+    if (!CompareCircle(circle, width, height, i)) {
+      failures++;
+    }
+  }
+
+  std::cout << circles - failures << " of " << circles << " circles drawn within one of the premultiplied reference"
+            << std::endl;
+  return failures ? 1 : 0;
+}
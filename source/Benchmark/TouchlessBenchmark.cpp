@@ -0,0 +1,146 @@
+// Copyright (c) 2010 - 2014 Leap Motion. All rights reserved. Proprietary and confidential.
+#include "common.h"
+#include "Configuration/Config.h"
+#include "GestureInteraction/GestureInteractionManager.h"
+#include "GestureInteraction/SyntheticFrameSource.h"
+#include "GestureInteraction/TraceFrameSource.h"
+#include "OSInteraction/OSInteraction.h"
+#include "Overlay/Overlay.h"
+#include "Utility/FrameTrace.h"
+#include "Utility/LatencyMonitor.h"
+#include "Utility/LPVirtualScreen.h"
+#include "Utility/TransitionTrace.h"
+
+#include <boost/chrono.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+using namespace Touchless;
+
+static const char USAGE[] =
+  "Usage: TouchlessBenchmark [fps [seconds [mode]]]\n"
+  "       TouchlessBenchmark -replay <trace> [mode [transitions]]\n"
+  "       TouchlessBenchmark -record <trace> [fps [seconds]]";
+
+// Runs every frame produced by source through a fresh interaction manager, and reports the processing rate
+static void RunBenchmark(FrameSource& source, GestureInteractionMode mode, const std::string& label) {
+  LPVirtualScreen virtualScreen;
+  OSInteractionDriver* osInteractionDriver = OSInteractionDriver::New(&virtualScreen);
+  OverlayDriver* overlayDriver = OverlayDriver::New(&virtualScreen);
+  GestureInteractionManager* interactionManager = GestureInteractionManager::New(mode, *osInteractionDriver, *overlayDriver);
+  if (!interactionManager) {
+    std::cerr << "Unsupported interaction mode " << mode << std::endl;
+    delete overlayDriver;
+    delete osInteractionDriver;
+    return;
+  }
+
+  Frame frame;
+  Frame lastFrame;
+  int64_t frames = 0;
+  LatencyMonitor::Reset();
+  const boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  while (source.nextFrame(frame)) {
+    LatencyMonitor::BeginFrame(LatencyMonitor::Now());
+    interactionManager->processFrame(frame, lastFrame);
+    LatencyMonitor::EndFrame();
+    lastFrame = frame;
+    frames++;
+  }
+  const double elapsed = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+
+  std::cout << label << ": " << frames << " frames in " << elapsed << " s, "
+            << (elapsed > 0 ? frames/elapsed : 0) << " frames/s, "
+            << (frames > 0 ? 1e6*elapsed/frames : 0) << " us/frame" << std::endl;
+  LatencyMonitor::Dump(std::cout);
+
+  delete interactionManager;
+  delete overlayDriver;
+  delete osInteractionDriver;
+}
+
+static GestureInteractionMode ModeArgument(int argc, char** argv, int index) {
+  return argc > index ? static_cast<GestureInteractionMode>(std::atoi(argv[index])) : OUTPUT_MODE_BASIC;
+}
+
+// Replays a trace, and dumps the state machine transitions it caused if transitionsFileName is given, for
+// TouchlessTransitions to decode
+static int Replay(const char* fileName, GestureInteractionMode mode, const char* transitionsFileName) {
+  TraceFrameSource source;
+  if (!source.open(fileName)) {
+    std::cerr << "Unable to read trace " << fileName << std::endl;
+    return 1;
+  }
+  RunBenchmark(source, mode, fileName);
+  std::cout << source.poolSize() << " frame buffers allocated" << std::endl;
+  if (transitionsFileName && !TransitionTrace::Dump(transitionsFileName)) {
+    std::cerr << "Unable to write transitions " << transitionsFileName << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+// Writes the synthetic script out as a trace, which is handy for exercising replay without a device
+static int Record(const char* fileName, double fps, int64_t duration) {
+  FrameTrace::Writer writer;
+  if (!writer.Open(fileName)) {
+    std::cerr << "Unable to write trace " << fileName << std::endl;
+    return 1;
+  }
+  SyntheticFrameSource source(fps, duration);
+  source.addDefaultScript();
+  source.setJitter(0.5f);
+  Frame frame;
+  int64_t frames = 0;
+  while (source.nextFrame(frame)) {
+    writer.Write(*frame.data());
+    frames++;
+  }
+  std::cout << "Recorded " << frames << " frames to " << fileName << std::endl;
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  Config::InitializeDefaults();
+
+  if (argc > 1 && std::strcmp(argv[1], "-replay") == 0) {
+    if (argc < 3) {
+      std::cerr << USAGE << std::endl;
+      return 1;
+    }
+    return Replay(argv[2], ModeArgument(argc, argv, 3), argc > 4 ? argv[4] : nullptr);
+  }
+
+  const bool recording = argc > 1 && std::strcmp(argv[1], "-record") == 0;
+  if (recording && argc < 3) {
+    std::cerr << USAGE << std::endl;
+    return 1;
+  }
+  const int firstArgument = recording ? 3 : 1;
+  const double seconds = argc > firstArgument + 1 ? std::atof(argv[firstArgument + 1]) : 60.0;
+  const GestureInteractionMode mode = ModeArgument(argc, argv, firstArgument + 2);
+  const int64_t duration = static_cast<int64_t>(seconds*1000000.0);
+
+  // Without an explicit rate, the scripted session is run at 60, 120 and 300 fps in turn.
+  static const double DEFAULT_RATES[] = {60.0, 120.0, 300.0};
+  const int numRates = argc > firstArgument ? 1 : sizeof(DEFAULT_RATES)/sizeof(DEFAULT_RATES[0]);
+  for (int i = 0; i < numRates; i++) {
+    const double fps = argc > firstArgument ? std::atof(argv[firstArgument]) : DEFAULT_RATES[i];
+    if (fps <= 0 || duration <= 0) {
+      std::cerr << USAGE << std::endl;
+      return 1;
+    }
+    if (recording) {
+      return Record(argv[2], fps, duration);
+    }
+    SyntheticFrameSource source(fps, duration);
+    source.addDefaultScript();
+    source.setJitter(0.5f);
+    std::ostringstream label;
+    label << fps << " fps source";
+    RunBenchmark(source, mode, label.str());
+  }
+  return 0;
+}
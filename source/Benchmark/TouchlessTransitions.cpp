@@ -0,0 +1,21 @@
+// Copyright (c) 2010 - 2014 Leap Motion. All rights reserved. Proprietary and confidential.
+#include "common.h"
+#include "Utility/TransitionTrace.h"
+
+#include <iostream>
+
+static const char USAGE[] =
+  "Usage: TouchlessTransitions <dump>\n"
+  "Prints the state machine transitions in a dump written by TransitionTrace::Dump";
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << USAGE << std::endl;
+    return 1;
+  }
+  if (!TransitionTrace::Decode(argv[1], std::cout)) {
+    std::cerr << "Unable to decode transitions " << argv[1] << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,517 @@
+// Copyright (c) 2010 - 2014 Leap Motion. All rights reserved. Proprietary and confidential.
+#include "common.h"
+#include "Configuration/Config.h"
+#include "GestureInteraction/GestureInteractionManager.h"
+#include "GestureInteraction/InteractionTuning.h"
+#include "GestureInteraction/SyntheticFrameSource.h"
+#include "GestureInteraction/TraceFrameSource.h"
+#include "OSInteraction/OSInteraction.h"
+#include "Overlay/Overlay.h"
+#include "Utility/LPVirtualScreen.h"
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Touchless;
+
+// Replays one frame stream through a grid of InteractionTuning configurations, one configuration per worker at a
+// time, and ranks them.  Each run is scored on three things which need no labelled data:
+// - recognition latency: the time from a change in the raw pose (the number of hands and of pointables) which
+//   lasts at least the stable duration, to the next transition of the mode's state machine;
+// - false transitions: states which are left for the previous state again within the stable duration;
+// - cursor jitter: the mean magnitude of the second difference of consecutive absolute cursor positions, in device
+//   millimeters so that it doesn't depend on the screens.
+// The default tuning is always run as the baseline, and configurations which have more false transitions or more
+// jitter than the baseline are flagged as regressions.
+static const char USAGE[] =
+  "Usage: TouchlessTuner [options]\n"
+  "  -replay <trace>        tune over a recorded trace instead of the synthetic script\n"
+  "  -fps <fps>             synthetic frame rate (default 120)\n"
+  "  -seconds <seconds>     synthetic duration (default 60)\n"
+  "  -mode <mode>           interaction mode to tune (default 2, basic)\n"
+  "  -threads <count>       worker threads (default: one per core)\n"
+  "  -top <count>           configurations to report (default 20)\n"
+  "  -stable <ms>           duration a pose or state must last to count (default 150)\n"
+  "  -set <name>=<v>,<v>..  values to try for a parameter, replacing its default grid; a single value fixes it\n"
+  "Parameters:";
+
+static const int64_t MILLISECONDS = 1000;
+static const int64_t SECONDS = 1000000;
+
+// cost = latency in ms + LATENCY_MISS_COST per unrecognized pose change + FALSE_TRANSITION_COST per false transition
+// per minute + JITTER_COST per tenth of a millimeter of jitter
+static const double LATENCY_MISS_COST = 250.0;
+static const double FALSE_TRANSITION_COST = 20.0;
+static const double JITTER_COST = 100.0;
+// a transition later than this after a pose change is not taken as its recognition
+static const int64_t MAX_LATENCY = 1000*MILLISECONDS;
+
+struct TuningParameter {
+  const char*          name;
+  const char*          description;
+  std::vector<double>  values;
+  void               (*set)(InteractionTuning&, double);
+  double             (*get)(const InteractionTuning&);
+};
+
+static std::vector<TuningParameter> DefaultParameters(GestureInteractionMode mode) {
+  std::vector<TuningParameter> parameters;
+  TuningParameter p;
+
+  p.name = "count_threshold";
+  p.description = "probability at which the filtered pointable count is unambiguous";
+  p.values.clear(); p.values.push_back(0.7); p.values.push_back(0.8); p.values.push_back(0.9);
+  p.set = [] (InteractionTuning& t, double v) { t.pointableCountThreshold = v; };
+  p.get = [] (const InteractionTuning& t) { return t.pointableCountThreshold; };
+  parameters.push_back(p);
+
+  p.name = "rts_threshold";
+  p.description = "probability at which rotating, translating or scaling is unambiguous";
+  p.values.clear(); p.values.push_back(0.8); p.values.push_back(0.9);
+  p.set = [] (InteractionTuning& t, double v) { t.rtsThreshold = v; };
+  p.get = [] (const InteractionTuning& t) { return t.rtsThreshold; };
+  parameters.push_back(p);
+
+  p.name = "count_window_divisor";
+  p.description = "the pointable count is averaged over fps/divisor frames";
+  p.values.clear(); p.values.push_back(10); p.values.push_back(15); p.values.push_back(20); p.values.push_back(30);
+  p.set = [] (InteractionTuning& t, double v) { t.pointableCountWindowDivisor = v; };
+  p.get = [] (const InteractionTuning& t) { return t.pointableCountWindowDivisor; };
+  parameters.push_back(p);
+
+  p.name = "rts_window_divisor";
+  p.description = "rotating, translating or scaling is averaged over fps/divisor frames";
+  p.values.clear(); p.values.push_back(10); p.values.push_back(20); p.values.push_back(30);
+  p.set = [] (InteractionTuning& t, double v) { t.rtsWindowDivisor = v; };
+  p.get = [] (const InteractionTuning& t) { return t.rtsWindowDivisor; };
+  parameters.push_back(p);
+
+  // only the modes which read a parameter get a grid for it by default
+  p.name = "bucket_threshold";
+  p.description = "gesture-only mode: fraction of recent frames to recognize a pointable count";
+  p.values.clear(); p.values.push_back(InteractionTuning().bucketThreshold);
+  if (mode == OUTPUT_MODE_INTRO) {
+    p.values.clear(); p.values.push_back(0.6); p.values.push_back(0.75); p.values.push_back(0.9);
+  }
+  p.set = [] (InteractionTuning& t, double v) { t.bucketThreshold = static_cast<float>(v); };
+  p.get = [] (const InteractionTuning& t) { return static_cast<double>(t.bucketThreshold); };
+  parameters.push_back(p);
+
+  p.name = "bucket_threshold_low";
+  p.description = "gesture-only mode: fraction below which every pointable count is released";
+  p.values.clear(); p.values.push_back(InteractionTuning().bucketThresholdLow);
+  p.set = [] (InteractionTuning& t, double v) { t.bucketThresholdLow = static_cast<float>(v); };
+  p.get = [] (const InteractionTuning& t) { return static_cast<double>(t.bucketThresholdLow); };
+  parameters.push_back(p);
+
+  p.name = "hover_drag_ms";
+  p.description = "finger mouse: milliseconds a click is held before it becomes a drag";
+  p.values.clear(); p.values.push_back(static_cast<double>(InteractionTuning().hoverDurationToActivateDrag/MILLISECONDS));
+  if (mode == OUTPUT_MODE_ADVANCED) {
+    p.values.clear(); p.values.push_back(350); p.values.push_back(500); p.values.push_back(650);
+  }
+  p.set = [] (InteractionTuning& t, double v) { t.hoverDurationToActivateDrag = static_cast<int64_t>(v*MILLISECONDS); };
+  p.get = [] (const InteractionTuning& t) { return static_cast<double>(t.hoverDurationToActivateDrag)/MILLISECONDS; };
+  parameters.push_back(p);
+
+  // the zoom gain changes none of the scores, so it is only varied on request
+  p.name = "zoom_scale";
+  p.description = "gain applied to the hand's scale factor when zooming";
+  p.values.clear(); p.values.push_back(InteractionTuning().zoomScaleFactor);
+  p.set = [] (InteractionTuning& t, double v) { t.zoomScaleFactor = static_cast<float>(v); };
+  p.get = [] (const InteractionTuning& t) { return static_cast<double>(t.zoomScaleFactor); };
+  parameters.push_back(p);
+
+  return parameters;
+}
+
+// Drops everything the interaction manager emits, so that tuning never drives the real cursor or keyboard
+class NullOSInteractionDriver : public OSInteractionDriver {
+public:
+  NullOSInteractionDriver(LPVirtualScreen* virtualScreen) : OSInteractionDriver(virtualScreen) { }
+
+  virtual bool initializeTouch() { return true; }
+  virtual void clickDown(int button, int number = 1) { OSInteractionDriver::clickDown(button, number); }
+  virtual void clickUp(int button, int number = 1) { OSInteractionDriver::clickUp(button, number); }
+  virtual bool cursorPosition(float*, float*) const { return false; }
+  virtual void setCursorPosition(float, float, bool = true) { }
+  virtual void cancelGestureEvents() { }
+  virtual void applyCharms(const Leap::Vector&, int, int& charmsMode) { charmsMode = -1; }
+  virtual bool useCharmHelper() const { return false; }
+  virtual bool checkTouching(const Vector&, float) const { return false; }
+  virtual void emitTouchEvent(const TouchEvent&) { }
+  virtual bool touchAvailable() const { return false; }
+  virtual int touchVersion() const { return 0; }
+  virtual int numTouchScreens() const { return 0; }
+  virtual void emitKeyboardEvent(int, bool) { }
+  virtual void emitKeyboardEvents(int*, int, bool) { }
+  virtual void syncPosition() { }
+};
+
+struct TuningScore {
+  TuningScore() : frames(0), poseChanges(0), recognized(0), latency(0), transitions(0), falseTransitions(0), jitter(0), minutes(0), cost(0) { }
+
+  int64_t frames;
+  int     poseChanges;       // raw pose changes which lasted the stable duration
+  int     recognized;        // of those, the ones followed by a state transition before the next
+  double  latency;           // mean milliseconds from a recognized pose change to its transition
+  int     transitions;
+  int     falseTransitions;
+  double  jitter;            // mean millimeters
+  double  minutes;
+  double  cost;
+
+  double falseTransitionsPerMinute() const { return minutes > 0 ? falseTransitions/minutes : 0; }
+};
+
+struct TuningRun {
+  InteractionTuning tuning;
+  bool              baseline;
+  bool              failed;
+  TuningScore       score;
+};
+
+struct TuningSource {
+  std::string traceFile;
+  double      fps;
+  int64_t     duration;
+
+  FrameSource* New() const {
+    if (!traceFile.empty()) {
+      std::unique_ptr<TraceFrameSource> source(new TraceFrameSource());
+      return source->open(traceFile) ? source.release() : nullptr;
+    }
+    SyntheticFrameSource* source = new SyntheticFrameSource(fps, duration);
+    source->addDefaultScript();
+    source->setJitter(0.5f);
+    return source;
+  }
+};
+
+// The interaction modes set some shared configuration as they are created, so creation is serialized
+static boost::mutex s_creationMutex;
+
+static bool RunConfiguration(const TuningSource& sourceSpec, GestureInteractionMode mode, int64_t stableDuration, TuningRun& run) {
+  std::unique_ptr<FrameSource> source(sourceSpec.New());
+  if (!source) {
+    return false;
+  }
+  LPVirtualScreen virtualScreen;
+  NullOSInteractionDriver osInteractionDriver(&virtualScreen);
+  std::unique_ptr<OverlayDriver> overlayDriver;
+  std::unique_ptr<GestureInteractionManager> interactionManager;
+  {
+    boost::mutex::scoped_lock lock(s_creationMutex);
+    overlayDriver.reset(OverlayDriver::New(&virtualScreen));
+    interactionManager.reset(GestureInteractionManager::New(mode, osInteractionDriver, *overlayDriver, run.tuning));
+  }
+  if (!interactionManager) {
+    return false;
+  }
+
+  TuningScore& score = run.score;
+  double totalLatency = 0;
+
+  // the latest raw pose, and the latency of the first transition after it changed, if there has been one
+  int pose = -1;
+  int64_t poseTime = 0;
+  int64_t poseLatency = -1;
+  bool poseChanged = false; // the pose the session starts in is not a change
+  // a pose counts once it has lasted the stable duration; transitions during shorter blips are discarded
+  auto finishPose = [&] (int64_t until) {
+    if (poseChanged && until - poseTime >= stableDuration) {
+      score.poseChanges++;
+      if (poseLatency >= 0) {
+        score.recognized++;
+        totalLatency += static_cast<double>(poseLatency)/MILLISECONDS;
+      }
+    }
+  };
+
+  // the current and previous states, to detect states which are left again for the previous one; the names come
+  // from the mode's state table, so the same state always has the same name pointer
+  const char* state = interactionManager->stateName();
+  const char* previousState = nullptr;
+  int64_t stateTime = 0;
+
+  typedef std::pair<int64_t,Vector> CursorSample;
+  std::vector<CursorSample> cursorSamples;
+
+  Frame frame;
+  Frame lastFrame;
+  int64_t firstTime = -1;
+  int64_t time = 0;
+  while (source->nextFrame(frame)) {
+    time = frame.timestamp();
+    if (firstTime < 0) {
+      firstTime = time;
+    }
+    interactionManager->processFrame(frame, lastFrame);
+    lastFrame = frame;
+    score.frames++;
+
+    if (interactionManager->cursorDeviceTimestamp() == time) {
+      cursorSamples.push_back(CursorSample(time, interactionManager->cursorDevicePosition()));
+    }
+
+    const int framePose = 16*frame.hands().count() + std::min(frame.pointables().count(), 15);
+    if (framePose != pose) {
+      finishPose(time);
+      poseChanged = pose >= 0;
+      poseLatency = -1;
+      pose = framePose;
+      poseTime = time;
+    }
+
+    const char* currentState = interactionManager->stateName();
+    if (currentState != state) {
+      score.transitions++;
+      if (currentState == previousState && time - stateTime < stableDuration) {
+        score.falseTransitions++;
+      }
+      if (poseLatency < 0 && time - poseTime <= MAX_LATENCY) {
+        poseLatency = time - poseTime;
+      }
+      previousState = state;
+      state = currentState;
+      stateTime = time;
+    }
+  }
+  finishPose(time);
+  score.latency = score.recognized > 0 ? totalLatency/score.recognized : 0;
+  score.minutes = static_cast<double>(time - firstTime)/(60*SECONDS);
+
+  double jitter = 0;
+  int jitterSamples = 0;
+  for (size_t i = 2; i < cursorSamples.size(); i++) {
+    // only consecutive samples of continuous pointing
+    if (cursorSamples[i].first - cursorSamples[i - 2].first > 50*MILLISECONDS) {
+      continue;
+    }
+    jitter += (cursorSamples[i].second - 2*cursorSamples[i - 1].second + cursorSamples[i - 2].second).magnitude();
+    jitterSamples++;
+  }
+  score.jitter = jitterSamples > 0 ? jitter/jitterSamples : 0;
+
+  const int missed = score.poseChanges - score.recognized;
+  score.cost = score.latency
+             + (score.poseChanges > 0 ? LATENCY_MISS_COST*missed/score.poseChanges : 0)
+             + FALSE_TRANSITION_COST*score.falseTransitionsPerMinute()
+             + JITTER_COST*score.jitter;
+  return true;
+}
+
+// Every combination of the parameter values, with the baseline first
+static std::vector<TuningRun> GridRuns(const std::vector<TuningParameter>& parameters) {
+  std::vector<TuningRun> runs;
+  TuningRun baseline;
+  baseline.baseline = true;
+  baseline.failed = false;
+  runs.push_back(baseline);
+
+  std::vector<size_t> index(parameters.size(), 0);
+  while (true) {
+    TuningRun run;
+    run.baseline = false;
+    run.failed = false;
+    bool isBaseline = true;
+    for (size_t p = 0; p < parameters.size(); p++) {
+      parameters[p].set(run.tuning, parameters[p].values[index[p]]);
+      isBaseline = isBaseline && parameters[p].get(run.tuning) == parameters[p].get(baseline.tuning);
+    }
+    if (!isBaseline) {
+      runs.push_back(run);
+    }
+    size_t p = 0;
+    for (; p < parameters.size(); p++) {
+      if (++index[p] < parameters[p].values.size()) {
+        break;
+      }
+      index[p] = 0;
+    }
+    if (p == parameters.size()) {
+      break;
+    }
+  }
+  return runs;
+}
+
+static void Report(const std::vector<TuningRun>& runs, const std::vector<TuningParameter>& parameters, size_t top) {
+  std::vector<const TuningRun*> ranked;
+  const TuningRun* baseline = nullptr;
+  for (size_t i = 0; i < runs.size(); i++) {
+    if (!runs[i].failed) {
+      ranked.push_back(&runs[i]);
+    }
+    if (runs[i].baseline) {
+      baseline = &runs[i];
+    }
+  }
+  std::stable_sort(ranked.begin(), ranked.end(), [] (const TuningRun* a, const TuningRun* b) { return a->score.cost < b->score.cost; });
+
+  std::cout << std::setw(5) << "rank" << std::setw(9) << "cost" << std::setw(9) << "latency" << std::setw(11) << "recognized"
+            << std::setw(9) << "false/m" << std::setw(8) << "jitter" << std::setw(5) << " ";
+  for (size_t p = 0; p < parameters.size(); p++) {
+    std::cout << " " << parameters[p].name;
+  }
+  std::cout << std::endl;
+
+  for (size_t i = 0; i < ranked.size(); i++) {
+    const TuningRun& run = *ranked[i];
+    if (i >= top && !run.baseline) {
+      continue;
+    }
+    const TuningScore& s = run.score;
+    // regressions on the scores which the latency must not be bought with
+    const bool regresses = baseline && !baseline->failed &&
+      (s.falseTransitions > baseline->score.falseTransitions || s.jitter > baseline->score.jitter*1.01);
+    std::ostringstream recognized;
+    recognized << s.recognized << "/" << s.poseChanges;
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(5) << i + 1 << std::setw(9) << s.cost << std::setw(9) << s.latency
+              << std::setw(11) << recognized.str() << std::setw(9) << s.falseTransitionsPerMinute()
+              << std::setprecision(4) << std::setw(8) << s.jitter
+              << std::setw(5) << (run.baseline ? " base" : regresses ? "    !" : "");
+    for (size_t p = 0; p < parameters.size(); p++) {
+      std::ostringstream value;
+      value << parameters[p].get(run.tuning);
+      std::cout << " " << std::setw(std::strlen(parameters[p].name)) << value.str();
+    }
+    std::cout << std::endl;
+  }
+  std::cout << "latency in ms; false transitions per minute; jitter in mm; ! regresses false transitions or jitter" << std::endl;
+}
+
+static bool ParseSet(const char* argument, std::vector<TuningParameter>& parameters) {
+  const char* equals = std::strchr(argument, '=');
+  if (!equals) {
+    return false;
+  }
+  const std::string name(argument, equals);
+  for (size_t p = 0; p < parameters.size(); p++) {
+    if (name == parameters[p].name) {
+      std::vector<double> values;
+      std::istringstream list(equals + 1);
+      std::string value;
+      while (std::getline(list, value, ',')) {
+        values.push_back(std::atof(value.c_str()));
+      }
+      if (values.empty()) {
+        return false;
+      }
+      parameters[p].values = values;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void PrintUsage(const std::vector<TuningParameter>& parameters) {
+  std::cerr << USAGE << std::endl;
+  for (size_t p = 0; p < parameters.size(); p++) {
+    std::cerr << "  " << std::setw(22) << std::left << parameters[p].name << " " << parameters[p].description << std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  Config::InitializeDefaults();
+
+  TuningSource source;
+  source.fps = 120.0;
+  double seconds = 60.0;
+  GestureInteractionMode mode = OUTPUT_MODE_BASIC;
+  unsigned int threads = boost::thread::hardware_concurrency();
+  size_t top = 20;
+  int64_t stableDuration = 150*MILLISECONDS;
+  std::vector<const char*> sets;
+
+  for (int i = 1; i < argc; i++) {
+    const bool hasValue = i + 1 < argc;
+    if (hasValue && std::strcmp(argv[i], "-replay") == 0) {
+      source.traceFile = argv[++i];
+    } else if (hasValue && std::strcmp(argv[i], "-fps") == 0) {
+      source.fps = std::atof(argv[++i]);
+    } else if (hasValue && std::strcmp(argv[i], "-seconds") == 0) {
+      seconds = std::atof(argv[++i]);
+    } else if (hasValue && std::strcmp(argv[i], "-mode") == 0) {
+      mode = static_cast<GestureInteractionMode>(std::atoi(argv[++i]));
+    } else if (hasValue && std::strcmp(argv[i], "-threads") == 0) {
+      threads = static_cast<unsigned int>(std::atoi(argv[++i]));
+    } else if (hasValue && std::strcmp(argv[i], "-top") == 0) {
+      top = static_cast<size_t>(std::atoi(argv[++i]));
+    } else if (hasValue && std::strcmp(argv[i], "-stable") == 0) {
+      stableDuration = static_cast<int64_t>(std::atof(argv[++i])*MILLISECONDS);
+    } else if (hasValue && std::strcmp(argv[i], "-set") == 0) {
+      sets.push_back(argv[++i]);
+    } else {
+      PrintUsage(DefaultParameters(mode));
+      return 1;
+    }
+  }
+  source.duration = static_cast<int64_t>(seconds*SECONDS);
+
+  // the default grid depends on the mode, so the overrides are applied once all options are known
+  std::vector<TuningParameter> parameters = DefaultParameters(mode);
+  for (size_t i = 0; i < sets.size(); i++) {
+    if (!ParseSet(sets[i], parameters)) {
+      std::cerr << "Invalid parameter values " << sets[i] << std::endl;
+      PrintUsage(parameters);
+      return 1;
+    }
+  }
+  if (source.fps <= 0 || source.duration <= 0) {
+    PrintUsage(parameters);
+    return 1;
+  }
+  {
+    std::unique_ptr<FrameSource> check(source.New());
+    if (!check) {
+      std::cerr << "Unable to read trace " << source.traceFile << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<TuningRun> runs = GridRuns(parameters);
+  threads = std::max(1u, std::min(threads, static_cast<unsigned int>(runs.size())));
+  std::cout << "Tuning mode " << mode << " over " << (source.traceFile.empty() ? "the synthetic script" : source.traceFile)
+            << ": " << runs.size() << " configurations on " << threads << " threads" << std::endl;
+
+  // the workers take the next configuration until none are left
+  boost::mutex nextMutex;
+  size_t next = 0;
+  boost::thread_group workers;
+  for (unsigned int t = 0; t < threads; t++) {
+    workers.create_thread([&] () {
+      while (true) {
+        size_t index;
+        {
+          boost::mutex::scoped_lock lock(nextMutex);
+          if (next == runs.size()) {
+            return;
+          }
+          index = next++;
+        }
+        runs[index].failed = !RunConfiguration(source, mode, stableDuration, runs[index]);
+      }
+    });
+  }
+  workers.join_all();
+
+  if (runs[0].failed) {
+    std::cerr << "Unsupported interaction mode " << mode << std::endl;
+    return 1;
+  }
+  Report(runs, parameters, top);
+  return 0;
+}
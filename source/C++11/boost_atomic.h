@@ -0,0 +1,11 @@
+// Copyright (c) 2010 - 2013 Leap Motion. All rights reserved. Proprietary and confidential.
+#include <boost/atomic.hpp>
+namespace std {
+  using boost::atomic;
+  using boost::memory_order;
+  using boost::memory_order_relaxed;
+  using boost::memory_order_acquire;
+  using boost::memory_order_release;
+  using boost::memory_order_acq_rel;
+  using boost::memory_order_seq_cst;
+}
@@ -150,6 +150,15 @@
   #define SHARED_PTR_HEADER "C++11/boost_shared_ptr.h"
 #endif
 
+/*********************
+ * atomic availability
+ *********************/
+#if STL11_ALLOWED
+  #define ATOMIC_HEADER <atomic>
+#else
+  #define ATOMIC_HEADER "C++11/boost_atomic.h"
+#endif
+
 /*********************
  * noexcept support
  *********************/
@@ -159,6 +168,15 @@
   #define NOEXCEPT(x) x noexcept
 #endif
 
+/*********************
+ * Thread-local storage, for plain data only
+ *********************/
+#ifdef _MSC_VER
+  #define THREAD_LOCAL __declspec(thread)
+#else
+  #define THREAD_LOCAL __thread
+#endif
+
 /*********************
  * Lambdas?
  *********************/
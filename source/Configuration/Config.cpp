@@ -133,6 +133,21 @@ void Config::InitializeDefaults()
 
   CreateAttribute("os_interaction_mode", Touchless::GestureInteractionMode::OUTPUT_MODE_DISABLED, WRITE_ALWAYS);
   CreateAttribute("os_interaction_multi_monitor",  false, WRITE_ALWAYS);
+  CreateAttribute("config_save_debounce_ms",         500, WRITE_NOPUBLIC);
+  CreateAttribute("frame_trace_file",                 "", WRITE_NOPUBLIC);
+  CreateAttribute("frame_coalescing",               true, WRITE_NOPUBLIC);
+  CreateAttribute("cursor_prediction",             false, WRITE_NOPUBLIC);
+  CreateAttribute("cursor_prediction_horizon_ms",     16, WRITE_NOPUBLIC);
+  CreateAttribute("cursor_prediction_max_mm",       20.0, WRITE_NOPUBLIC);
+  CreateAttribute("pointable_smoothing_ms",            0, WRITE_NOPUBLIC);
+  CreateAttribute("cursor_filter",                    "", WRITE_NOPUBLIC);
+  CreateAttribute("cursor_filter_min_cutoff_hz",     1.0, WRITE_NOPUBLIC);
+  CreateAttribute("cursor_filter_beta",             0.05, WRITE_NOPUBLIC);
+  CreateAttribute("scroll_filter",                    "", WRITE_NOPUBLIC);
+  CreateAttribute("scroll_filter_min_cutoff_hz",     2.0, WRITE_NOPUBLIC);
+  CreateAttribute("scroll_filter_beta",            0.002, WRITE_NOPUBLIC);
+  CreateAttribute("latency_dump_interval_ms",           0, WRITE_NOPUBLIC);
+  CreateAttribute("transition_dump_file",              "", WRITE_NOPUBLIC);
 
   CreateAttribute("interaction_box_auto",          false, WRITE_ALWAYS);
   CreateAttribute("interaction_box_height",          200, WRITE_ALWAYS);
@@ -344,49 +359,62 @@ bool Config::Save(const std::string& section, bool toDefault)
   static ConfigState& s = state();
   bool status = false;
 
-  boost::unique_lock<boost::recursive_mutex> lock(s.MapMutex);
+  // Writers of the same file (and its .tmp) must not interleave.  The snapshot below is taken under this lock
+  // too, so that concurrent saves write in the order they snapshot, and an older snapshot can't be written last.
+  boost::unique_lock<boost::mutex> saveLock(s.SaveMutex);
+
+  // Snapshot what needs writing under the map lock, then release it for the file I/O so that
+  // SetAttribute/GetAttribute callers are never stuck behind a slow disk.
+  std::string fileName;
+  Value::Hash modified;
+  {
+    boost::unique_lock<boost::recursive_mutex> lock(s.MapMutex);
 
-  if (!s.ModifiedMap.empty() || toDefault) {
+    if (s.ModifiedMap.empty() && !toDefault) {
+      return false;
+    }
     std::map<std::string, std::string>::const_iterator found = s.SectionToFileMap.find(section);
     if (found == s.SectionToFileMap.end()) {
       found = s.SectionToFileMap.find(""); // Use default file name
     }
-    if (found != s.SectionToFileMap.end()) {
-      const std::string fileName = found->second;
-
-      try {
-        Value object;
-
-        std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
-
-        if (in.is_open()) {
-          in >> object;
-          in.close();
-        }
-
-        if (!object.IsHash()) {
-          object = Value::Hash();
-        }
-        std::string tmpFileName = fileName + ".tmp";
-        std::ofstream out(tmpFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
-
-        if (out.is_open()) {
-          if (toDefault) {
-            std::map<std::string, Attribute> emptyMap;
-            object.HashSet(section, emptyMap);
-          } else {
-            object.HashSet(section, s.ModifiedMap);
-          }
-          out << object.ToJSON(false, true);
-          out.close();
-          status = true;
-          boost::filesystem::rename(tmpFileName, fileName);
-        }
-        boost::filesystem::remove(tmpFileName);
-      } catch (...) {
-        status = false;
+    if (found == s.SectionToFileMap.end()) {
+      return false;
+    }
+    fileName = found->second;
+    modified = s.ModifiedMap;
+  }
+
+  try {
+    Value object;
+
+    std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+
+    if (in.is_open()) {
+      in >> object;
+      in.close();
+    }
+
+    if (!object.IsHash()) {
+      object = Value::Hash();
+    }
+    std::string tmpFileName = fileName + ".tmp";
+    std::ofstream out(tmpFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (out.is_open()) {
+      if (toDefault) {
+        std::map<std::string, Attribute> emptyMap;
+        object.HashSet(section, emptyMap);
+      } else {
+        object.HashSet(section, modified);
       }
+      out << object.ToJSON(false, true);
+      out.close();
+      status = true;
+      boost::filesystem::rename(tmpFileName, fileName);
     }
+    boost::filesystem::remove(tmpFileName);
+  } catch (...) {
+    status = false;
   }
   return status;
 }
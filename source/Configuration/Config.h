@@ -163,6 +163,7 @@ private:
     std::map<std::string, std::string> SectionToFileMap;
     t_mpChangeFunc OnChangeFunctions;
     boost::recursive_mutex MapMutex;
+    boost::mutex SaveMutex;
     int Width;
     int Height;
     int SourceWidth;
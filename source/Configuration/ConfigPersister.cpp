@@ -0,0 +1,87 @@
+// Copyright (c) 2010 - 2014 Leap Motion. All rights reserved. Proprietary and confidential.
+#include "stdafx.h"
+#include "ConfigPersister.h"
+#include "Config.h"
+
+ConfigPersister::ConfigPersister(uint32_t debounceMilliseconds, const std::string& section) :
+  m_section(section),
+  m_debounceMilliseconds(debounceMilliseconds),
+  m_saveCount(0),
+  m_pending(false),
+  m_terminated(false)
+{
+  m_Thread = boost::thread([this] () {this->loop();});
+}
+
+ConfigPersister::~ConfigPersister() {
+  // Signal that the thread should terminate:
+  boost::unique_lock<boost::mutex> lock(m_Mutex);
+
+  m_terminated = true;
+  m_Condition.notify_all();
+
+  lock.unlock();
+
+  m_Thread.join();
+
+  // Anything still pending is written out before we go away:
+  Flush();
+}
+
+bool ConfigPersister::SetAttribute(const std::string& attributeName, const Value& value) {
+  if (!Config::SetAttribute(attributeName, value, true)) {
+    return false;
+  }
+  boost::unique_lock<boost::mutex> lock(m_Mutex);
+
+  // every change pushes the deadline back, so a burst of changes results in one write
+  m_pending = true;
+  m_deadline = Clock::now() + boost::chrono::milliseconds(m_debounceMilliseconds);
+  m_Condition.notify_all();
+  return true;
+}
+
+bool ConfigPersister::Flush() {
+  boost::unique_lock<boost::mutex> lock(m_Mutex);
+  if (!m_pending) {
+    return true;
+  }
+  m_pending = false;
+  lock.unlock();
+
+  return save();
+}
+
+void ConfigPersister::SetDebounceWindow(uint32_t debounceMilliseconds) {
+  boost::unique_lock<boost::mutex> lock(m_Mutex);
+  m_debounceMilliseconds = debounceMilliseconds;
+  m_Condition.notify_all();
+}
+
+bool ConfigPersister::save() {
+  boost::unique_lock<boost::mutex> lock(m_SaveMutex);
+  const bool status = Config::Save(m_section);
+  ++m_saveCount;
+  return status;
+}
+
+void ConfigPersister::loop() {
+  boost::unique_lock<boost::mutex> lock(m_Mutex);
+
+  while (!m_terminated) {
+    if (!m_pending) {
+      m_Condition.wait(lock);
+      continue;
+    }
+    // Wait out the debounce window; new changes move the deadline, so re-check it on every wakeup:
+    if (Clock::now() < m_deadline) {
+      m_Condition.wait_until(lock, m_deadline);
+      continue;
+    }
+    m_pending = false;
+
+    lock.unlock();
+    save(); // The actual file I/O happens without holding the lock
+    lock.lock();
+  }
+}
@@ -0,0 +1,83 @@
+/*==================================================================================================================
+
+    Copyright (c) 2010 - 2014 Leap Motion. All rights reserved.
+
+  The intellectual and technical concepts contained herein are proprietary and confidential to Leap Motion, and are
+  protected by trade secret or copyright law. Dissemination of this information or reproduction of this material is
+  strictly forbidden unless prior written permission is obtained from Leap Motion.
+
+===================================================================================================================*/
+
+/// <summary>
+/// Debounced write-behind persistence of user-specified configuration attributes
+/// </summary>
+/// <remarks>
+/// SetAttribute updates the in-memory configuration immediately, so Config::GetAttribute sees the new value right
+/// away, but the write to disk is deferred to a background thread.  Changes arriving within the debounce window of
+/// each other are merged into a single Config::Save (which does the tmp-and-rename write), so toggling settings
+/// never performs file I/O on the calling thread.  Flush forces any pending write to complete, and is called on
+/// destruction so that nothing is lost on exit.
+///
+/// Maintainers: Raffi, Hua, Jonathan
+/// </remarks>
+
+#ifndef __ConfigPersister_h__
+#define __ConfigPersister_h__
+
+#include "common.h"
+#include "Utility/Value.h"
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/chrono.hpp>
+#include <string>
+#include ATOMIC_HEADER
+
+#if defined(_MSC_VER) && (_MSC_VER < 1600)
+// Visual Studio 2008
+typedef unsigned __int32 uint32_t;
+#endif
+
+class ConfigPersister {
+public:
+  static const uint32_t DEFAULT_DEBOUNCE_MILLISECONDS = 500;
+
+  ConfigPersister(uint32_t debounceMilliseconds = DEFAULT_DEBOUNCE_MILLISECONDS, const std::string& section = "configuration");
+  ~ConfigPersister();
+
+  /// <summary>
+  /// Sets a user-specified attribute and schedules it to be saved once the debounce window has elapsed quietly
+  /// </summary>
+  bool SetAttribute(const std::string& attributeName, const Value& value);
+
+  /// <summary>
+  /// Synchronously writes any pending changes
+  /// </summary>
+  /// <returns>false if there was something to write and the write failed</returns>
+  bool Flush();
+
+  void SetDebounceWindow(uint32_t debounceMilliseconds);
+  uint32_t DebounceWindow() const { return m_debounceMilliseconds; }
+
+  // Number of times the configuration file has actually been written, for diagnostics
+  uint32_t SaveCount() const { return m_saveCount; }
+
+private:
+  typedef boost::chrono::steady_clock Clock;
+
+  void loop();
+  bool save();
+
+  std::string m_section;
+  boost::thread m_Thread;
+  boost::mutex m_Mutex;
+  boost::mutex m_SaveMutex;
+  boost::condition_variable m_Condition;
+  std::atomic<uint32_t> m_debounceMilliseconds;
+  std::atomic<uint32_t> m_saveCount;
+  bool m_pending;
+  bool m_terminated;
+  Clock::time_point m_deadline;
+};
+
+#endif // __ConfigPersister_h__
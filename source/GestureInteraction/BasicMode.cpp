@@ -27,7 +27,10 @@ bool BasicMode::DisablePalmSwipe = true;
 bool BasicMode::DisableAllOverlays = false;
 bool BasicMode::DisableHorizontalScrolling = true;
 float BasicMode::TranslationScaleFactor = 1.5;
-float BasicMode::ZoomScaleFactor = 1.5;
+
+#define BASICMODE_STATE_ENTRY(x) STATE_TABLE_ENTRY(BasicMode, x)
+const TableStateMachine<BasicMode>::StateEntry BasicMode::s_states[] = { BASICMODE_STATES(BASICMODE_STATE_ENTRY) };
+#undef BASICMODE_STATE_ENTRY
 
 // GENERAL OVERVIEW OF BASIC MODE STATE MACHINE
 //
@@ -43,9 +46,9 @@ float BasicMode::ZoomScaleFactor = 1.5;
 //
 // The states correspond roughly exactly with the state of interaction.
 
-BasicMode::BasicMode(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver)
+BasicMode::BasicMode(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver, const InteractionTuning& tuning)
   :
-  GestureInteractionManager(osInteractionDriver, overlayDriver),
+  GestureInteractionManager(osInteractionDriver, overlayDriver, tuning),
   m_drawOverlays(true),
   m_noTouching(true),
   m_clickDuration(0),
@@ -56,10 +59,12 @@ BasicMode::BasicMode(OSInteractionDriver& osInteractionDriver, OverlayDriver& ov
   m_charmsMode(-1),
   m_updateCursor(true)
 {
-  m_basicModeStateMachine.SetOwnerClass(this, "BasicMode");
+  m_basicModeStateMachine.SetOwnerClass(this, "BasicMode", s_states, BASICMODE__STATE_COUNT);
+  m_basicModeStateMachine.SetTraceFrameId(&m_frameFeatures.frameId);
 
-  // This tells the state machine to log transitions to cerr.  An optional second can be used to specify
-  // an event ID to ignore (such as something that happens every single frame) to avoid spamming the console.
+  // Transitions are always recorded in the TransitionTrace.  This also tells the state machine to log them to
+  // cerr, as text, for debugging.  An optional second can be used to specify an event ID to ignore (such as
+  // something that happens every single frame) to avoid spamming the console.
   // Specify that OMFM__PROCESS_FRAME should be ignored.
   //m_basicModeStateMachine.SetTransitionLogger(&std::cerr, OMB__PROCESS_FRAME);
 }
@@ -82,12 +87,11 @@ void BasicMode::SetBasicMode(){
 }
 
 void BasicMode::processFrameInternal() {
-  m_noTouching = std::count_if(m_relevantPointables.begin(), m_relevantPointables.end(),
-                          [this] (const Pointable& pointable) {return pointable.touchZone() == Pointable::ZONE_TOUCHING;}) == 0;
+  updateHandTracker();
+  m_noTouching = m_frameFeatures.relevantInZone(Pointable::ZONE_TOUCHING) == 0;
   // initialize basic mode state machine if necessary
   if (!m_basicModeStateMachine.IsInitialized()) {
-    m_basicModeStateMachine.Initialize(&BasicMode::State_BasicMode_0Pointables_NoInteraction,
-                                       "State_BasicMode_0Pointables_NoInteraction");
+    m_basicModeStateMachine.Initialize(State_BasicMode_0Pointables_NoInteraction_Id);
   }
 
 #if __APPLE__
@@ -173,27 +177,37 @@ void BasicMode::generateDesktopSwipeBetweenFrames (const Frame &currentFrame, co
   applyDesktopSwipe(scroll_dx, scroll_dy);
 }
 
-bool BasicMode::shouldBeInMultiHandMode(int32_t *pointableId1, int32_t *pointableId2) {
-  std::list<Hand> handList;
-  if (m_currentFrame.hands().count() > 1) {
-    for (int i = 0; i < m_currentFrame.hands().count(); ++i) {
-      if (m_currentFrame.hands()[i].pointables().count() != 0 && m_currentFrame.hands()[i].direction().z < 0) {
-        handList.push_back(m_currentFrame.hands()[i]);
-      }
-    }
-    if (handList.size() > 1)
-    {
-      auto it = handList.begin();
-      if (pointableId1 != nullptr) {
-        *pointableId1 = foremostPointableIdOfHand(*it);
-      }
-      if (pointableId2 != nullptr) {
-        *pointableId2 = foremostPointableIdOfHand(*(++it));
-      }
-      return true;
+void BasicMode::updateHandTracker() {
+  // each hand with pointables which point towards the screen is measured by its foremost pointable
+  TargetTracker::Measurement measurements[TargetTracker::MAX_TARGETS];
+  int count = 0;
+  for (int h = 0; h < m_frameFeatures.handCount && count < TargetTracker::MAX_TARGETS; ++h) {
+    if (m_frameFeatures.handPointableCount[h] == 0 || m_frameFeatures.handDirection[h].z >= 0) {
+      continue;
     }
+    const int f = m_frameFeatures.findPointable(m_frameFeatures.foremostPointableIdOfHand(h));
+    TargetTracker::Measurement &measurement = measurements[count++];
+    measurement.handId = m_frameFeatures.handId[h];
+    measurement.pointableId = m_frameFeatures.pointableId[f];
+    measurement.position = smoothedTipPosition(m_currentFrame.pointable(measurement.pointableId));
+    measurement.velocity = m_frameFeatures.tipVelocity[f];
+    measurement.touchDistance = m_frameFeatures.touchDistance[f];
   }
-  return false;
+  m_handTracker.update(m_currentFrame.timestamp(), measurements, count);
+}
+
+bool BasicMode::shouldBeInMultiHandMode() const {
+  return m_handTracker.numVisible() > 1;
+}
+
+bool BasicMode::shouldStayInMultiHandMode(int &target1, int &target2) const {
+  // the two hands seen first, which are kept through brief dropouts
+  if (m_handTracker.count() < 2) {
+    return false;
+  }
+  target1 = 0;
+  target2 = 1;
+  return true;
 }
 
 bool BasicMode::shouldBeInPalmSwipeMode () const {
@@ -207,6 +221,10 @@ bool BasicMode::hasFingersTouching(const Hand& hand) const {
   if (!hand.isValid()) {
     return false;
   }
+  const int h = m_frameFeatures.findHand(hand.id());
+  if (h >= 0) {
+    return m_frameFeatures.handTouchingCount[h] > 0;
+  }
   PointableList pointables = hand.pointables();
   for (int i=0; i<pointables.count(); i++) {
     if (pointables[i].touchZone() == Pointable::ZONE_TOUCHING) {
@@ -218,7 +236,7 @@ bool BasicMode::hasFingersTouching(const Hand& hand) const {
 
 // This macro is part of the state machine -- used for convenience, to avoid
 // having to type such a long and ugly statement.
-#define BASICMODE_TRANSITION_TO(x) m_basicModeStateMachine.SetNextState(&BasicMode::x, #x)
+#define BASICMODE_TRANSITION_TO(x) m_basicModeStateMachine.SetNextState(x##_Id)
 
 void BasicMode::BasicMode_TransitionTo_NPointables_NoInteraction () {
   m_lastStateChangeTime = m_currentFrame.timestamp();
@@ -443,7 +461,7 @@ bool BasicMode::State_BasicMode_2PlusPointables_Hovering (StateMachineInput inpu
           return true;
         }
 
-        m_favoriteHandId = m_currentFrame.pointable(favoritePointableId()).hand().id();
+        m_favoriteHandId = handOfPointable(favoritePointableId()).id();
       }
 
       // if no hand in view, just draw normal overlay
@@ -571,7 +589,7 @@ bool BasicMode::State_BasicMode_2PlusPointables_Scrolling (StateMachineInput inp
 }
 
 bool BasicMode::State_BasicMode_2Hands_Hovering (StateMachineInput input) {
-  int32_t pointable1, pointable2;
+  int target1, target2;
   switch (input) {
     case OMB__LOST_FOCUS:
       BASICMODE_TRANSITION_TO(State_BasicMode_0Pointables_NoInteraction);
@@ -583,7 +601,7 @@ bool BasicMode::State_BasicMode_2Hands_Hovering (StateMachineInput input) {
       resetFavoritePointableId();
     case OMB__PROCESS_FRAME:
       // handle state group changes
-      if (!shouldBeInMultiHandMode(&pointable1, &pointable2)) {
+      if (!shouldStayInMultiHandMode(target1, target2)) {
         BasicMode_TransitionTo_NPointables_NoInteraction();
         return true;
       }
@@ -600,16 +618,16 @@ bool BasicMode::State_BasicMode_2Hands_Hovering (StateMachineInput input) {
 
       if (UseMouseOutput) {
         // handle cursor positioning
-        GestureInteractionManager::setAbsoluteCursorPositionPointable(m_currentFrame.pointable(pointable1));
+        setAbsoluteCursorPosition(m_handTracker.target(target1).getTrackedPosition());
       } else {
-        addTouchPointForPointable(pointable1, m_currentFrame.pointable(pointable1), false, false);
-        addTouchPointForPointable(pointable2, m_currentFrame.pointable(pointable2), false, false);
+        addTouchPointForTarget(m_handTracker.target(target1), false);
+        addTouchPointForTarget(m_handTracker.target(target2), false);
       }
 
       float alphaMult = alphaFromTimeVisible((1.0f/SECONDS)*static_cast<float>(m_currentFrame.timestamp() - m_lastStateChangeTime));
-      drawOverlayForPointable(m_currentFrame.pointable(pointable1), 0, alphaMult, false);
+      drawOverlayForTarget(m_handTracker.target(target1), 0, alphaMult);
       m_lastNumIcons++;
-      drawOverlayForPointable(m_currentFrame.pointable(pointable2), 1, alphaMult, false);
+      drawOverlayForTarget(m_handTracker.target(target2), 1, alphaMult);
       m_lastNumIcons++;
 
       return true;
@@ -619,7 +637,7 @@ bool BasicMode::State_BasicMode_2Hands_Hovering (StateMachineInput input) {
 
 // Mouse mode only
 bool BasicMode::State_BasicMode_2Hands_GestureRecognition (StateMachineInput input) {
-  int32_t pointable1, pointable2;
+  int target1, target2;
   switch (input) {
     case OMB__LOST_FOCUS:
       BASICMODE_TRANSITION_TO(State_BasicMode_0Pointables_NoInteraction);
@@ -631,7 +649,7 @@ bool BasicMode::State_BasicMode_2Hands_GestureRecognition (StateMachineInput inp
       m_gestureStart = m_currentFrame;
     case OMB__PROCESS_FRAME: {
       // handle state group changes
-      if (!shouldBeInMultiHandMode(&pointable1, &pointable2)) {
+      if (!shouldStayInMultiHandMode(target1, target2)) {
         BasicMode_TransitionTo_NPointables_NoInteraction();
         return true;
       }
@@ -655,9 +673,9 @@ bool BasicMode::State_BasicMode_2Hands_GestureRecognition (StateMachineInput inp
       }
 
       float alphaMult = alphaFromTimeVisible((1.0f/SECONDS)*static_cast<float>(m_currentFrame.timestamp() - m_lastStateChangeTime));
-      drawOverlayForPointable(m_currentFrame.pointable(pointable1), 0, alphaMult, false);
+      drawOverlayForTarget(m_handTracker.target(target1), 0, alphaMult);
       m_lastNumIcons++;
-      drawOverlayForPointable(m_currentFrame.pointable(pointable2), 1, alphaMult, false);
+      drawOverlayForTarget(m_handTracker.target(target2), 1, alphaMult);
       m_lastNumIcons++;
 
       // if no gesture "won", it's ok, it may just take more frames before it's clear.
@@ -669,7 +687,7 @@ bool BasicMode::State_BasicMode_2Hands_GestureRecognition (StateMachineInput inp
 
 // Mouse mode only
 bool BasicMode::State_BasicMode_2Hands_Rotating (StateMachineInput input) {
-  int32_t pointable1, pointable2;
+  int target1, target2;
   switch (input) {
     case OMB__LOST_FOCUS:
       BASICMODE_TRANSITION_TO(State_BasicMode_0Pointables_NoInteraction);
@@ -690,7 +708,7 @@ bool BasicMode::State_BasicMode_2Hands_Rotating (StateMachineInput input) {
 
     case OMB__PROCESS_FRAME:
       // handle state group changes
-      if (!shouldBeInMultiHandMode(&pointable1, &pointable2)) {
+      if (!shouldStayInMultiHandMode(target1, target2)) {
         BasicMode_TransitionTo_NPointables_NoInteraction();
         return true;
       }
@@ -707,9 +725,9 @@ bool BasicMode::State_BasicMode_2Hands_Rotating (StateMachineInput input) {
       applyRotation(-Leap::RAD_TO_DEG*m_currentFrame.rotationAngle(m_sinceFrame, Vector::zAxis()));
 
       float alphaMult = alphaFromTimeVisible((1.0f/SECONDS)*static_cast<float>(m_currentFrame.timestamp() - m_lastStateChangeTime));
-      drawOverlayForPointable(m_currentFrame.pointable(pointable1), 0, alphaMult, false);
+      drawOverlayForTarget(m_handTracker.target(target1), 0, alphaMult);
       m_lastNumIcons++;
-      drawOverlayForPointable(m_currentFrame.pointable(pointable2), 1, alphaMult, false);
+      drawOverlayForTarget(m_handTracker.target(target2), 1, alphaMult);
       m_lastNumIcons++;
 
       return true;
@@ -719,7 +737,7 @@ bool BasicMode::State_BasicMode_2Hands_Rotating (StateMachineInput input) {
 
 // Mouse mode only
 bool BasicMode::State_BasicMode_2Hands_Zooming (StateMachineInput input) {
-  int32_t pointable1, pointable2;
+  int target1, target2;
   switch (input) {
     case OMB__LOST_FOCUS:
       BASICMODE_TRANSITION_TO(State_BasicMode_0Pointables_NoInteraction);
@@ -730,7 +748,7 @@ bool BasicMode::State_BasicMode_2Hands_Zooming (StateMachineInput input) {
       m_drawOverlays = true;
       // generate begin-zoom event
       beginGesture(LPGesture::GestureZoom);
-      applyZoom(static_cast<float>(1 + ZoomScaleFactor * (m_currentFrame.scaleFactor(m_gestureStart) - 1)));
+      applyZoom(static_cast<float>(1 + m_tuning.zoomScaleFactor * (m_currentFrame.scaleFactor(m_gestureStart) - 1)));
       return true;
 
     case SM_EXIT:
@@ -740,7 +758,7 @@ bool BasicMode::State_BasicMode_2Hands_Zooming (StateMachineInput input) {
 
     case OMB__PROCESS_FRAME:
       // handle state group changes
-      if (!shouldBeInMultiHandMode(&pointable1, &pointable2)) {
+      if (!shouldStayInMultiHandMode(target1, target2)) {
         BasicMode_TransitionTo_NPointables_NoInteraction();
         return true;
       }
@@ -754,12 +772,12 @@ bool BasicMode::State_BasicMode_2Hands_Zooming (StateMachineInput input) {
       }
 
       // apply zoom
-      applyZoom(static_cast<float>(1 + ZoomScaleFactor * (m_currentFrame.scaleFactor(m_sinceFrame) - 1)));
+      applyZoom(static_cast<float>(1 + m_tuning.zoomScaleFactor * (m_currentFrame.scaleFactor(m_sinceFrame) - 1)));
 
       float alphaMult = alphaFromTimeVisible((1.0f/SECONDS)*static_cast<float>(m_currentFrame.timestamp() - m_lastStateChangeTime));
-      drawOverlayForPointable(m_currentFrame.pointable(pointable1), 0, alphaMult, false);
+      drawOverlayForTarget(m_handTracker.target(target1), 0, alphaMult);
       m_lastNumIcons++;
-      drawOverlayForPointable(m_currentFrame.pointable(pointable2), 1, alphaMult, false);
+      drawOverlayForTarget(m_handTracker.target(target2), 1, alphaMult);
       m_lastNumIcons++;
 
       return true;
@@ -769,7 +787,7 @@ bool BasicMode::State_BasicMode_2Hands_Zooming (StateMachineInput input) {
 
 // Touch mode only
 bool BasicMode::State_BasicMode_2Hands_Touch (StateMachineInput input) {
-  int32_t pointable1, pointable2;
+  int target1, target2;
   switch (input) {
     case OMB__LOST_FOCUS:
       BASICMODE_TRANSITION_TO(State_BasicMode_0Pointables_NoInteraction);
@@ -780,7 +798,7 @@ bool BasicMode::State_BasicMode_2Hands_Touch (StateMachineInput input) {
       m_drawOverlays = true;
     case OMB__PROCESS_FRAME:
       // handle state group changes
-      if (!shouldBeInMultiHandMode(&pointable1, &pointable2)) {
+      if (!shouldStayInMultiHandMode(target1, target2)) {
         BasicMode_TransitionTo_NPointables_NoInteraction();
         return true;
       }
@@ -790,13 +808,13 @@ bool BasicMode::State_BasicMode_2Hands_Touch (StateMachineInput input) {
         BASICMODE_TRANSITION_TO(State_BasicMode_2Hands_Hovering);
       }
 
-      addTouchPointForPointable(pointable1, m_currentFrame.pointable(pointable1), true, false);
-      addTouchPointForPointable(pointable2, m_currentFrame.pointable(pointable2), true, false);
+      addTouchPointForTarget(m_handTracker.target(target1), true);
+      addTouchPointForTarget(m_handTracker.target(target2), true);
 
       float alphaMult = alphaFromTimeVisible((1.0f/SECONDS)*static_cast<float>(m_currentFrame.timestamp() - m_lastStateChangeTime));
-      drawOverlayForPointable(m_currentFrame.pointable(pointable1), 0, alphaMult, false);
+      drawOverlayForTarget(m_handTracker.target(target1), 0, alphaMult);
       m_lastNumIcons++;
-      drawOverlayForPointable(m_currentFrame.pointable(pointable2), 1, alphaMult, false);
+      drawOverlayForTarget(m_handTracker.target(target2), 1, alphaMult);
       m_lastNumIcons++;
 
       return true;
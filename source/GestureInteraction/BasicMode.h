@@ -18,9 +18,10 @@ namespace Touchless {
 class BasicMode : public GestureInteractionManager {
 // This class is used for both Intro and Basic modes
 public:
-  BasicMode(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver);
+  BasicMode(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver, const InteractionTuning& tuning = InteractionTuning());
   virtual ~BasicMode();
   virtual void stopActiveEvents();
+  virtual const char* stateName () const { return m_basicModeStateMachine.CurrentStateName(); }
 
   static void SetIntroMode();
   static void SetBasicMode();
@@ -43,7 +44,6 @@ private:
   static bool DisableAllOverlays;
   static bool DisableHorizontalScrolling;
   static float TranslationScaleFactor;
-  static float ZoomScaleFactor;
 
   bool                                  m_drawOverlays;
   bool                                  m_noTouching;
@@ -56,11 +56,12 @@ private:
   Vector                                m_clickDownScreenPosition;
   Vector                                m_scrollStartPosition;
   int                                   m_scrollDrawCount;
-  StateMachine<BasicMode>   m_basicModeStateMachine;
+  TableStateMachine<BasicMode> m_basicModeStateMachine;
   int                                   m_lastNumIcons;
   int                                   m_charmsMode;
   int64_t                               m_lastStateChangeTime;
   int32_t                               m_favoriteHandId;
+  TargetTracker                         m_handTracker;      // the hands of the two-hand states
   Pointable                             m_clickPointable;
   bool                                  m_updateCursor;
 
@@ -69,7 +70,10 @@ private:
   void generateScrollBetweenFrames (const Frame &currentFrame, const Frame &sinceFrame);
   void generateDesktopSwipeBetweenFrames (const Frame &currentFrame, const Frame &sinceFrame);
 
-  bool shouldBeInMultiHandMode(int32_t *pointableId1 = nullptr, int32_t *pointableId2 = nullptr);
+  void updateHandTracker();
+  // two hands must be in view to enter the two-hand states, and the two hands seen first keep them there
+  bool shouldBeInMultiHandMode() const;
+  bool shouldStayInMultiHandMode(int &target1, int &target2) const;
   bool shouldBeInPalmSwipeMode () const;
   bool hasFingersTouching(const Hand& hand) const;
 
@@ -93,6 +97,24 @@ private:
   bool State_BasicMode_Palm_GestureRecognition (StateMachineInput input);
   bool State_BasicMode_Palm_Swipe (StateMachineInput input);
   // end of OUTPUT_MODE_BASIC state handlers
+
+  // the states, once each in the order of the state table
+  #define BASICMODE_STATES(STATE) \
+    STATE(State_BasicMode_0Pointables_NoInteraction) \
+    STATE(State_BasicMode_1Pointable_Hovering) \
+    STATE(State_BasicMode_1Pointable_ClickCooldown) \
+    STATE(State_BasicMode_2PlusPointables_Hovering) \
+    STATE(State_BasicMode_2PlusPointables_Scrolling) \
+    STATE(State_BasicMode_2Hands_Hovering) \
+    STATE(State_BasicMode_2Hands_GestureRecognition) \
+    STATE(State_BasicMode_2Hands_Rotating) \
+    STATE(State_BasicMode_2Hands_Zooming) \
+    STATE(State_BasicMode_2Hands_Touch) \
+    STATE(State_BasicMode_Palm_GestureRecognition) \
+    STATE(State_BasicMode_Palm_Swipe)
+
+  enum StateId { BASICMODE_STATES(STATE_TABLE_ID) BASICMODE__STATE_COUNT };
+  static const TableStateMachine<BasicMode>::StateEntry s_states[BASICMODE__STATE_COUNT];
 };
 
 }
@@ -23,9 +23,11 @@ bool FingerMouse::Use3PlusFingerGestures = true;
 bool FingerMouse::UseRotateandZoom = true;
 bool FingerMouse::DisableAllOverlays = false;
 FingerMouse::CURSOR_MOVE_TYPE FingerMouse::CursorMoveType = ANY_HOVER;
-float FingerMouse::ZoomScaleFactor = 1.5;
 float FingerMouse::TranslationScaleFactor = 1.5;
-const int64_t FingerMouse::HoverDurationToActivateDrag = 500*FingerMouse::MILLISECONDS;
+
+#define FINGERMOUSE_STATE_ENTRY(x) STATE_TABLE_ENTRY(FingerMouse, x)
+const TableStateMachine<FingerMouse>::StateEntry FingerMouse::s_states[] = { FINGERMOUSE_STATES(FINGERMOUSE_STATE_ENTRY) };
+#undef FINGERMOUSE_STATE_ENTRY
 
 // ////////////////////////////////////////////////////
 //OUTPUT_MODE_FINGER_MOUSE process helper functions
@@ -44,9 +46,9 @@ const int64_t FingerMouse::HoverDurationToActivateDrag = 500*FingerMouse::MILLIS
 //
 // The states correspond roughly exactly with the state of interaction.
 
-FingerMouse::FingerMouse(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver)
+FingerMouse::FingerMouse(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver, const InteractionTuning& tuning)
   :
-  GestureInteractionManager(osInteractionDriver, overlayDriver),
+  GestureInteractionManager(osInteractionDriver, overlayDriver, tuning),
   m_drawOverlays(true),
   m_noTouching(true),
   m_clickDuration(0),
@@ -54,10 +56,12 @@ FingerMouse::FingerMouse(OSInteractionDriver& osInteractionDriver, OverlayDriver
   m_lastClickTime(0),
   m_mountainLionOrNewer(false)
 {
-  m_fingerMouseStateMachine.SetOwnerClass(this, "FingerMouse");
+  m_fingerMouseStateMachine.SetOwnerClass(this, "FingerMouse", s_states, FINGERMOUSE__STATE_COUNT);
+  m_fingerMouseStateMachine.SetTraceFrameId(&m_frameFeatures.frameId);
 
-  // This tells the state machine to log transitions to cerr.  An optional second can be used to specify
-  // an event ID to ignore (such as something that happens every single frame) to avoid spamming the console.
+  // Transitions are always recorded in the TransitionTrace.  This also tells the state machine to log them to
+  // cerr, as text, for debugging.  An optional second can be used to specify an event ID to ignore (such as
+  // something that happens every single frame) to avoid spamming the console.
   // Specify that OMFM__PROCESS_FRAME should be ignored.
   //m_fingerMouseStateMachine.SetTransitionLogger(&std::cerr, OMFM__PROCESS_FRAME);
 
@@ -84,12 +88,10 @@ FingerMouse::~FingerMouse() {
 }
 
 void FingerMouse::processFrameInternal() {
-  m_noTouching = std::count_if(m_relevantPointables.begin(), m_relevantPointables.end(),
-                          [this] (const Pointable& pointable) {return pointable.touchZone() == Pointable::ZONE_TOUCHING;}) == 0;
+  m_noTouching = m_frameFeatures.relevantInZone(Pointable::ZONE_TOUCHING) == 0;
   // initialize finger mouse state machine if necessary
   if (!m_fingerMouseStateMachine.IsInitialized()) {
-    m_fingerMouseStateMachine.Initialize(&FingerMouse::State_FingerMouse_0Fingers_NoInteraction,
-                                         "State_FingerMouse_0Fingers_NoInteraction");
+    m_fingerMouseStateMachine.Initialize(State_FingerMouse_0Fingers_NoInteraction_Id);
   }
 
   // clear overlays
@@ -109,14 +111,14 @@ void FingerMouse::processFrameInternal() {
 #endif
 }
 
-Pointable::Zone FingerMouse::identifyCollectivePointableZone (const std::vector<Pointable> &pointables) const {
+Pointable::Zone FingerMouse::identifyCollectivePointableZone (const FrameFeatures &features) const {
   // for now, use the "maximum" of the pointables' zones, where the order is given by the enum values
   // ZONE_NONE = 0, ZONE_HOVERING = 1, ZONE_TOUCHING = 2.
 
   Pointable::Zone max = Pointable::ZONE_NONE;
-  for (size_t i = 0; i < pointables.size(); ++i) {
-    if (max < pointables[i].touchZone()) {
-      max = pointables[i].touchZone();
+  for (int k = 0; k < features.relevantCount; ++k) {
+    if (max < features.touchZone[features.relevant[k]]) {
+      max = features.touchZone[features.relevant[k]];
     }
   }
   return max;
@@ -127,52 +129,52 @@ void FingerMouse::DrawOverlays() {
     return;
   }
 
-  Vector screenPosition, clampVec;
+  const FrameFeatures &features = m_frameFeatures;
   for (int i = 0; i < m_numOverlayImages; ++i) {
-    if (i < static_cast<int>(m_relevantPointables.size()) &&
-        normalizedToScreen(interactionBox().normalizePoint(m_relevantPointables[i].stabilizedTipPosition()),
-                           screenPosition,
-                           clampVec)) {
-      float clampDist = clampVec.magnitude();
+    const int f = i < features.relevantCount ? features.relevant[i] : -1;
+    if (f >= 0 && features.onScreen[f]) {
+      const Vector &screenPosition = features.screenPosition[f];
+      float clampDist = features.clampVec[f].magnitude();
       if (useProceduralOverlay()) {
-        float touchDistance = m_relevantPointables[i].touchDistance();
+        float touchDistance = features.touchDistance[f];
         double radius = touchDistanceToRadius(touchDistance);
         // TEMP: hacky way to do hover-drag visualization
         // if we are clicking, grow the radius of the icon to indicate drag progress
         if (m_fingerMouseStateMachine.CurrentState() ==
-            &FingerMouse::State_FingerMouse_1Finger_Clicking &&
+            State_FingerMouse_1Finger_Clicking_Id &&
             m_clickEligibleForDrag) {
-          double parameter = double(m_clickDuration) / HoverDurationToActivateDrag;
+          double parameter = double(m_clickDuration) / m_tuning.hoverDurationToActivateDrag;
           if (parameter > 1.0) {
             parameter = 1.0;
           }
           // linearly interpolate from the touchDistance-based radius to the max dragging-icon-radius.
           radius = (1.0-parameter)*radius + parameter*30.0*0.7*0.8;
         } else if (m_fingerMouseStateMachine.CurrentState() ==
-                   &FingerMouse::State_FingerMouse_1Finger_Dragging) {
+                   State_FingerMouse_1Finger_Dragging_Id) {
           radius = 30.0*0.7;
         } else {
           if (touchDistance < 0.0) {
             radius = 10.0;
           }
         }
-        drawRasterIcon(i,
-                       screenPosition.x,
-                       screenPosition.y,
-                       true,
-                       m_relevantPointables[i].tipVelocity().toVector3<Vector3>(),
-                       touchDistance,
-                       radius,
-                       clampDist,
-                       alphaFromTimeVisible(m_relevantPointables[i].timeVisible()));
+        queueRasterIcon(i,
+                        screenPosition.x,
+                        screenPosition.y,
+                        true,
+                        features.tipVelocity[f].toVector3<Vector3>(),
+                        touchDistance,
+                        radius,
+                        clampDist,
+                        alphaFromTimeVisible(features.timeVisible[f]));
       } else {
-        int imageIndex = findImageIndex(m_relevantPointables[i].touchDistance(), 0, 1);
+        int imageIndex = findImageIndex(features.touchDistance[f], 0, 1);
         drawImageIcon(i, imageIndex, screenPosition.x, screenPosition.y, true);
       }
     } else {
       setIconVisibility(i, false);
     }
   }
+  drawQueuedIcons();
 }
 
 void FingerMouse::stopActiveEvents()
@@ -206,19 +208,20 @@ void FingerMouse::DrawClickingOrDraggingOverlay() {
     normalizedToScreen(interactionBox().normalizePoint(position),
                        screenPosition,
                        clampVec);
+    const int f = m_frameFeatures.findPointable(favorite_pointable.id());
     float clampDist = clampVec.magnitude();
-    float touchDistance = favorite_pointable.touchDistance();
+    float touchDistance = f >= 0 ? m_frameFeatures.touchDistance[f] : favorite_pointable.touchDistance();
     double radius = touchDistanceToRadius(touchDistance);
     // TEMP: hacky way to do hover-drag visualization
     // if we are clicking, grow the radius of the icon to indicate drag progress
     if (m_fingerMouseStateMachine.CurrentState() ==
-        &FingerMouse::State_FingerMouse_1Finger_Clicking &&
+        State_FingerMouse_1Finger_Clicking_Id &&
         m_clickEligibleForDrag) {
-      double parameter = double(m_clickDuration) / HoverDurationToActivateDrag;
+      double parameter = double(m_clickDuration) / m_tuning.hoverDurationToActivateDrag;
       // linearly interpolate from the touchDistance-based radius to the max dragging-icon-radius.
       radius = (1.0-parameter)*radius + parameter*30.0*0.7*0.8;
     } else if (m_fingerMouseStateMachine.CurrentState() ==
-               &FingerMouse::State_FingerMouse_1Finger_Dragging) {
+               State_FingerMouse_1Finger_Dragging_Id) {
       radius = 30.0*0.7;
     } else {
       if (touchDistance < 0.0) {
@@ -229,11 +232,11 @@ void FingerMouse::DrawClickingOrDraggingOverlay() {
                    screenPosition.x,
                    screenPosition.y,
                    true,
-                   favorite_pointable.tipVelocity().toVector3<Vector3>(),
+                   (f >= 0 ? m_frameFeatures.tipVelocity[f] : favorite_pointable.tipVelocity()).toVector3<Vector3>(),
                    touchDistance,
                    radius,
                    clampDist,
-                   alphaFromTimeVisible(favorite_pointable.timeVisible()));
+                   alphaFromTimeVisible(f >= 0 ? m_frameFeatures.timeVisible[f] : favorite_pointable.timeVisible()));
   }
 }
 
@@ -248,7 +251,7 @@ void FingerMouse::DrawScrollOverlay(bool doubleHorizontalDots, bool doubleVertic
     return;
   }
 
-  Hand hand = favorite_pointable.hand();
+  Hand hand = handOfPointable(favorite_pointable.id());
   if (!hand.isValid()) {
     drawScrollOverlayForPointable(favorite_pointable);
   } else {
@@ -268,7 +271,7 @@ void FingerMouse::DrawRotateOverlay() {
     return;
   }
 
-  Hand hand = favorite_pointable.hand();
+  Hand hand = handOfPointable(favorite_pointable.id());
   if (!hand.isValid()) {
     drawRotateOverlayForPointable(favorite_pointable);
   } else {
@@ -288,7 +291,7 @@ void FingerMouse::DrawZoomOverlay() {
     return;
   }
 
-  Hand hand = favorite_pointable.hand();
+  Hand hand = handOfPointable(favorite_pointable.id());
   if (!hand.isValid()) {
     drawZoomOverlayForPointable(favorite_pointable);
   } else {
@@ -308,7 +311,7 @@ void FingerMouse::DrawDesktopSwipeOverlay(bool movementGlow) {
     return;
   }
 
-  Hand hand = favorite_pointable.hand();
+  Hand hand = handOfPointable(favorite_pointable.id());
   if (!hand.isValid()) {
     drawScrollOverlayForPointable(favorite_pointable, 1.0f, nullptr, true, false, movementGlow, movementGlow); // double horizontal dots, not vertical ones
   } else {
@@ -326,7 +329,7 @@ void FingerMouse::DrawVerticalPalmOverlay() {
   Hand hand;
   Pointable favorite_pointable = m_currentFrame.pointable(favoritePointableId());
   if (favorite_pointable.isValid()) {
-    hand = favorite_pointable.hand();
+    hand = handOfPointable(favorite_pointable.id());
   } else {
     if (m_currentFrame.hands().count() != 0) {
       hand = m_currentFrame.hands()[0];
@@ -351,6 +354,15 @@ void FingerMouse::setDeltaTrackedAbsoluteCursorPositionHand (const Hand &hand, V
   GestureInteractionManager::setAbsoluteCursorPosition(m_positionalDeltaTracker.getTrackedPosition(), calculatedScreenPosition);
 }
 
+void FingerMouse::setDeltaTrackedAbsoluteCursorPositionFavorite () {
+  const Hand hand = handOfPointable(favoritePointableId());
+  if (hand.isValid()) {
+    setDeltaTrackedAbsoluteCursorPositionHand(hand);
+  } else {
+    setDeltaTrackedAbsoluteCursorPositionPointable(m_currentFrame.pointable(favoritePointableId()));
+  }
+}
+
 void FingerMouse::setDeltaTrackedAbsoluteCursorPositionPointable (const Pointable &pointable, Vector *calculatedScreenPosition) {
   if (!pointable.isValid()) {
     return;
@@ -458,7 +470,7 @@ bool FingerMouse::shouldBeInPalmSwipeMode () const {
       hand = m_currentFrame.hands()[0];
     }
   } else {
-    hand = favorite_pointable.hand();
+    hand = handOfPointable(favorite_pointable.id());
   }
   if (!hand.isValid()) {
     return false;
@@ -469,7 +481,7 @@ bool FingerMouse::shouldBeInPalmSwipeMode () const {
 
 // This macro is part of the state machine -- used for convenience, to avoid
 // having to type such a long and ugly statement.
-#define FINGERMOUSE_TRANSITION_TO(x) m_fingerMouseStateMachine.SetNextState(&FingerMouse::x, #x)
+#define FINGERMOUSE_TRANSITION_TO(x) m_fingerMouseStateMachine.SetNextState(x##_Id)
 
 void FingerMouse::FingerMouse_TransitionTo_NFingers_NoInteraction () {
   if (Use3PlusFingerGestures && shouldBeInPalmSwipeMode()) {
@@ -628,7 +640,7 @@ bool FingerMouse::State_FingerMouse_1Finger_Clicking (StateMachineInput input) {
         if (distance >= 50) {
           m_clickEligibleForDrag = false;
         }
-        if (m_clickEligibleForDrag && m_clickDuration > HoverDurationToActivateDrag) {
+        if (m_clickEligibleForDrag && m_clickDuration > m_tuning.hoverDurationToActivateDrag) {
           m_deferClickUpForDrag = true;
           m_clickNumber = 0; // no double click after drag
           FINGERMOUSE_TRANSITION_TO(State_FingerMouse_1Finger_Dragging);
@@ -707,11 +719,7 @@ bool FingerMouse::State_FingerMouse_2Fingers_Hovering (StateMachineInput input)
 
       DrawScrollOverlay();
 
-      if (m_currentFrame.pointable(favoritePointableId()).hand().isValid()) {
-        setDeltaTrackedAbsoluteCursorPositionHand(m_currentFrame.pointable(favoritePointableId()).hand());
-      } else {
-        setDeltaTrackedAbsoluteCursorPositionPointable(m_currentFrame.pointable(favoritePointableId()));
-      }
+      setDeltaTrackedAbsoluteCursorPositionFavorite();
 
       return true;
   }
@@ -727,11 +735,7 @@ bool FingerMouse::State_FingerMouse_2Fingers_GestureRecognition (StateMachineInp
     case SM_ENTER:
       m_drawOverlays = true;
       m_gestureStart = m_currentFrame;
-      if (m_currentFrame.pointable(favoritePointableId()).hand().isValid()) {
-        setDeltaTrackedAbsoluteCursorPositionHand(m_currentFrame.pointable(favoritePointableId()).hand());
-      } else {
-        setDeltaTrackedAbsoluteCursorPositionPointable(m_currentFrame.pointable(favoritePointableId()));
-      }    case OMFM__PROCESS_FRAME: {
+      setDeltaTrackedAbsoluteCursorPositionFavorite();    case OMFM__PROCESS_FRAME: {
       // handle finger-count changes
       if ((pointableCountIsUnambiguous() && pointableCount() == 0) || shouldBeInPalmSwipeMode()) {
         FingerMouse_TransitionTo_NFingers_NoInteraction();
@@ -750,21 +754,23 @@ bool FingerMouse::State_FingerMouse_2Fingers_GestureRecognition (StateMachineInp
 
       auto it = m_timedFrameHistory.getFrameHavingAgeAtLeast(100*MILLISECONDS);
       if (it != m_timedFrameHistory.end()) {
-        const Frame &frame = it->second;
-        Vector translation = m_currentFrame.translation(frame);
-        float time_delta = float(m_currentFrame.timestamp() - frame.timestamp()) / SECONDS;
+        const Snapshot &frame = it->second;
+        float rotationProbability, translationProbability, scaleProbability;
+        probabilitiesBetween(m_currentSnapshot, frame, rotationProbability, translationProbability, scaleProbability);
+        Vector translation = translationBetween(m_currentSnapshot, frame);
+        float time_delta = float(m_currentSnapshot.data.timestamp - frame.data.timestamp) / SECONDS;
         float effective_translation_magnitude = sqrt(translation.x*translation.x + translation.y*translation.y);
         float effective_translation_velocity = effective_translation_magnitude / time_delta;
         //std::cerr << "effective_translation_magnitude = " << effective_translation_magnitude
         //          << "effective velocity = " << effective_translation_velocity << '\n';
         static const float THRESHOLD = 0.75f;
-        if (m_currentFrame.rotationProbability(frame) > THRESHOLD) {
+        if (rotationProbability > THRESHOLD) {
           FINGERMOUSE_TRANSITION_TO(State_FingerMouse_2Fingers_Rotating);
           return true;
-        } else if (m_currentFrame.scaleProbability(frame) > THRESHOLD) {
+        } else if (scaleProbability > THRESHOLD) {
           FINGERMOUSE_TRANSITION_TO(State_FingerMouse_2Fingers_Zooming);
           return true;
-        } else if (m_currentFrame.translationProbability(frame) > THRESHOLD && effective_translation_velocity > 50.0f) {
+        } else if (translationProbability > THRESHOLD && effective_translation_velocity > 50.0f) {
           FINGERMOUSE_TRANSITION_TO(State_FingerMouse_2Fingers_Scrolling);
           return true;
         }
@@ -832,11 +838,7 @@ bool FingerMouse::State_FingerMouse_2Fingers_Rotating (StateMachineInput input)
       // handle cursor positioning
       if (CursorMoveType == ALWAYS) {
         //setAbsoluteCursorPosition();
-        if (m_currentFrame.pointable(favoritePointableId()).hand().isValid()) {
-          setDeltaTrackedAbsoluteCursorPositionHand(m_currentFrame.pointable(favoritePointableId()).hand());
-        } else {
-          setDeltaTrackedAbsoluteCursorPositionPointable(m_currentFrame.pointable(favoritePointableId()));
-        }
+        setDeltaTrackedAbsoluteCursorPositionFavorite();
       }
 
       // apply rotation
@@ -928,11 +930,7 @@ bool FingerMouse::State_FingerMouse_2Fingers_Scrolling (StateMachineInput input)
       // handle cursor positioning
       if (CursorMoveType == ALWAYS) {
         //setAbsoluteCursorPosition();
-        if (m_currentFrame.pointable(favoritePointableId()).hand().isValid()) {
-          setDeltaTrackedAbsoluteCursorPositionHand(m_currentFrame.pointable(favoritePointableId()).hand());
-        } else {
-          setDeltaTrackedAbsoluteCursorPositionPointable(m_currentFrame.pointable(favoritePointableId()));
-        }
+        setDeltaTrackedAbsoluteCursorPositionFavorite();
       }
 
       return true;
@@ -950,7 +948,7 @@ bool FingerMouse::State_FingerMouse_2Fingers_Zooming (StateMachineInput input) {
       m_drawOverlays = true;
       // generate begin-zoom event
       beginGesture(LPGesture::GestureZoom);
-      applyZoom(static_cast<float>(1 + ZoomScaleFactor * (m_currentFrame.scaleFactor(m_gestureStart) - 1)));
+      applyZoom(static_cast<float>(1 + m_tuning.zoomScaleFactor * (m_currentFrame.scaleFactor(m_gestureStart) - 1)));
       return true;
 
     case SM_EXIT:
@@ -978,15 +976,11 @@ bool FingerMouse::State_FingerMouse_2Fingers_Zooming (StateMachineInput input) {
       // handle cursor positioning
       if (CursorMoveType == ALWAYS) {
         //setAbsoluteCursorPosition();
-        if (m_currentFrame.pointable(favoritePointableId()).hand().isValid()) {
-          setDeltaTrackedAbsoluteCursorPositionHand(m_currentFrame.pointable(favoritePointableId()).hand());
-        } else {
-          setDeltaTrackedAbsoluteCursorPositionPointable(m_currentFrame.pointable(favoritePointableId()));
-        }
+        setDeltaTrackedAbsoluteCursorPositionFavorite();
       }
 
       // apply zoom
-      applyZoom(static_cast<float>(1 + ZoomScaleFactor * (m_currentFrame.scaleFactor(m_sinceFrame) - 1)));
+      applyZoom(static_cast<float>(1 + m_tuning.zoomScaleFactor * (m_currentFrame.scaleFactor(m_sinceFrame) - 1)));
 
       return true;
   }
@@ -1023,11 +1017,7 @@ bool FingerMouse::State_FingerMouse_3PlusFingers_NoInteraction (StateMachineInpu
       // handle cursor positioning
       if (CursorMoveType == ALWAYS) {
         //setAbsoluteCursorPosition();
-        if (m_currentFrame.pointable(favoritePointableId()).hand().isValid()) {
-          setDeltaTrackedAbsoluteCursorPositionHand(m_currentFrame.pointable(favoritePointableId()).hand());
-        } else {
-          setDeltaTrackedAbsoluteCursorPositionPointable(m_currentFrame.pointable(favoritePointableId()));
-        }
+        setDeltaTrackedAbsoluteCursorPositionFavorite();
       }
 
       return true;
@@ -1062,11 +1052,7 @@ bool FingerMouse::State_FingerMouse_3PlusFingers_Hovering (StateMachineInput inp
       // handle cursor positioning
       if (CursorMoveType == ALWAYS || CursorMoveType == ANY_HOVER) {
         //setAbsoluteCursorPosition();
-        if (m_currentFrame.pointable(favoritePointableId()).hand().isValid()) {
-          setDeltaTrackedAbsoluteCursorPositionHand(m_currentFrame.pointable(favoritePointableId()).hand());
-        } else {
-          setDeltaTrackedAbsoluteCursorPositionPointable(m_currentFrame.pointable(favoritePointableId()));
-        }
+        setDeltaTrackedAbsoluteCursorPositionFavorite();
       }
 
       return true;
@@ -1103,11 +1089,7 @@ bool FingerMouse::State_FingerMouse_3PlusFingers_GestureRecognition (StateMachin
       // handle cursor positioning
       if (CursorMoveType == ALWAYS) {
         //setAbsoluteCursorPosition();
-        if (m_currentFrame.pointable(favoritePointableId()).hand().isValid()) {
-          setDeltaTrackedAbsoluteCursorPositionHand(m_currentFrame.pointable(favoritePointableId()).hand());
-        } else {
-          setDeltaTrackedAbsoluteCursorPositionPointable(m_currentFrame.pointable(favoritePointableId()));
-        }
+        setDeltaTrackedAbsoluteCursorPositionFavorite();
       }
 
       // if translation "wins", transition to the corresponding state
@@ -1267,7 +1249,7 @@ bool FingerMouse::State_FingerMouse_Palm_GestureRecognition (StateMachineInput i
           hand = m_currentFrame.hands()[0];
         }
       } else {
-        hand = favorite_pointable.hand();
+        hand = handOfPointable(favorite_pointable.id());
       }
       if (!hand.isValid()) {
         FingerMouse_TransitionTo_NFingers_NoInteraction();
@@ -17,14 +17,15 @@ namespace Touchless {
 
 class FingerMouse : public GestureInteractionManager {
 public:
-  FingerMouse(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver);
+  FingerMouse(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver, const InteractionTuning& tuning = InteractionTuning());
   virtual ~FingerMouse();
   virtual void stopActiveEvents();
+  virtual const char* stateName () const { return m_fingerMouseStateMachine.CurrentStateName(); }
 
 protected:
 
   virtual void processFrameInternal();
-  virtual Pointable::Zone identifyCollectivePointableZone (const std::vector<Pointable> &pointables) const;
+  virtual Pointable::Zone identifyCollectivePointableZone (const FrameFeatures &features) const;
   virtual void DrawOverlays();
 
 private:
@@ -48,9 +49,7 @@ private:
   static bool UseRotateandZoom;
   static CURSOR_MOVE_TYPE CursorMoveType;
   static bool DisableAllOverlays;
-  static float ZoomScaleFactor;
   static float TranslationScaleFactor;
-  static const int64_t HoverDurationToActivateDrag;
 
   void DrawPointingOverlay();
   void DrawClickingOrDraggingOverlay();
@@ -70,12 +69,14 @@ private:
   Vector                                      m_lastClickLocation;
   Frame                                       m_gestureStart;
   Vector                                      m_clickDownScreenPosition;
-  StateMachine<FingerMouse>   m_fingerMouseStateMachine;
+  TableStateMachine<FingerMouse> m_fingerMouseStateMachine;
   bool                                        m_mountainLionOrNewer;
 
 
   void setDeltaTrackedAbsoluteCursorPositionHand (const Hand &hand, Vector *calculatedScreenPosition = nullptr);
   void setDeltaTrackedAbsoluteCursorPositionPointable (const Pointable &pointable, Vector *calculatedScreenPosition = nullptr);
+  // follows the favorite pointable's hand, or the pointable itself if it has no hand
+  void setDeltaTrackedAbsoluteCursorPositionFavorite ();
   void generateScrollBetweenFrames (const Frame &currentFrame, const Frame &sinceFrame);
   void generateDesktopSwipeBetweenFrames (const Frame &currentFrame, const Frame &sinceFrame);
   double cdGain (double magnitude, double maxVelocity, double initialPower) const;
@@ -106,6 +107,28 @@ private:
   bool State_FingerMouse_Palm_GestureRecognition (StateMachineInput input);
   bool State_FingerMouse_Palm_Swipe (StateMachineInput input);
   // end of OUTPUT_MODE_FINGER_MOUSE state handlers
+
+  // the states, once each in the order of the state table
+  #define FINGERMOUSE_STATES(STATE) \
+    STATE(State_FingerMouse_0Fingers_NoInteraction) \
+    STATE(State_FingerMouse_1Finger_Hovering) \
+    STATE(State_FingerMouse_1Finger_Clicking) \
+    STATE(State_FingerMouse_1Finger_Dragging) \
+    STATE(State_FingerMouse_2Fingers_Hovering) \
+    STATE(State_FingerMouse_2Fingers_GestureRecognition) \
+    STATE(State_FingerMouse_2Fingers_Rotating) \
+    STATE(State_FingerMouse_2Fingers_Scrolling) \
+    STATE(State_FingerMouse_2Fingers_Zooming) \
+    STATE(State_FingerMouse_3PlusFingers_NoInteraction) \
+    STATE(State_FingerMouse_3PlusFingers_Hovering) \
+    STATE(State_FingerMouse_3PlusFingers_GestureRecognition) \
+    STATE(State_FingerMouse_3PlusFingers_SwipeVertical) \
+    STATE(State_FingerMouse_3PlusFingers_SwipeHorizontal) \
+    STATE(State_FingerMouse_Palm_GestureRecognition) \
+    STATE(State_FingerMouse_Palm_Swipe)
+
+  enum StateId { FINGERMOUSE_STATES(STATE_TABLE_ID) FINGERMOUSE__STATE_COUNT };
+  static const TableStateMachine<FingerMouse>::StateEntry s_states[FINGERMOUSE__STATE_COUNT];
 };
 
 }
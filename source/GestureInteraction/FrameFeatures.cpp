@@ -0,0 +1,103 @@
+#include "stdafx.h"
+#include "FrameFeatures.h"
+#include <algorithm>
+
+namespace Touchless {
+
+static Leap::Vector ToLeapVector(const FrameModel::Vector& vector) {
+  return Leap::Vector(vector.x, vector.y, vector.z);
+}
+
+void FrameFeatures::build(const FrameModel::FrameData& frame) {
+  frameId = frame.id;
+
+  handCount = frame.handCount;
+  for (int h = 0; h < handCount; h++) {
+    const FrameModel::HandData& hand = frame.hands[h];
+    handId[h] = hand.id;
+    stabilizedPalmPosition[h] = ToLeapVector(hand.stabilizedPalmPosition);
+    palmVelocity[h] = ToLeapVector(hand.palmVelocity);
+    handDirection[h] = ToLeapVector(hand.direction);
+    handTimeVisible[h] = hand.timeVisible;
+    handPointableCount[h] = 0;
+    handTouchingCount[h] = 0;
+    handTouchDistance[h] = 1.0f;
+  }
+
+  pointableCount = frame.pointableCount;
+  for (int i = 0; i < pointableCount; i++) {
+    const FrameModel::PointableData& pointable = frame.pointables[i];
+    pointableId[i] = pointable.id;
+    pointableHandId[i] = pointable.handId;
+    tipPosition[i] = ToLeapVector(pointable.tipPosition);
+    stabilizedTipPosition[i] = ToLeapVector(pointable.stabilizedTipPosition);
+    tipVelocity[i] = ToLeapVector(pointable.tipVelocity);
+    direction[i] = ToLeapVector(pointable.direction);
+    touchDistance[i] = pointable.touchDistance;
+    touchZone[i] = static_cast<Leap::Pointable::Zone>(pointable.touchZone);
+    timeVisible[i] = pointable.timeVisible;
+    onScreen[i] = false;
+
+    const int h = pointable.handId < 0 ? -1 : findHand(pointable.handId);
+    pointableHand[i] = h;
+    if (h >= 0) {
+      handPointableCount[h]++;
+      if (touchZone[i] == Leap::Pointable::ZONE_TOUCHING) {
+        handTouchingCount[h]++;
+      }
+      handTouchDistance[h] = std::min(handTouchDistance[h], touchDistance[i]);
+    }
+  }
+
+  relevantCount = 0;
+}
+
+void FrameFeatures::setRelevant(const std::vector<Leap::Pointable>& relevantPointables) {
+  relevantCount = 0;
+  for (size_t k = 0; k < relevantPointables.size(); k++) {
+    const int i = findPointable(relevantPointables[k].id());
+    if (i >= 0) {
+      relevant[relevantCount++] = i;
+    }
+  }
+}
+
+int FrameFeatures::findPointable(int32_t id) const {
+  for (int i = 0; i < pointableCount; i++) {
+    if (pointableId[i] == id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int FrameFeatures::findHand(int32_t id) const {
+  for (int h = 0; h < handCount; h++) {
+    if (handId[h] == id) {
+      return h;
+    }
+  }
+  return -1;
+}
+
+int FrameFeatures::relevantInZone(Leap::Pointable::Zone zone) const {
+  int count = 0;
+  for (int k = 0; k < relevantCount; k++) {
+    if (touchZone[relevant[k]] == zone) {
+      count++;
+    }
+  }
+  return count;
+}
+
+int32_t FrameFeatures::foremostPointableIdOfHand(int hand) const {
+  int best = -1;
+  for (int i = 0; i < pointableCount; i++) {
+    if (pointableHand[i] == hand && (best < 0 || stabilizedTipPosition[i].z < stabilizedTipPosition[best].z)) {
+      best = i;
+    }
+  }
+  return best < 0 ? -1 : pointableId[best];
+}
+
+}
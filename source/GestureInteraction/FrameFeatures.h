@@ -0,0 +1,96 @@
+#if !defined(__FrameFeatures_h__)
+#define __FrameFeatures_h__
+
+#include "common.h"
+
+#include "Utility/FrameTypes.h"
+#include "Utility/FrameModel.h"
+
+#include <vector>
+
+namespace Touchless {
+
+/// <summary>
+/// The attributes of the pointables and hands of one frame, in structure-of-arrays layout
+/// </summary>
+/// <remarks>
+/// The modes, the overlays and touch emission read the same few attributes of the same pointables many times in
+/// a frame, and each read through the SDK is a call into the tracking state.  The manager builds this once per
+/// frame from its snapshot of the frame, and the consumers read the arrays instead.  Entries are in the order of
+/// the frame, and pointables and hands past the capacity of FrameModel::FrameData are absent, so a consumer
+/// given a handle which isn't found here falls back to reading the handle.
+///
+/// The screen projections are of the stabilized tips of the relevant pointables only, since those are the ones
+/// which are drawn, and are filled in by the manager when a frame is processed rather than coalesced.
+/// </remarks>
+struct FrameFeatures {
+  enum { POINTABLE_CAPACITY = FrameModel::MAX_FRAME_POINTABLES, HAND_CAPACITY = FrameModel::MAX_FRAME_HANDS };
+
+  FrameFeatures() : frameId(-1), pointableCount(0), handCount(0), relevantCount(0) {}
+
+  /// <summary>
+  /// Fills the pointable and hand attributes from a snapshot, and clears the relevant pointables
+  /// </summary>
+  void build(const FrameModel::FrameData& frame);
+
+  /// <summary>
+  /// Records which pointables are relevant, in the order given; those which aren't found are skipped
+  /// </summary>
+  void setRelevant(const std::vector<Leap::Pointable>& relevantPointables);
+
+  /// <summary>
+  /// The index of the pointable or hand with the given id, or -1 if there is none
+  /// </summary>
+  int findPointable(int32_t id) const;
+  int findHand(int32_t id) const;
+
+  /// <summary>
+  /// The number of relevant pointables in the given zone
+  /// </summary>
+  int relevantInZone(Leap::Pointable::Zone zone) const;
+
+  /// <summary>
+  /// The id of the pointable of the hand with the smallest stabilized tip z, or -1 if the hand has none
+  /// </summary>
+  int32_t foremostPointableIdOfHand(int hand) const;
+
+  int64_t               frameId;
+
+  // pointables
+  int                   pointableCount;
+  int32_t               pointableId[POINTABLE_CAPACITY];
+  int                   pointableHand[POINTABLE_CAPACITY];   // index into the hand arrays, or -1
+  int32_t               pointableHandId[POINTABLE_CAPACITY]; // -1 if the pointable is not attached to a hand
+  Leap::Vector          tipPosition[POINTABLE_CAPACITY];
+  Leap::Vector          stabilizedTipPosition[POINTABLE_CAPACITY];
+  Leap::Vector          tipVelocity[POINTABLE_CAPACITY];
+  Leap::Vector          direction[POINTABLE_CAPACITY];
+  float                 touchDistance[POINTABLE_CAPACITY];
+  Leap::Pointable::Zone touchZone[POINTABLE_CAPACITY];
+  float                 timeVisible[POINTABLE_CAPACITY];
+
+  // hands
+  int                   handCount;
+  int32_t               handId[HAND_CAPACITY];
+  Leap::Vector          stabilizedPalmPosition[HAND_CAPACITY];
+  Leap::Vector          palmVelocity[HAND_CAPACITY];
+  Leap::Vector          handDirection[HAND_CAPACITY];
+  float                 handTimeVisible[HAND_CAPACITY];
+  int                   handPointableCount[HAND_CAPACITY];
+  int                   handTouchingCount[HAND_CAPACITY];      // pointables in ZONE_TOUCHING
+  float                 handTouchDistance[HAND_CAPACITY];      // the most forward touch distance of its pointables, or 1
+
+  // the relevant pointables, as indices into the pointable arrays
+  int                   relevantCount;
+  int                   relevant[POINTABLE_CAPACITY];
+
+  // the screen projections of the normalized, clamped stabilized tips of the relevant pointables; onScreen is
+  // set where the tip was within the acceptable clamp distance of the screen, and is false for the others
+  bool                  onScreen[POINTABLE_CAPACITY];
+  Leap::Vector          screenPosition[POINTABLE_CAPACITY];
+  Leap::Vector          clampVec[POINTABLE_CAPACITY];
+};
+
+}
+
+#endif // __FrameFeatures_h__
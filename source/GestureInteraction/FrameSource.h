@@ -0,0 +1,36 @@
+#if !defined(__FrameSource_h__)
+#define __FrameSource_h__
+
+#include "common.h"
+#include "Utility/FrameTypes.h"
+
+namespace Touchless {
+using Leap::Frame;
+
+/// <summary>
+/// A producer of frames for GestureInteractionManager::processFrame
+/// </summary>
+/// <remarks>
+/// The live application is fed by the Leap controller's listener callback.  A FrameSource lets the same
+/// interaction code be driven by anything else which can produce frames, such as a synthetic generator or a
+/// recorded session, so that it can be exercised without a device.
+/// </remarks>
+class FrameSource {
+public:
+  virtual ~FrameSource() {}
+
+  /// <summary>
+  /// Produces the next frame in the sequence
+  /// </summary>
+  /// <returns>false, leaving frame untouched, once the source is exhausted</returns>
+  virtual bool nextFrame(Frame& frame) = 0;
+
+  /// <summary>
+  /// Restarts the sequence from its first frame
+  /// </summary>
+  virtual void rewind() = 0;
+};
+
+}
+
+#endif // __FrameSource_h__
@@ -2,6 +2,10 @@
 #include "GestureInteractionManager.h"
 #include "OSInteraction.h"
 #include "Overlay.h"
+#include "Utility/LatencyMonitor.h"
+#include "Configuration/Config.h"
+
+#include <limits>
 
 #if __APPLE__
 #include <sys/sysctl.h>
@@ -14,122 +18,336 @@ const int64_t GestureInteractionManager::SECONDS = 1000000;
 const int64_t GestureInteractionManager::MILLISECONDS = 1000;
 const int64_t GestureInteractionManager::MICROSECONDS = 1;
 
-GestureInteractionManager::GestureInteractionManager(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver)
+template <int dim>
+static FilterBase<dim>* newAdaptiveFilter (const std::string &kind, double stepDuration, double minCutoff, double beta) {
+  if (kind == "one_euro") {
+    OneEuroFilter<dim> *filter = new OneEuroFilter<dim>();
+    filter->SetStepDuration(stepDuration);
+    filter->SetMinCutoff(minCutoff);
+    filter->SetBeta(beta);
+    return filter;
+  } else if (kind == "spring") {
+    SpringFilter<dim> *filter = new SpringFilter<dim>();
+    filter->SetStepDuration(stepDuration);
+    filter->SetMinCutoff(minCutoff);
+    filter->SetBeta(beta);
+    return filter;
+  }
+  return nullptr;
+}
+
+// updates a filter stepped in frame timestamp units with the first value of each frame, starting over after a gap
+// longer than maxGap rather than smoothing across it
+template <int dim>
+static void stepAdaptiveFilter (FilterBase<dim> &filter, int64_t &filterTimestamp, int64_t timestamp, int64_t maxGap, const Eigen::Matrix<double,dim,1> &value) {
+  if (filterTimestamp < 0 || timestamp < filterTimestamp || timestamp - filterTimestamp > maxGap) {
+    filter.Reset();
+    filterTimestamp = -1;
+  }
+  if (timestamp != filterTimestamp) {
+    filter.Update(static_cast<frame_t>(filterTimestamp < 0 ? 0 : timestamp - filterTimestamp), value, Eigen::Matrix<double,dim,dim>::Zero(), 1.0);
+    filterTimestamp = timestamp;
+  }
+}
+
+GestureInteractionManager::GestureInteractionManager(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver, const InteractionTuning& tuning)
   :
+  m_tuning(tuning),
   m_osInteractionDriver(osInteractionDriver),
   m_overlayDriver(overlayDriver),
   m_numOverlayImages(32),
   m_timedFrameHistory(500*MILLISECONDS),
+  m_filteredPointableCount(pointableCountCategories(), tuning.pointableCountThreshold),
+  m_filteredRTS(rtsCategories(), tuning.rtsThreshold),
   m_foremostPointableId(-1),
   m_favoritePointableId(-1),
-  m_flushOverlay(true)
+  m_flushOverlay(true),
+  m_cursorPredictorTimestamp(-1),
+  m_cursorPredictionHorizon(0),
+  m_cursorPrediction(false),
+  m_cursorDeviceTimestamp(-1),
+  m_pointableSmoothing(0),
+  m_cursorFilterTimestamp(-1),
+  m_scrollFilterTimestamp(-1)
 {
   m_FPS.SetWindow(5);
 
-  // Initalize our categorical filters
+  // cursor prediction, in device millimeters with steps of one microsecond (the frame timestamp unit)
+  {
+    int horizonMilliseconds = 0;
+    double maxExtrapolation = 20.0;
+    Config::GetAttribute<bool>("cursor_prediction", m_cursorPrediction);
+    Config::GetAttribute<int>("cursor_prediction_horizon_ms", horizonMilliseconds);
+    Config::GetAttribute<double>("cursor_prediction_max_mm", maxExtrapolation);
+    m_cursorPredictionHorizon = std::max(horizonMilliseconds, 0)*MILLISECONDS;
+    m_cursorPredictor.SetStepDuration(1.0/SECONDS);
+    m_cursorPredictor.SetNoiseDensity(2.0e6);
+    m_cursorPredictor.SetMeasurementVariance(0.25);
+    m_cursorPredictor.SetMaxExtrapolation(maxExtrapolation);
+  }
 
-  // pointable count filter
+  // per-pointable smoothing
   {
-    // generate the category vector
-    std::vector<size_t> pointableCountCategoryVector;
-    for (int i = 0; i < MAX_POINTABLES; ++i){
-      pointableCountCategoryVector.push_back(i);
-    }
-    // create the pointable count filter, with a newly created rolling mean filter.
-    // m_filteredPointableCount takes care of deleting the rolling mean filter object.
-    m_filteredPointableCount = new PointableCountFilter(pointableCountCategoryVector, new PointableCountFilterRollingMean(), 0.8);
-    // this must (should) be done after the creation of the pointable count filter.
-    m_filteredPointableCount->getFilterAs<PointableCountFilterRollingMean>().SetWindow(16);
+    int smoothingMilliseconds = 0;
+    Config::GetAttribute<int>("pointable_smoothing_ms", smoothingMilliseconds);
+    m_pointableSmoothing = std::max(smoothingMilliseconds, 0)*MILLISECONDS;
   }
 
-  // RTS filter
+  // speed-adaptive smoothing of the cursor and of scrolling
   {
-    // generate the category vector
-    std::vector<RTS> rtsCategoryVector;
-    rtsCategoryVector.push_back(ROTATING);
-    rtsCategoryVector.push_back(TRANSLATING);
-    rtsCategoryVector.push_back(SCALING);
-    //rtsCategoryVector.push_back(NONE);
-    // create the RTS filter, with a newly created rolling mean filter.
-    // m_filteredRTS takes care of deleting the rolling mean filter object.
-    m_filteredRTS = new RTSFilter(rtsCategoryVector, new RTSFilterRollingMean(), 0.9);
-    // this must (should) be done after the creation of the RTS filter.
-    m_filteredRTS->getFilterAs<RTSFilterRollingMean>().SetWindow(2);
+    std::string cursorFilter, scrollFilter;
+    double cursorMinCutoff = 1.0, cursorBeta = 0.05, scrollMinCutoff = 2.0, scrollBeta = 0.002;
+    Config::GetAttribute<std::string>("cursor_filter", cursorFilter);
+    Config::GetAttribute<double>("cursor_filter_min_cutoff_hz", cursorMinCutoff);
+    Config::GetAttribute<double>("cursor_filter_beta", cursorBeta);
+    Config::GetAttribute<std::string>("scroll_filter", scrollFilter);
+    Config::GetAttribute<double>("scroll_filter_min_cutoff_hz", scrollMinCutoff);
+    Config::GetAttribute<double>("scroll_filter_beta", scrollBeta);
+    m_cursorFilter.reset(newAdaptiveFilter<3>(cursorFilter, 1.0/SECONDS, cursorMinCutoff, cursorBeta));
+    m_scrollFilter.reset(newAdaptiveFilter<2>(scrollFilter, 1.0/SECONDS, scrollMinCutoff, scrollBeta));
   }
+
+  // Initalize our categorical filters
+  m_filteredPointableCount.getFilter().SetWindow(16);
+  m_filteredRTS.getFilter().SetWindow(2);
 }
 
 GestureInteractionManager::~GestureInteractionManager() {
 #if __APPLE__
   m_overlayDriver.flushOverlay();
 #endif
-  delete m_filteredPointableCount;
-  delete m_filteredRTS;
+}
+
+std::vector<size_t> GestureInteractionManager::pointableCountCategories () {
+  std::vector<size_t> categories;
+  for (int i = 0; i < MAX_POINTABLES; ++i){
+    categories.push_back(i);
+  }
+  return categories;
+}
+
+std::vector<GestureInteractionManager::RTS> GestureInteractionManager::rtsCategories () {
+  std::vector<RTS> categories;
+  categories.push_back(ROTATING);
+  categories.push_back(TRANSLATING);
+  categories.push_back(SCALING);
+  //categories.push_back(NONE);
+  return categories;
 }
 
 void GestureInteractionManager::processFrame (const Frame& frame, const Frame& sinceFrame) {
-  m_timedFrameHistory.addFrame(frame.timestamp(), frame);
+  updateFrameState(frame);
+  m_sinceFrame = sinceFrame;
+  projectRelevantPointables();
+
+  setForemostPointable(m_relevantPointables, m_foremostPointableId);
+  LatencyMonitor::Mark(LatencyMonitor::STAGE_FILTER_UPDATE);
+
+  processFrameInternal();
+  LatencyMonitor::Mark(LatencyMonitor::STAGE_STATE_MACHINE);
+}
+
+void GestureInteractionManager::coalesceFrame (const Frame& frame) {
+  updateFrameState(frame);
+}
+
+const char* GestureInteractionManager::stateName () const {
+  return "";
+}
+
+void GestureInteractionManager::updateFrameState (const Frame& frame) {
+  FrameModel::CaptureFrame(frame, m_currentSnapshot.data);
+#if !TOUCHLESS_HEADLESS
+  {
+    // m_currentFrame is still the previous frame, the only SDK frame these need
+    Snapshot::MotionTotals& motion = m_currentSnapshot.motion;
+    const Vector translation = frame.translation(m_currentFrame);
+    motion.translation[0] += translation.x;
+    motion.translation[1] += translation.y;
+    motion.translation[2] += translation.z;
+    motion.rotationAngle += frame.rotationAngle(m_currentFrame, Vector::zAxis());
+    const float scaleFactor = frame.scaleFactor(m_currentFrame);
+    if (scaleFactor > 0.0f) {
+      motion.logScaleFactor += std::log(scaleFactor);
+    }
+    // NOTE: in the future, there will be "instantaneous" probability accessors for RTS which we should use.
+    const float rotation = frame.rotationProbability(m_currentFrame);
+    const float translationProbability = frame.translationProbability(m_currentFrame);
+    const float scale = frame.scaleProbability(m_currentFrame);
+    if (rotation + translationProbability + scale > 0.0f) {
+      motion.probabilities[0] += rotation;
+      motion.probabilities[1] += translationProbability;
+      motion.probabilities[2] += scale;
+      motion.probabilityFrames += 1.0;
+    }
+  }
+#endif
+  m_frameFeatures.build(m_currentSnapshot.data);
+  m_timedFrameHistory.addFrame(frame.timestamp(), m_currentSnapshot);
   m_interactionBox = frame.interactionBox();
   m_currentFrame = frame;
-  m_sinceFrame = sinceFrame;
 
   identifyRelevantPointables(frame.pointables(), m_relevantPointables);
-  m_collectiveZone = identifyCollectivePointableZone(m_relevantPointables);
-
-  m_filteredPointableCount->updateWithCategory(m_relevantPointables.size() < MAX_POINTABLES ? m_relevantPointables.size() : MAX_POINTABLES - 1);
-  m_filteredRTS->updateWithProbabilityVector(rtsProbabilityVector());
-  if (frame.isValid() && sinceFrame.isValid() && frame.timestamp() > sinceFrame.timestamp()) {
+  m_frameFeatures.setRelevant(m_relevantPointables);
+  m_collectiveZone = identifyCollectivePointableZone(m_frameFeatures);
+  LatencyMonitor::Mark(LatencyMonitor::STAGE_POINTABLE_SELECTION);
+
+  m_filteredPointableCount.updateWithCategory(m_relevantPointables.size() < MAX_POINTABLES ? m_relevantPointables.size() : MAX_POINTABLES - 1);
+  m_filteredRTS.updateWithProbabilityVector(rtsProbabilityVector());
+  // the frame rate is measured between consecutive frames from the device, whether or not they were processed
+  if (frame.isValid() && m_lastUpdatedFrame.isValid() && frame.timestamp() > m_lastUpdatedFrame.timestamp()) {
     m_FPS.Update(1,
-                 Eigen::Matrix<double, 1, 1>::Constant(static_cast<double>(1*SECONDS/(frame.timestamp() - sinceFrame.timestamp()))),
+                 Eigen::Matrix<double, 1, 1>::Constant(static_cast<double>(1*SECONDS/(frame.timestamp() - m_lastUpdatedFrame.timestamp()))),
                  Eigen::Matrix<double, 1, 1>::Zero(),
                  1.0f);
   }
-  m_filteredRTS->getFilterAs<RTSFilterRollingMean>().SetWindow(m_FPS.Predict(0)(0,0)/20);
-  m_filteredPointableCount->getFilterAs<PointableCountFilterRollingMean>().SetWindow(m_FPS.Predict(0)(0,0)/15);
+  m_lastUpdatedFrame = frame;
+  if (m_FPS.Ready() && fps() > 0) {
+    // keeps the history from reallocating once it holds a full duration of frames at this rate
+    m_timedFrameHistory.reserveForFrameInterval(static_cast<int64_t>(SECONDS/fps()));
+  }
+  m_filteredRTS.getFilter().SetWindow(m_FPS.Predict(0)(0,0)/m_tuning.rtsWindowDivisor);
+  m_filteredPointableCount.getFilter().SetWindow(m_FPS.Predict(0)(0,0)/m_tuning.pointableCountWindowDivisor);
+  if (m_pointableSmoothing > 0) {
+    updatePointableFilters();
+  }
+  updateFrameStateInternal();
+}
 
-  setForemostPointable(m_relevantPointables, m_foremostPointableId);
+void GestureInteractionManager::projectRelevantPointables () {
+  for (int k = 0; k < m_frameFeatures.relevantCount; ++k) {
+    const int i = m_frameFeatures.relevant[k];
+    m_frameFeatures.onScreen[i] = normalizedToScreen(m_interactionBox.normalizePoint(m_frameFeatures.stabilizedTipPosition[i]),
+                                                     m_frameFeatures.screenPosition[i],
+                                                     m_frameFeatures.clampVec[i]);
+  }
+}
 
-  processFrameInternal();
+// tips and palms share the lanes, so palms are keyed by negative ids
+static int64_t tipFilterKey (int32_t pointableId) { return pointableId; }
+static int64_t palmFilterKey (int32_t handId) { return -1 - static_cast<int64_t>(handId); }
+
+void GestureInteractionManager::updatePointableFilters () {
+  PointableFilterBank::LaneArray position[3];
+  PointableFilterBank::LaneArray weight = PointableFilterBank::LaneArray::Zero();
+  for (int d = 0; d < 3; ++d) {
+    position[d].setZero();
+  }
+
+  m_pointableFilterLanes.BeginFrame();
+  for (int k = 0; k < m_frameFeatures.relevantCount; ++k) {
+    const int i = m_frameFeatures.relevant[k];
+    bool isNew;
+    const int lane = m_pointableFilterLanes.Lane(tipFilterKey(m_frameFeatures.pointableId[i]), isNew);
+    if (lane < 0) {
+      continue;
+    }
+    if (isNew) {
+      m_pointableFilters.ResetLane(lane);
+    }
+    const Vector &tip = m_frameFeatures.stabilizedTipPosition[i];
+    position[0](lane) = tip.x;
+    position[1](lane) = tip.y;
+    position[2](lane) = tip.z;
+    weight(lane) = 1;
+  }
+  for (int h = 0; h < m_frameFeatures.handCount; ++h) {
+    bool isNew;
+    const int lane = m_pointableFilterLanes.Lane(palmFilterKey(m_frameFeatures.handId[h]), isNew);
+    if (lane < 0) {
+      continue;
+    }
+    if (isNew) {
+      m_pointableFilters.ResetLane(lane);
+    }
+    const Vector &palm = m_frameFeatures.stabilizedPalmPosition[h];
+    position[0](lane) = palm.x;
+    position[1](lane) = palm.y;
+    position[2](lane) = palm.z;
+    weight(lane) = 1;
+  }
+  m_pointableFilterLanes.EndFrame();
+
+  if (m_FPS.Ready()) {
+    m_pointableFilters.SetWindow(fps()*m_pointableSmoothing/SECONDS);
+  }
+  m_pointableFilters.Update(position, weight);
 }
 
-void GestureInteractionManager::identifyRelevantPointables (const PointableList &pointables, std::vector<Pointable> &relevantPointables) const {
-  // Remove all ZONE_NONE pointables, backwards pointables,
-  // and compare each pointable to the foremost pointable with the same hand id with a linear discriminant.
-  std::map<int32_t, int32_t> best_pointables; //map hand id to pointable id
+Vector GestureInteractionManager::smoothedTipPosition (const Pointable &pointable) const {
+  const int32_t id = pointable.id();
+  const int lane = m_pointableSmoothing > 0 ? m_pointableFilterLanes.Find(tipFilterKey(id)) : -1;
+  if (lane < 0 || !m_pointableFilters.Ready(lane)) {
+    const int f = m_frameFeatures.findPointable(id);
+    return f >= 0 ? m_frameFeatures.stabilizedTipPosition[f] : pointable.stabilizedTipPosition();
+  }
+  const PointableFilterBank::StateVector mean = m_pointableFilters.Predict(lane);
+  return Vector(mean.x(), mean.y(), mean.z());
+}
 
-  relevantPointables.clear();
-  for (int i=0; i<pointables.count(); i++) {
-    relevantPointables.push_back(pointables[i]);
+Vector GestureInteractionManager::smoothedPalmPosition (const Hand &hand) const {
+  const int32_t id = hand.id();
+  const int lane = m_pointableSmoothing > 0 ? m_pointableFilterLanes.Find(palmFilterKey(id)) : -1;
+  if (lane < 0 || !m_pointableFilters.Ready(lane)) {
+    const int h = m_frameFeatures.findHand(id);
+    return h >= 0 ? m_frameFeatures.stabilizedPalmPosition[h] : hand.stabilizedPalmPosition();
+  }
+  const PointableFilterBank::StateVector mean = m_pointableFilters.Predict(lane);
+  return Vector(mean.x(), mean.y(), mean.z());
+}
 
-    // Look for a matching hand in the map
-    auto it = best_pointables.find(pointables[i].hand().id());
-    if (it == best_pointables.end()) {
-      // This is the first pointable on this hand
-      best_pointables[pointables[i].hand().id()] = pointables[i].id();
-    } else {
-      // We've seen this hand before
-      if (m_currentFrame.pointable(it->first).tipPosition().z > pointables[i].tipPosition().z) {
-        // but this pointable is better so use it
-        best_pointables[pointables[i].hand().id()] = pointables[i].id();
-      }
+void GestureInteractionManager::identifyRelevantPointables (const PointableList &pointables, std::vector<Pointable> &relevantPointables) const {
+  selectRelevantPointables(pointables, relevantPointables, std::numeric_limits<float>::max());
+}
+
+void GestureInteractionManager::selectRelevantPointables (const PointableList &pointables, std::vector<Pointable> &relevantPointables, float maxVerticalDirection) const {
+  // Remove all ZONE_NONE pointables, backwards pointables, pointables pointing more vertically than
+  // maxVerticalDirection, and compare each pointable to the foremost pointable with the same hand id with a
+  // linear discriminant.
+  const FrameFeatures &features = m_frameFeatures;
+  int32_t handIds[FrameFeatures::POINTABLE_CAPACITY];
+  int foremost[FrameFeatures::POINTABLE_CAPACITY]; // the pointable with the smallest tip z on each hand
+  int handSlot[FrameFeatures::POINTABLE_CAPACITY]; // index of each pointable's hand in the tables above
+  int numHands = 0;
+
+  const int count = std::min(pointables.count(), features.pointableCount);
+  for (int i = 0; i < count; i++) {
+    int slot = 0;
+    while (slot < numHands && handIds[slot] != features.pointableHandId[i]) {
+      slot++;
+    }
+    if (slot == numHands) {
+      handIds[numHands] = features.pointableHandId[i];
+      foremost[numHands] = i;
+      numHands++;
+    } else if (features.tipPosition[foremost[slot]].z > features.tipPosition[i].z) {
+      foremost[slot] = i;
     }
+    handSlot[i] = slot;
   }
 
-  auto new_end = std::remove_if(relevantPointables.begin(),
-                                relevantPointables.end(),
-                                [this, best_pointables] (const Pointable& pointable) -> bool {
-                                  Pointable best = m_currentFrame.pointable(best_pointables.find(pointable.hand().id())->second);
-                                  return pointable.touchZone() == Pointable::ZONE_NONE
-                                  || pointable.direction().z > 0
-                                  || 160 * (1 - pointable.direction().dot(best.direction())) + sqrt((pointable.tipPosition().z - best.tipPosition().z) * (pointable.tipPosition().z - best.tipPosition().z) + (pointable.tipPosition().y - best.tipPosition().y) * (pointable.tipPosition().y - best.tipPosition().y)) > 50;
-                                });
-  relevantPointables.erase(new_end, relevantPointables.end());
+  // only the survivors are fetched from the frame, in their original order
+  relevantPointables.clear();
+  for (int i = 0; i < count; i++) {
+    const Vector &direction = features.direction[i];
+    if (features.touchZone[i] == Pointable::ZONE_NONE || direction.z > 0 || std::abs(direction.y) > maxVerticalDirection) {
+      continue;
+    }
+    const int best = foremost[handSlot[i]];
+    const float dz = features.tipPosition[i].z - features.tipPosition[best].z;
+    const float dy = features.tipPosition[i].y - features.tipPosition[best].y;
+    if (160 * (1 - direction.dot(features.direction[best])) + std::sqrt(dz * dz + dy * dy) > 50) {
+      continue;
+    }
+    relevantPointables.push_back(pointables[i]);
+  }
 }
 
-Pointable::Zone GestureInteractionManager::identifyCollectivePointableZone (const std::vector<Pointable> &pointables) const {
+Pointable::Zone GestureInteractionManager::identifyCollectivePointableZone (const FrameFeatures &features) const {
   // NOTE: this is the implementation from finger mouse, which will be used until something different is needed.
 
   // if there are no pointables, return ZONE_NONE.
-  if (pointables.empty()) {
+  if (features.relevantCount == 0) {
     return Pointable::ZONE_NONE;
   }
 
@@ -145,13 +363,8 @@ Pointable::Zone GestureInteractionManager::identifyCollectivePointableZone (cons
   // for the collective zone to be ZONE_TOUCHING.  Similar for hovering.  this is a conservative
   // method which may need to be refined.
 
-  size_t number_touching = 0;
-  for (size_t i = 0; i < pointables.size(); ++i) {
-    if (pointables[i].touchZone() == Pointable::ZONE_TOUCHING){
-      ++number_touching;
-    }
-  }
-  if ((m_filteredPointableCount->filteredCategoryIsUnambiguous() && number_touching == m_filteredPointableCount->filteredCategory())
+  const size_t number_touching = features.relevantInZone(Pointable::ZONE_TOUCHING);
+  if ((m_filteredPointableCount.filteredCategoryIsUnambiguous() && number_touching == m_filteredPointableCount.filteredCategory())
       || number_touching >= 3) {
     return Pointable::ZONE_TOUCHING;
   }
@@ -160,34 +373,35 @@ Pointable::Zone GestureInteractionManager::identifyCollectivePointableZone (cons
 
 void GestureInteractionManager::DrawOverlays() {
   // NOTE: this is the implementation from finger mouse, which will be used until something different is needed.
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OVERLAY_RASTER);
 
-  Vector screenPosition, clampVec;
+  const FrameFeatures &features = m_frameFeatures;
   for (int i = 0; i < m_numOverlayImages; ++i) {
-    if (i < static_cast<int>(m_relevantPointables.size()) &&
-        m_overlayDriver.normalizedToScreen(m_interactionBox.normalizePoint(m_relevantPointables[i].stabilizedTipPosition()),
-                                              screenPosition,
-                                              clampVec)) {
-      float clampDist = clampVec.magnitude();
+    const int f = i < features.relevantCount ? features.relevant[i] : -1;
+    if (f >= 0 && features.onScreen[f]) {
+      const Vector &screenPosition = features.screenPosition[f];
+      float clampDist = features.clampVec[f].magnitude();
       if (m_overlayDriver.useProceduralOverlay()) {
-        float touchDistance = m_relevantPointables[i].touchDistance();
+        float touchDistance = features.touchDistance[f];
         double radius = m_overlayDriver.touchDistanceToRadius(touchDistance);
-        m_overlayDriver.drawRasterIcon(i,
-                                          screenPosition.x,
-                                          screenPosition.y,
-                                          true,
-                                          m_relevantPointables[i].tipVelocity().toVector3<Vector3>(),
-                                          touchDistance,
-                                          radius,
-                                          clampDist,
-                                          alphaFromTimeVisible(m_relevantPointables[i].timeVisible()));
+        m_overlayDriver.queueRasterIcon(i,
+                                        screenPosition.x,
+                                        screenPosition.y,
+                                        true,
+                                        features.tipVelocity[f].toVector3<Vector3>(),
+                                        touchDistance,
+                                        radius,
+                                        clampDist,
+                                        alphaFromTimeVisible(features.timeVisible[f]));
       } else {
-        int imageIndex = m_overlayDriver.findImageIndex(m_relevantPointables[i].touchDistance(), 0, 1);
+        int imageIndex = m_overlayDriver.findImageIndex(features.touchDistance[f], 0, 1);
         m_overlayDriver.drawImageIcon(i, imageIndex, screenPosition.x, screenPosition.y, true);
       }
     } else {
       m_overlayDriver.setIconVisibility(i, false);
     }
   }
+  m_overlayDriver.drawQueuedIcons();
 #if __APPLE__
   m_overlayDriver.flushOverlay();
 #endif
@@ -198,6 +412,10 @@ int32_t GestureInteractionManager::foremostPointableId () const {
 }
 
 int32_t GestureInteractionManager::foremostPointableIdOfHand(const Hand &hand) const {
+  const int h = hand.isValid() ? m_frameFeatures.findHand(hand.id()) : -1;
+  if (h >= 0) {
+    return m_frameFeatures.foremostPointableIdOfHand(h);
+  }
   int32_t id;
   std::vector<Pointable> pointableVector;
   PointableList pointables = hand.pointables();
@@ -208,6 +426,14 @@ int32_t GestureInteractionManager::foremostPointableIdOfHand(const Hand &hand) c
   return id;
 }
 
+Hand GestureInteractionManager::handOfPointable(int32_t pointableId) const {
+  const int f = m_frameFeatures.findPointable(pointableId);
+  if (f < 0) {
+    return m_currentFrame.pointable(pointableId).hand();
+  }
+  return m_frameFeatures.pointableHandId[f] >= 0 ? m_currentFrame.hand(m_frameFeatures.pointableHandId[f]) : Hand();
+}
+
 void GestureInteractionManager::resetFavoritePointableId() {
   m_favoritePointableId = foremostPointableId();
 }
@@ -225,11 +451,53 @@ double GestureInteractionManager::fps() const {
 }
 
 bool GestureInteractionManager::rtsIsUnambiguous() const {
-  return m_filteredRTS->filteredCategoryIsUnambiguous();
+  return m_filteredRTS.filteredCategoryIsUnambiguous();
 }
 
 GestureInteractionManager::RTS GestureInteractionManager::rts() const {
-  return m_filteredRTS->filteredCategory();
+  return m_filteredRTS.filteredCategory();
+}
+
+Vector GestureInteractionManager::translationBetween(const Snapshot& current, const Snapshot& since) {
+#if TOUCHLESS_HEADLESS
+  return FrameModel::MotionBetween(current.data, since.data).translation.toVector3<Vector>();
+#else
+  return Vector(static_cast<float>(current.motion.translation[0] - since.motion.translation[0]),
+                static_cast<float>(current.motion.translation[1] - since.motion.translation[1]),
+                static_cast<float>(current.motion.translation[2] - since.motion.translation[2]));
+#endif
+}
+
+float GestureInteractionManager::rotationAngleBetween(const Snapshot& current, const Snapshot& since) {
+#if TOUCHLESS_HEADLESS
+  return FrameModel::MotionBetween(current.data, since.data).rotationAngle;
+#else
+  return static_cast<float>(current.motion.rotationAngle - since.motion.rotationAngle);
+#endif
+}
+
+float GestureInteractionManager::scaleFactorBetween(const Snapshot& current, const Snapshot& since) {
+#if TOUCHLESS_HEADLESS
+  return FrameModel::MotionBetween(current.data, since.data).scaleFactor;
+#else
+  return static_cast<float>(std::exp(current.motion.logScaleFactor - since.motion.logScaleFactor));
+#endif
+}
+
+void GestureInteractionManager::probabilitiesBetween(const Snapshot& current, const Snapshot& since, float& rotation, float& translation, float& scale) {
+#if TOUCHLESS_HEADLESS
+  FrameModel::MotionBetween(current.data, since.data).probabilities(rotation, translation, scale);
+#else
+  // the mean of the per-frame probabilities, which still sum to one
+  const double frames = current.motion.probabilityFrames - since.motion.probabilityFrames;
+  if (frames <= 0.0) {
+    rotation = translation = scale = 0.0f;
+    return;
+  }
+  rotation = static_cast<float>((current.motion.probabilities[0] - since.motion.probabilities[0])/frames);
+  translation = static_cast<float>((current.motion.probabilities[1] - since.motion.probabilities[1])/frames);
+  scale = static_cast<float>((current.motion.probabilities[2] - since.motion.probabilities[2])/frames);
+#endif
 }
 
 GestureInteractionManager::RTSFilter::ProbabilityVector GestureInteractionManager::rtsProbabilityVector () const {
@@ -238,12 +506,9 @@ GestureInteractionManager::RTSFilter::ProbabilityVector GestureInteractionManage
   auto it = m_timedFrameHistory.getFrameHavingAgeAtLeast(20*MILLISECONDS);
 
   if (it != m_timedFrameHistory.end()) {
-    const Frame &sinceFrame = it->second;
-
-    // NOTE: in the future, there will be "instantaneous" probability accessors for RTS which we should use.
-    v = RTSFilter::ProbabilityVector(m_currentFrame.rotationProbability(sinceFrame),
-                                     m_currentFrame.translationProbability(sinceFrame),
-                                     m_currentFrame.scaleProbability(sinceFrame));
+    float rotation, translation, scale;
+    probabilitiesBetween(m_currentSnapshot, it->second, rotation, translation, scale);
+    v = RTSFilter::ProbabilityVector(rotation, translation, scale);
     for (unsigned int i = 0; i < RTS__CATEGORY_COUNT; ++i) {
       probability += v[i];
     }
@@ -257,11 +522,11 @@ GestureInteractionManager::RTSFilter::ProbabilityVector GestureInteractionManage
 }
 
 bool GestureInteractionManager::pointableCountIsUnambiguous() const{
-  return m_filteredPointableCount->filteredCategoryIsUnambiguous();
+  return m_filteredPointableCount.filteredCategoryIsUnambiguous();
 }
 
 int GestureInteractionManager::pointableCount() const {
-  return static_cast<int>(m_filteredPointableCount->filteredCategory());
+  return static_cast<int>(m_filteredPointableCount.filteredCategory());
 }
 
 Pointable::Zone GestureInteractionManager::collectiveZone() const {
@@ -281,43 +546,54 @@ bool GestureInteractionManager::normalizedToAspect(const Vector& position, Vecto
 }
 
 void GestureInteractionManager::setCursorPosition(float fx, float fy, bool absolute) {
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OS_EMIT);
   m_osInteractionDriver.setCursorPosition(fx, fy, absolute);
 }
 
 void GestureInteractionManager::clickDown(int button, int number) {
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OS_EMIT);
   m_osInteractionDriver.clickDown(button, number);
 }
 
 void GestureInteractionManager::clickUp(int button, int number) {
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OS_EMIT);
   m_osInteractionDriver.clickUp(button, number);
 }
 
 bool GestureInteractionManager::beginGesture(uint32_t gestureType) {
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OS_EMIT);
   return m_osInteractionDriver.beginGesture(gestureType);
 }
 
 bool GestureInteractionManager::endGesture() {
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OS_EMIT);
   return m_osInteractionDriver.endGesture();
 }
 
 bool GestureInteractionManager::applyZoom(float zoom) {
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OS_EMIT);
   return m_osInteractionDriver.applyZoom(zoom);
 }
 
 bool GestureInteractionManager::applyRotation(float rotation) {
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OS_EMIT);
   return m_osInteractionDriver.applyRotation(rotation);
 }
 
 bool GestureInteractionManager::applyScroll(float dx, float dy, int64_t timeDiff) {
+  filterScroll(dx, dy, timeDiff);
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OS_EMIT);
   return m_osInteractionDriver.applyScroll(dx, dy, timeDiff);
 }
 
 bool GestureInteractionManager::applyDesktopSwipe(float dx, float dy) {
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OS_EMIT);
   return m_osInteractionDriver.applyDesktopSwipe(dx, dy);
 }
 
 void GestureInteractionManager::applyCharms(const Vector& aspectNormalized, int numPointablesActive, int& charmsMode) {
 #if _WIN32
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OS_EMIT);
   m_osInteractionDriver.applyCharms(aspectNormalized, numPointablesActive, charmsMode);
 #endif
 }
@@ -335,6 +611,7 @@ int GestureInteractionManager::findImageIndex(float z, float touchThreshold, flo
 }
 
 void GestureInteractionManager::drawImageIcon(int iconIndex, int imageIndex, float x, float y, bool visible) {
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OVERLAY_RASTER);
   m_overlayDriver.drawImageIcon(iconIndex, imageIndex, x, y, visible);
 }
 
@@ -349,14 +626,15 @@ void GestureInteractionManager::drawOverlayForPointable (const Pointable &pointa
     m_positionalDeltaTracker.setPositionToStabilizedPositionOf(pointable);
     position = m_positionalDeltaTracker.getTrackedPosition();
   } else {
-    position = pointable.stabilizedTipPosition();
+    position = smoothedTipPosition(pointable);
   }
 
   normalizedToScreen(interactionBox().normalizePoint(position, false), screenPosition, clampVec);
+  const int f = m_frameFeatures.findPointable(pointable.id());
+  const float touchDistance = f >= 0 ? m_frameFeatures.touchDistance[f] : pointable.touchDistance();
   if (useProceduralOverlay()) {
-    float touchDistance = pointable.touchDistance();
     double radius = touchDistanceToRadius(touchDistance);
-    Vector3 vel = pointable.tipVelocity().toVector3<Vector3>();
+    Vector3 vel = (f >= 0 ? m_frameFeatures.tipVelocity[f] : pointable.tipVelocity()).toVector3<Vector3>();
     float clampDist = clampVec.magnitude();
     if (clampDist > 0) {
       if (fabs(clampVec.x) > 0) {
@@ -378,26 +656,67 @@ void GestureInteractionManager::drawOverlayForPointable (const Pointable &pointa
                    touchDistance,
                    radius,
                    clampDist,
-                   alphaMult*alphaFromTimeVisible(pointable.timeVisible()));
+                   alphaMult*alphaFromTimeVisible(f >= 0 ? m_frameFeatures.timeVisible[f] : pointable.timeVisible()));
   } else {
-    int imageIndex = findImageIndex(pointable.touchDistance(), 0, 1);
+    int imageIndex = findImageIndex(touchDistance, 0, 1);
     drawImageIcon(pointable.id(), imageIndex, screenPosition.x, screenPosition.y, true);
   }
 }
 
+void GestureInteractionManager::drawOverlayForTarget (const TargetTracker::Target &target, int32_t iconIndex, float alphaMult) {
+  Vector screenPosition, clampVec;
+  normalizedToScreen(interactionBox().normalizePoint(target.getTrackedPosition(), false), screenPosition, clampVec);
+  const float touchDistance = target.touchDistance;
+  if (useProceduralOverlay()) {
+    double radius = touchDistanceToRadius(touchDistance);
+    Vector3 vel = target.velocity.toVector3<Vector3>();
+    float clampDist = clampVec.magnitude();
+    if (clampDist > 0) {
+      if (fabs(clampVec.x) > 0) {
+        vel.x() *= 0;
+        vel.y() += 10000 * clampDist;
+      } else if (fabs(clampVec.y) > 0) {
+        vel.x() += 10000 * clampDist;
+        vel.y() *= 0;
+      }
+    }
+    if (touchDistance < 0.0) {
+      radius = 10.0;
+    }
+    drawRasterIcon(iconIndex,
+                   screenPosition.x,
+                   screenPosition.y,
+                   true,
+                   vel,
+                   touchDistance,
+                   radius,
+                   clampDist,
+                   alphaMult*alphaFromTimeVisible((1.0f/SECONDS)*static_cast<float>(m_currentFrame.timestamp() - target.firstSeen)));
+  } else {
+    int imageIndex = findImageIndex(touchDistance, 0, 1);
+    drawImageIcon(iconIndex, imageIndex, screenPosition.x, screenPosition.y, true);
+  }
+}
+
 void GestureInteractionManager::drawOverlayForHand (const Hand &hand, int32_t iconIndex, float alphaMult) {
   if (!hand.isValid()) {
     return; // can't do anything in this case
   }
 
   Vector screenPosition, clampVec;
+  m_positionalDeltaTracker.setPositionOf(hand, smoothedPalmPosition(hand));
   normalizedToScreen(interactionBox().normalizePoint(m_positionalDeltaTracker.getTrackedPosition(), false), screenPosition, clampVec);
-  Vector3 vel = hand.palmVelocity().toVector3<Vector3>();
+  const int h = m_frameFeatures.findHand(hand.id());
+  Vector3 vel = (h >= 0 ? m_frameFeatures.palmVelocity[h] : hand.palmVelocity()).toVector3<Vector3>();
   //Use the most forward touch distance
   float touchDistance = 1.0;
-  Leap::PointableList pointables = hand.pointables();
-  for (int i=0; i<pointables.count(); i++) {
-    touchDistance = std::min(touchDistance, pointables[i].touchDistance());
+  if (h >= 0) {
+    touchDistance = m_frameFeatures.handTouchDistance[h];
+  } else {
+    Leap::PointableList pointables = hand.pointables();
+    for (int i=0; i<pointables.count(); i++) {
+      touchDistance = std::min(touchDistance, pointables[i].touchDistance());
+    }
   }
   double radius = touchDistanceToRadius(touchDistance);
 
@@ -422,15 +741,16 @@ void GestureInteractionManager::drawOverlayForHand (const Hand &hand, int32_t ic
                  touchDistance,
                  radius,
                  clampDist,
-                 alphaMult*alphaFromTimeVisible(hand.timeVisible()));
+                 alphaMult*alphaFromTimeVisible(h >= 0 ? m_frameFeatures.handTimeVisible[h] : hand.timeVisible()));
 }
 
 
 void GestureInteractionManager::drawGestureOverlayForHand (const Hand& hand, float rotationAngle, float scaleFactor, float alphaMult, const Vector *positionOverride, bool doubleHorizontalDots, bool doubleVerticalDots, bool verticalMovementGlow, bool horizontalMovementGlow) {
   assert(scaleFactor >= 0.0f);
 
+  const int h = hand.isValid() ? m_frameFeatures.findHand(hand.id()) : -1;
   Vector screenPosition, clampVec, tipVelocity;
-  tipVelocity = hand.palmVelocity();
+  tipVelocity = h >= 0 ? m_frameFeatures.palmVelocity[h] : hand.palmVelocity();
 
   Vector position;
   // if positionOverride is specified, use that
@@ -444,18 +764,22 @@ void GestureInteractionManager::drawGestureOverlayForHand (const Hand& hand, flo
 
   //Use the most forward touch distance
   float touchDistance = 1.0;
-  Leap::PointableList pointables = hand.pointables();
-  if (!hand.isValid() || pointables.count() == 0) {
-    touchDistance = 0.2f;
+  if (h >= 0) {
+    touchDistance = m_frameFeatures.handPointableCount[h] == 0 ? 0.2f : m_frameFeatures.handTouchDistance[h];
   } else {
-    for (int i=0; i<pointables.count(); i++) {
-      touchDistance = std::min(touchDistance, pointables[i].touchDistance());
+    Leap::PointableList pointables = hand.pointables();
+    if (!hand.isValid() || pointables.count() == 0) {
+      touchDistance = 0.2f;
+    } else {
+      for (int i=0; i<pointables.count(); i++) {
+        touchDistance = std::min(touchDistance, pointables[i].touchDistance());
+      }
     }
   }
 
 
   double radius = touchDistanceToRadius(touchDistance);
-  float alpha = alphaMult * alphaFromTimeVisible(hand.timeVisible());
+  float alpha = alphaMult * alphaFromTimeVisible(h >= 0 ? m_frameFeatures.handTimeVisible[h] : hand.timeVisible());
 
   drawGestureOverlayCore(screenPosition, clampVec, tipVelocity, radius, touchDistance, alpha, rotationAngle, scaleFactor, alphaMult, doubleHorizontalDots, doubleVerticalDots, verticalMovementGlow, horizontalMovementGlow);
 }
@@ -463,8 +787,9 @@ void GestureInteractionManager::drawGestureOverlayForHand (const Hand& hand, flo
 void GestureInteractionManager::drawGestureOverlayForPointable (const Pointable& pointable, float rotationAngle, float scaleFactor, float alphaMult, const Vector *positionOverride, bool doubleHorizontalDots, bool doubleVerticalDots, bool verticalMovementGlow, bool horizontalMovementGlow) {
   assert(scaleFactor >= 0.0f);
 
+  const int f = pointable.isValid() ? m_frameFeatures.findPointable(pointable.id()) : -1;
   Vector screenPosition, clampVec, tipVelocity;
-  tipVelocity = pointable.tipVelocity();
+  tipVelocity = f >= 0 ? m_frameFeatures.tipVelocity[f] : pointable.tipVelocity();
 
   Vector position;
   // if positionOverride is specified, use that
@@ -477,9 +802,9 @@ void GestureInteractionManager::drawGestureOverlayForPointable (const Pointable&
   normalizedToScreen(interactionBox().normalizePoint(position), screenPosition, clampVec);
 
   //Use the most forward touch distance
-  float touchDistance = pointable.touchDistance();
+  float touchDistance = f >= 0 ? m_frameFeatures.touchDistance[f] : pointable.touchDistance();
   double radius = touchDistanceToRadius(touchDistance);
-  float alpha = alphaMult * alphaFromTimeVisible(pointable.timeVisible());
+  float alpha = alphaMult * alphaFromTimeVisible(f >= 0 ? m_frameFeatures.timeVisible[f] : pointable.timeVisible());
 
   drawGestureOverlayCore(screenPosition, clampVec, tipVelocity, radius, touchDistance, alpha, rotationAngle, scaleFactor, alphaMult, doubleHorizontalDots, doubleVerticalDots, verticalMovementGlow, horizontalMovementGlow);
 }
@@ -649,9 +974,9 @@ void GestureInteractionManager::drawRotateOverlayForHand (const Hand& hand, floa
   float rotationRate = 0.0f;
   auto it = m_timedFrameHistory.getFrameHavingAgeAtLeast(500*MILLISECONDS);
   if (it != m_timedFrameHistory.end()) {
-    const Frame &frame = it->second;
-    float timeDelta = float(m_currentFrame.timestamp() - frame.timestamp()) / SECONDS;
-    rotationRate = m_currentFrame.rotationAngle(frame, Vector::zAxis()) / timeDelta;
+    const Snapshot &frame = it->second;
+    float timeDelta = float(m_currentSnapshot.data.timestamp - frame.data.timestamp) / SECONDS;
+    rotationRate = rotationAngleBetween(m_currentSnapshot, frame) / timeDelta;
   }
   // unit scale
   drawGestureOverlayForHand(hand, rotationRate, 1.0f, alphaMult, positionOverride, false, false, false, false);
@@ -661,9 +986,9 @@ void GestureInteractionManager::drawRotateOverlayForPointable (const Pointable&
   float rotationRate = 0.0f;
   auto it = m_timedFrameHistory.getFrameHavingAgeAtLeast(500*MILLISECONDS);
   if (it != m_timedFrameHistory.end()) {
-    const Frame &frame = it->second;
-    float timeDelta = float(m_currentFrame.timestamp() - frame.timestamp()) / SECONDS;
-    rotationRate = m_currentFrame.rotationAngle(frame, Vector::zAxis()) / timeDelta;
+    const Snapshot &frame = it->second;
+    float timeDelta = float(m_currentSnapshot.data.timestamp - frame.data.timestamp) / SECONDS;
+    rotationRate = rotationAngleBetween(m_currentSnapshot, frame) / timeDelta;
   }
   // unit scale
   drawGestureOverlayForPointable(pointable, rotationRate, 1.0f, alphaMult, positionOverride, false, false, false, false);
@@ -673,8 +998,7 @@ void GestureInteractionManager::drawZoomOverlayForHand (const Hand& hand, float
   float scaleFactor = 1.0f;
   auto it = m_timedFrameHistory.getFrameHavingAgeAtLeast(500*MILLISECONDS);
   if (it != m_timedFrameHistory.end()) {
-    const Frame &frame = it->second;
-    scaleFactor = m_currentFrame.scaleFactor(frame);
+    scaleFactor = scaleFactorBetween(m_currentSnapshot, it->second);
   }
   // no rotation
   drawGestureOverlayForHand(hand, 0.0f, scaleFactor, alphaMult, positionOverride, false, false, false, false);
@@ -684,8 +1008,7 @@ void GestureInteractionManager::drawZoomOverlayForPointable (const Pointable& po
   float scaleFactor = 1.0f;
   auto it = m_timedFrameHistory.getFrameHavingAgeAtLeast(500*MILLISECONDS);
   if (it != m_timedFrameHistory.end()) {
-    const Frame &frame = it->second;
-    scaleFactor = m_currentFrame.scaleFactor(frame);
+    scaleFactor = scaleFactorBetween(m_currentSnapshot, it->second);
   }
   // no rotation
   drawGestureOverlayForPointable(pointable, 0.0f, scaleFactor, alphaMult, positionOverride, false, false, false, false);
@@ -715,18 +1038,35 @@ void GestureInteractionManager::addTouchPointForPointable (int touchId, const Po
     m_positionalDeltaTracker.setPositionToStabilizedPositionOf(pointable);
     position = m_positionalDeltaTracker.getTrackedPosition();
   } else {
-    position = pointable.stabilizedTipPosition();
+    position = smoothedTipPosition(pointable);
   }
   normalizedToScreen(interactionBox().normalizePoint(position), screenPosition, clampVec);
   // untouch at the borders
   if (clampVec.magnitudeSquared() == 0.0f) {
-    addTouchPoint(touchId, (uint32_t)pointable.frame().id(), screenPosition.x, screenPosition.y, touching);
+    // a pointable in the features is one of the current frame's
+    const int64_t frameId = m_frameFeatures.findPointable(pointable.id()) >= 0 ? m_frameFeatures.frameId : pointable.frame().id();
+    addTouchPoint(touchId, (uint32_t)frameId, screenPosition.x, screenPosition.y, touching);
+  }
+}
+
+void GestureInteractionManager::addTouchPointForTarget (const TargetTracker::Target &target, bool touching) {
+  // a coasting target has no fresh position, so its touch is lifted rather than held where it was last seen
+  if (!target.visible) {
+    return;
+  }
+  Vector screenPosition, clampVec;
+  normalizedToScreen(interactionBox().normalizePoint(target.getTrackedPosition()), screenPosition, clampVec);
+  // untouch at the borders
+  if (clampVec.magnitudeSquared() == 0.0f) {
+    addTouchPoint(TARGET_FIRST_TOUCH_ID + target.slot, (uint32_t)m_currentFrame.id(), screenPosition.x, screenPosition.y, touching);
   }
 }
 
 void GestureInteractionManager::setAbsoluteCursorPosition (const Vector &deviceCoordinatePosition, Vector *calculatedScreenPosition) {
   Vector screenPosition, clampVec;
-  if (normalizedToScreen(interactionBox().normalizePoint(deviceCoordinatePosition),
+  m_cursorDevicePosition = predictCursorPosition(filterCursorPosition(deviceCoordinatePosition));
+  m_cursorDeviceTimestamp = m_currentFrame.timestamp();
+  if (normalizedToScreen(interactionBox().normalizePoint(m_cursorDevicePosition),
                          screenPosition,
                          clampVec)) {
     setCursorPosition(screenPosition.x, screenPosition.y, true); // true indicates use of absolute positioning.
@@ -736,9 +1076,57 @@ void GestureInteractionManager::setAbsoluteCursorPosition (const Vector &deviceC
   }
 }
 
+Vector GestureInteractionManager::predictCursorPosition (const Vector &deviceCoordinatePosition) {
+  // a cursor left alone for this long starts over, rather than extrapolating a stale velocity
+  static const int64_t MAX_PREDICTION_GAP = 100*MILLISECONDS;
+
+  if (!m_cursorPrediction) {
+    return deviceCoordinatePosition;
+  }
+  const int64_t timestamp = m_currentFrame.timestamp();
+  if (m_cursorPredictorTimestamp < 0 || timestamp < m_cursorPredictorTimestamp || timestamp - m_cursorPredictorTimestamp > MAX_PREDICTION_GAP) {
+    m_cursorPredictor.Reset();
+    m_cursorPredictorTimestamp = -1;
+  }
+  // only the first position set in a frame is taken as a measurement
+  if (timestamp != m_cursorPredictorTimestamp) {
+    m_cursorPredictor.Update(static_cast<frame_t>(m_cursorPredictorTimestamp < 0 ? 0 : timestamp - m_cursorPredictorTimestamp),
+                             deviceCoordinatePosition.toVector3<Eigen::Vector3d>(),
+                             Eigen::Matrix3d::Zero(),
+                             1.0);
+    m_cursorPredictorTimestamp = timestamp;
+  }
+  // the stabilized position is already old when the frame arrives (covered by the configured horizon), and it
+  // has aged by however long the frame has spent in the pipeline since
+  const int64_t horizon = m_cursorPredictionHorizon + LatencyMonitor::CurrentFrameAge()/1000;
+  const Eigen::Vector3d& predicted = m_cursorPredictor.Predict(static_cast<frame_t>(horizon));
+  return Vector(static_cast<float>(predicted.x()), static_cast<float>(predicted.y()), static_cast<float>(predicted.z()));
+}
+
+Vector GestureInteractionManager::filterCursorPosition (const Vector &deviceCoordinatePosition) {
+  if (!m_cursorFilter) {
+    return deviceCoordinatePosition;
+  }
+  stepAdaptiveFilter(*m_cursorFilter, m_cursorFilterTimestamp, m_currentFrame.timestamp(), 100*MILLISECONDS, deviceCoordinatePosition.toVector3<Eigen::Vector3d>());
+  const Eigen::Vector3d& filtered = m_cursorFilter->Predict(0);
+  return Vector(static_cast<float>(filtered.x()), static_cast<float>(filtered.y()), static_cast<float>(filtered.z()));
+}
+
+void GestureInteractionManager::filterScroll (float &dx, float &dy, int64_t timeDiff) {
+  if (!m_scrollFilter || timeDiff <= 0) {
+    return;
+  }
+  // the velocity is filtered rather than the deltas, which span however long the frames did
+  const double seconds = static_cast<double>(timeDiff)/SECONDS;
+  stepAdaptiveFilter(*m_scrollFilter, m_scrollFilterTimestamp, m_currentFrame.timestamp(), 100*MILLISECONDS, Eigen::Vector2d(dx/seconds, dy/seconds));
+  const Eigen::Vector2d& velocity = m_scrollFilter->Predict(0);
+  dx = static_cast<float>(velocity.x()*seconds);
+  dy = static_cast<float>(velocity.y()*seconds);
+}
+
 void GestureInteractionManager::setAbsoluteCursorPositionHand (const Hand &hand, Vector *calculatedScreenPosition) {
   if (hand.isValid()) {
-    m_positionalDeltaTracker.setPositionToStabilizedPositionOf(hand);
+    m_positionalDeltaTracker.setPositionOf(hand, smoothedPalmPosition(hand));
     setAbsoluteCursorPosition(m_positionalDeltaTracker.getTrackedPosition(), calculatedScreenPosition);
   }
 }
@@ -776,10 +1164,21 @@ double GestureInteractionManager::touchDistanceToRadius (float touchDistance) {
 }
 
 void GestureInteractionManager::drawRasterIcon(int iconIndex, float x, float y, bool visible, const Vector3& velocity, float touchDistance, double radius, float clampDistance, float alphaMult, int numFingers) {
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OVERLAY_RASTER);
   m_overlayDriver.drawRasterIcon(iconIndex, x, y, visible, velocity, touchDistance, radius, clampDistance, alphaMult, numFingers);
 }
 
+void GestureInteractionManager::queueRasterIcon(int iconIndex, float x, float y, bool visible, const Vector3& velocity, float touchDistance, double radius, float clampDistance, float alphaMult, int numFingers) {
+  m_overlayDriver.queueRasterIcon(iconIndex, x, y, visible, velocity, touchDistance, radius, clampDistance, alphaMult, numFingers);
+}
+
+void GestureInteractionManager::drawQueuedIcons() {
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OVERLAY_RASTER);
+  m_overlayDriver.drawQueuedIcons();
+}
+
 void GestureInteractionManager::emitTouchEvent() {
+  LatencyMonitor::ScopedStage latency(LatencyMonitor::STAGE_OS_EMIT);
   m_osInteractionDriver.emitTouchEvent(m_touchEvent);
   m_touchEvent.clear();
 }
@@ -817,8 +1216,8 @@ void GestureInteractionManager::flushOverlay() {
 #endif
 
 void GestureInteractionManager::setForemostPointable (const std::vector<Pointable> &relevantPointables, int32_t &foremostPointableId) const {
-  if ((m_filteredPointableCount->filteredCategoryIsUnambiguous() && m_filteredPointableCount->filteredCategory() == m_relevantPointables.size())
-      || !m_filteredPointableCount->filteredCategoryIsUnambiguous()) {
+  if ((m_filteredPointableCount.filteredCategoryIsUnambiguous() && m_filteredPointableCount.filteredCategory() == m_relevantPointables.size())
+      || !m_filteredPointableCount.filteredCategoryIsUnambiguous()) {
     identifyForemostPointable(relevantPointables, foremostPointableId);
   } else {
     foremostPointableId = -1;
@@ -3,18 +3,27 @@
 
 #include "common.h"
 
-#include "Leap.h"
+#include "Utility/FrameTypes.h"
+#include "Utility/FrameModel.h"
 
 #include "OSInteraction/OSInteraction.h"
 #include "Overlay/Overlay.h"
 
 #include "Utility/TimedHistory.h"
 #include "PositionalDeltaTracker.h"
+#include "MultiPositionalDeltaTracker.h"
+#include "InteractionTuning.h"
+#include "FrameFeatures.h"
 #include "Utility/CategoricalFilter.h"
-#include "Utility/RollingMean.h"
-#include "Utility/StateMachine.h"
+#include "Utility/StaticFilter.h"
+#include "Utility/KalmanPredictor.h"
+#include "Utility/FilterBank.h"
+#include "Utility/OneEuroFilter.h"
+#include "Utility/SpringFilter.h"
+#include "Utility/TableStateMachine.h"
 #include "OSInteraction/Touch.h"
 
+#include <memory>
 #include <vector>
 
 #define MAX_POINTABLES 10
@@ -34,24 +43,64 @@ enum GestureInteractionMode { OUTPUT_MODE_DISABLED = 0, OUTPUT_MODE_INTRO, OUTPU
 
 class GestureInteractionManager {
 public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW // the filters are held by value
 
-  GestureInteractionManager(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver);
+  GestureInteractionManager(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver, const InteractionTuning& tuning = InteractionTuning());
   virtual ~GestureInteractionManager();
 
-  static GestureInteractionManager* New(Touchless::GestureInteractionMode desiredMode, OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver);
+  static GestureInteractionManager* New(Touchless::GestureInteractionMode desiredMode, OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver, const InteractionTuning& tuning = InteractionTuning());
 
   void processFrame (const Frame& frame, const Frame& sinceFrame);
 
+  /// <summary>
+  /// Folds a frame which will not be processed into the frame history and the filters
+  /// </summary>
+  /// <remarks>
+  /// When processing falls behind the device, intermediate frames are coalesced rather than processed, so that
+  /// the filters and the history still see every frame.  The next processFrame should pass the last processed
+  /// frame as sinceFrame, so that frame-to-frame motion spans the coalesced frames and no scroll or swipe
+  /// distance is lost.
+  /// </remarks>
+  void coalesceFrame (const Frame& frame);
+
+  // the name of the mode's current state, or empty for modes without a state machine; for diagnostics and tuning
+  virtual const char* stateName () const;
+
+  const InteractionTuning& tuning () const { return m_tuning; }
+
+  // the device position, after smoothing and prediction, of the last absolute cursor position and the timestamp of
+  // the frame which set it (-1 before the first); for diagnostics and tuning, since it doesn't depend on the screens
+  const Vector& cursorDevicePosition () const { return m_cursorDevicePosition; }
+  int64_t cursorDeviceTimestamp () const { return m_cursorDeviceTimestamp; }
+
 protected:
 
+  // updates the history, relevant pointables and filters with a frame; shared by processFrame and coalesceFrame.
+  void updateFrameState (const Frame& frame);
+  // projects the stabilized tips of the relevant pointables onto the screen, for the overlays of a processed frame
+  void projectRelevantPointables ();
+  // smooths the relevant tips and the palms of the frame, when pointable_smoothing_ms is set
+  void updatePointableFilters ();
+
   // this must be implemented in a subclass -- it provides the mode-specific peripheral behavior.
   virtual void processFrameInternal() = 0;
 
+  // the mode-specific part of updateFrameState, for state which must see every frame, coalesced or processed
+  virtual void updateFrameStateInternal() {}
+
   // a default implementation, currently taken from the finger mouse.
   virtual void identifyRelevantPointables (const PointableList &pointables, std::vector<Pointable> &relevantPointables) const;
 
-  // a default implementation, currently taken from the finger mouse.
-  virtual Pointable::Zone identifyCollectivePointableZone (const std::vector<Pointable> &pointables) const;
+  // the selection shared by the implementations of identifyRelevantPointables, which also rejects pointables whose
+  // direction has a vertical component larger than maxVerticalDirection.  pointables are those of the current
+  // frame, and are judged by their features in m_frameFeatures, so the SDK is only asked for the handles of the
+  // survivors.  It doesn't allocate once relevantPointables has grown to the largest frame.  Pointables past the
+  // capacity of m_frameFeatures are ignored.
+  void selectRelevantPointables (const PointableList &pointables, std::vector<Pointable> &relevantPointables, float maxVerticalDirection) const;
+
+  // a default implementation, currently taken from the finger mouse.  It is given the features of the current
+  // frame, whose relevant pointables have been recorded.
+  virtual Pointable::Zone identifyCollectivePointableZone (const FrameFeatures &features) const;
 
   // a default implementation, currently taken from the finger mouse.
   virtual void DrawOverlays();
@@ -68,9 +117,13 @@ protected:
   };
 
   typedef CategoricalFilter<RTS,RTS__CATEGORY_COUNT>  RTSFilter;
+  typedef Leap::MultiPositionalDeltaTracker           TargetTracker;
 
   int32_t foremostPointableId () const;
+  // hands and pointables of the current frame
   int32_t foremostPointableIdOfHand(const Hand &hand) const;
+  // the hand of the pointable of the current frame with the given id, which is invalid if there is none
+  Hand handOfPointable(int32_t pointableId) const;
   void resetFavoritePointableId();
   int32_t favoritePointableId();
   double fps() const;
@@ -101,6 +154,9 @@ protected:
   void drawImageIcon(int iconIndex, int imageIndex, float x, float y, bool visible);
   void drawOverlayForPointable (const Pointable &pointable, int32_t iconIndex = 0, float alphaMult = 1.0f, bool deltaTracked = true);
   void drawOverlayForHand (const Hand &hand, int32_t iconIndex = 0, float alphaMult = 1.0f);
+  // a target of a MultiPositionalDeltaTracker is drawn at its tracked position, which it keeps through a dropout,
+  // and touched there while it is visible, with a touch id from the top of the range the touch drivers keep
+  void drawOverlayForTarget (const TargetTracker::Target &target, int32_t iconIndex = 0, float alphaMult = 1.0f);
   void drawGestureOverlayForHand (const Hand& hand, float rotationAngle, float scaleFactor, float alphaMult = 1.0f, const Vector *positionOverride = nullptr, bool doubleHorizontalDots = false, bool doubleVerticalDots = false, bool verticalMovementGlow = true, bool horizontalMovementGlow = true);
   void drawGestureOverlayForPointable (const Pointable& pointable, float rotationAngle, float scaleFactor, float alphaMult = 1.0f, const Vector *positionOverride = nullptr, bool doubleHorizontalDots = false, bool doubleVerticalDots = false, bool verticalMovementGlow = true, bool horizontalMovementGlow = true);
   void drawGestureOverlayCore(Vector screenPosition, Vector clampVec, Vector tipVelocity, double radius, float touchDistance, float alpha, float rotationAngle, float scaleFactor, float alphaMult, bool doubleHorizontalDots, bool doubleVerticalDots, bool verticalMovementGlow = true, bool horizontalMovementGlow = true);
@@ -112,7 +168,18 @@ protected:
   void drawZoomOverlayForPointable (const Pointable& pointable, float alphaMult = 1.0f, const Vector *positionOverride = nullptr);
   void addTouchPointForPointable (int touchId, const Pointable &pointable, bool touching, bool deltaTracked = true);
   void addTouchPointForHand (const Hand &position, bool touching);
+  void addTouchPointForTarget (const TargetTracker::Target &target, bool touching);
   void setAbsoluteCursorPosition (const Vector &deviceCoordinatePosition, Vector *calculatedScreenPosition = nullptr);
+  // extrapolates an absolute cursor position to the present, when cursor_prediction is enabled
+  Vector predictCursorPosition (const Vector &deviceCoordinatePosition);
+  // smooths an absolute cursor position with the filter selected by cursor_filter, if any
+  Vector filterCursorPosition (const Vector &deviceCoordinatePosition);
+  // smooths the scroll velocity with the filter selected by scroll_filter, if any
+  void filterScroll (float &dx, float &dy, int64_t timeDiff);
+  // the positions smoothed over pointable_smoothing_ms, or the stabilized positions when smoothing is off or the
+  // pointable (or hand) has not been seen for long enough
+  Vector smoothedTipPosition (const Pointable &pointable) const;
+  Vector smoothedPalmPosition (const Hand &hand) const;
   virtual void setAbsoluteCursorPositionHand (const Hand &hand, Vector *calculatedScreenPosition = nullptr);
   virtual void setAbsoluteCursorPositionPointable (const Pointable &pointable, Vector *calculatedScreenPosition = nullptr);
 
@@ -121,6 +188,9 @@ protected:
   static float scrollDampingFactor (const Vector &scrollVelocity);
   static double touchDistanceToRadius (float touchDistance);
   void drawRasterIcon(int iconIndex, float x, float y, bool visible, const Vector3& velocity, float touchDistance, double radius, float clampDistance, float alphaMult, int numFingers = 1);
+  // queued icons are rasterized together, across the overlay driver's worker pool, by drawQueuedIcons
+  void queueRasterIcon(int iconIndex, float x, float y, bool visible, const Vector3& velocity, float touchDistance, double radius, float clampDistance, float alphaMult, int numFingers = 1);
+  void drawQueuedIcons();
   void addTouchPoint(int touchId, int frameId, float x, float y, bool touching);
   bool touchAvailable() const;
   int numTouchScreens() const;
@@ -136,25 +206,57 @@ protected:
   static const int64_t MILLISECONDS;
   static const int64_t MICROSECONDS;
 
-  typedef TimedHistory<Frame,int64_t> TimedFrameHistory;
+  // A frame of the history, as a compact snapshot.  SDK builds add up the SDK's own estimates of the motion from
+  // each frame to the next as the frame is captured, so that the motion between two snapshots is the difference
+  // of their totals and the history holds no SDK frames; headless builds have no SDK, and estimate it from the
+  // snapshots with FrameModel::MotionBetween.
+  struct Snapshot {
+    FrameModel::FrameData data;
+#if !TOUCHLESS_HEADLESS
+    struct MotionTotals {
+      MotionTotals() : rotationAngle(0), logScaleFactor(0), probabilityFrames(0) {
+        std::fill(translation, translation + 3, 0.0);
+        std::fill(probabilities, probabilities + 3, 0.0);
+      }
+      double translation[3];
+      double rotationAngle;     // about the z axis
+      double logScaleFactor;
+      double probabilities[3];  // rotation, translation and scale, over the frames which had any
+      double probabilityFrames;
+    };
+    MotionTotals          motion;
+#endif
+  };
+  typedef TimedHistory<Snapshot,int64_t> TimedFrameHistory;
+
+  // the motion between two snapshots, as described for Snapshot; the rotation is about the z axis
+  static Vector translationBetween(const Snapshot& current, const Snapshot& since);
+  static float rotationAngleBetween(const Snapshot& current, const Snapshot& since);
+  static float scaleFactorBetween(const Snapshot& current, const Snapshot& since);
+  static void probabilitiesBetween(const Snapshot& current, const Snapshot& since, float& rotation, float& translation, float& scale);
 
   int                                         m_numOverlayImages;
   Frame                                       m_currentFrame;
+  Snapshot                                    m_currentSnapshot;
+  FrameFeatures                               m_frameFeatures;    // the attributes of m_currentSnapshot, for every consumer
   Frame                                       m_sinceFrame;
+  Frame                                       m_lastUpdatedFrame; // the last frame processed or coalesced
   TimedFrameHistory                           m_timedFrameHistory;
   std::vector<Pointable>                      m_relevantPointables;
 
   bool                                        m_flushOverlay;
 
 protected:
-  typedef RollingMean<MAX_POINTABLES>                 PointableCountFilterRollingMean;
   typedef CategoricalFilter<size_t,MAX_POINTABLES>    PointableCountFilter;
-  typedef RollingMean<RTS__CATEGORY_COUNT>            RTSFilterRollingMean;
 
+  static std::vector<size_t> pointableCountCategories();
+  static std::vector<RTS> rtsCategories();
+
+  InteractionTuning                           m_tuning;
   Pointable::Zone                             m_collectiveZone;
-  PointableCountFilter                       *m_filteredPointableCount;
-  RTSFilter                                  *m_filteredRTS;
-  RollingMean<1>                              m_FPS;
+  PointableCountFilter                        m_filteredPointableCount;
+  RTSFilter                                   m_filteredRTS;
+  StaticRollingMean<double,1>                 m_FPS;
   InteractionBox                              m_interactionBox;
   int32_t                                     m_foremostPointableId;
   int32_t                                     m_favoritePointableId;
@@ -162,6 +264,28 @@ protected:
   OverlayDriver                              &m_overlayDriver;
   Leap::PositionalDeltaTracker                m_positionalDeltaTracker;
   TouchEvent                                  m_touchEvent;
+  KalmanPredictor<3>                          m_cursorPredictor;
+  int64_t                                     m_cursorPredictorTimestamp;
+  int64_t                                     m_cursorPredictionHorizon;
+  bool                                        m_cursorPrediction;
+  Vector                                      m_cursorDevicePosition;
+  int64_t                                     m_cursorDeviceTimestamp;
+
+  // the touch drivers keep only the low byte of a touch id, so each target slot has one of the last ids below 256
+  enum { TARGET_FIRST_TOUCH_ID = 256 - TargetTracker::MAX_TARGETS };
+
+  // one lane for each relevant tip and each palm; MAX_POINTABLES tips and MAX_FRAME_HANDS palms fit with room to spare
+  enum { POINTABLE_FILTER_LANES = 16 };
+  typedef RollingMeanBank<float,POINTABLE_FILTER_LANES,3> PointableFilterBank;
+
+  PointableFilterBank                         m_pointableFilters;
+  FilterBankLanes<POINTABLE_FILTER_LANES>     m_pointableFilterLanes;
+  int64_t                                     m_pointableSmoothing;
+  // speed-adaptive smoothing (OneEuroFilter or SpringFilter), chosen by configuration; null when off
+  std::unique_ptr<FilterBase<3> >             m_cursorFilter;
+  int64_t                                     m_cursorFilterTimestamp;
+  std::unique_ptr<FilterBase<2> >             m_scrollFilter;
+  int64_t                                     m_scrollFilterTimestamp;
 
 public:
   // Accessor methods:
@@ -3,16 +3,16 @@
 #include "FingerMouse.h"
 #include "GestureOnlyMode.h"
 
-Touchless::GestureInteractionManager* Touchless::GestureInteractionManager::New(Touchless::GestureInteractionMode desiredMode, Touchless::OSInteractionDriver &osInteractionDriver, Touchless::OverlayDriver &overlayDriver)
+Touchless::GestureInteractionManager* Touchless::GestureInteractionManager::New(Touchless::GestureInteractionMode desiredMode, Touchless::OSInteractionDriver &osInteractionDriver, Touchless::OverlayDriver &overlayDriver, const Touchless::InteractionTuning &tuning)
 {
   switch(desiredMode) {
     case Touchless::GestureInteractionMode::OUTPUT_MODE_INTRO:
-      return new Touchless::GestureOnlyMode(osInteractionDriver, overlayDriver);
+      return new Touchless::GestureOnlyMode(osInteractionDriver, overlayDriver, tuning);
     case Touchless::GestureInteractionMode::OUTPUT_MODE_BASIC:
       Touchless::BasicMode::SetBasicMode();
-      return new Touchless::BasicMode(osInteractionDriver, overlayDriver);
+      return new Touchless::BasicMode(osInteractionDriver, overlayDriver, tuning);
     case Touchless::GestureInteractionMode::OUTPUT_MODE_ADVANCED:
-      return new Touchless::FingerMouse(osInteractionDriver, overlayDriver);
+      return new Touchless::FingerMouse(osInteractionDriver, overlayDriver, tuning);
     default:
       return nullptr;
   }
@@ -16,25 +16,29 @@
 
 namespace Touchless {
 
-float GestureOnlyMode::ZoomScaleFactor = 1.5;
 float GestureOnlyMode::TranslationScaleFactor = 1.5;
 const int64_t GestureOnlyMode::GestureRecognitionDuration = 100*MILLISECONDS;
-const float GestureOnlyMode::BUCKET_THRESHOLD = 0.75f;
-const float GestureOnlyMode::BUCKET_THRESHOLD_LOW = 0.50f;
 
+#define GESTUREONLYMODE_STATE_ENTRY(x) STATE_TABLE_ENTRY(GestureOnlyMode, x)
+const TableStateMachine<GestureOnlyMode>::StateEntry GestureOnlyMode::s_states[] = { GESTUREONLYMODE_STATES(GESTUREONLYMODE_STATE_ENTRY) };
+#undef GESTUREONLYMODE_STATE_ENTRY
 
-GestureOnlyMode::GestureOnlyMode(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver)
+
+GestureOnlyMode::GestureOnlyMode(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver, const InteractionTuning& tuning)
   :
-  GestureInteractionManager(osInteractionDriver, overlayDriver),
+  GestureInteractionManager(osInteractionDriver, overlayDriver, tuning),
   m_noTouching(true),
   m_justScrolled(false),
   m_timedCountHistory(500*MILLISECONDS),
+  m_recognitionCountWindow(GestureRecognitionDuration),
   m_favoriteHandId(-1)
 {
-  m_stateMachine.SetOwnerClass(this, "GestureOnlyMode");
+  m_stateMachine.SetOwnerClass(this, "GestureOnlyMode", s_states, GESTUREONLYMODE__STATE_COUNT);
+  m_stateMachine.SetTraceFrameId(&m_frameFeatures.frameId);
 
-  // This tells the state machine to log transitions to cerr.  An optional second can be used to specify
-  // an event ID to ignore (such as something that happens every single frame) to avoid spamming the console.
+  // Transitions are always recorded in the TransitionTrace.  This also tells the state machine to log them to
+  // cerr, as text, for debugging.  An optional second can be used to specify an event ID to ignore (such as
+  // something that happens every single frame) to avoid spamming the console.
   // Specify that OMGO__PROCESS_FRAME should be ignored.
   //m_stateMachine.SetTransitionLogger(&std::cerr, OMGO__PROCESS_FRAME);
 }
@@ -43,7 +47,8 @@ GestureOnlyMode::~GestureOnlyMode() {
   m_stateMachine.Shutdown();
 }
 
-void GestureOnlyMode::processFrameInternal() {
+void GestureOnlyMode::updateFrameStateInternal() {
+  // the bucket window counts coalesced frames too, so that its fractions don't depend on how many were skipped
   PointableCountBucketCategory category = PCBC_OTHER;
   if (shouldBeInPalmSwipeMode()) {
     category = PCBC_PALM;
@@ -53,31 +58,29 @@ void GestureOnlyMode::processFrameInternal() {
     category = PCBC_THREEPLUS;
   }
 
-  m_timedCountHistory.addFrame(m_currentFrame.timestamp(), category);
+  if (fps() > 0) {
+    m_timedCountHistory.reserveForFrameInterval(static_cast<int64_t>(SECONDS/fps()));
+  }
+  m_timedCountHistory.addFrameAndReturnDiscards(m_currentFrame.timestamp(), category);
+  m_recognitionCountWindow.update(m_timedCountHistory);
+  m_timedCountHistory.cleanUpDiscards();
+}
 
-  m_noTouching = std::count_if(m_relevantPointables.begin(), m_relevantPointables.end(),
-                               [this] (const Pointable& pointable) {
-                                  return pointable.touchZone() == Pointable::ZONE_TOUCHING;
-                               }) == 0;
+void GestureOnlyMode::processFrameInternal() {
+  m_noTouching = m_frameFeatures.relevantInZone(Pointable::ZONE_TOUCHING) == 0;
   // initialize finger mouse state machine if necessary
   if (!m_stateMachine.IsInitialized()) {
-    m_stateMachine.Initialize(&GestureOnlyMode::State_GestureRecognition, "State_GestureRecognition");
+    m_stateMachine.Initialize(State_GestureRecognition_Id);
   }
 
   // make the pointable count buckets
   for (int i = 0; i < PCBC__COUNT; ++i) {
     m_pointableCountBucket[i] = 0.0f;
   }
-  auto frameWindowEnd = m_timedCountHistory.getFrameHavingAgeAtLeast(GestureRecognitionDuration);
-  if (frameWindowEnd != m_timedCountHistory.end()) {
-    unsigned int frameCount = 0;
-    for (auto it = m_timedCountHistory.begin(); it != frameWindowEnd; ++it) {
-      ++frameCount;
-      m_pointableCountBucket[it->second] += 1.0f;
-    }
-    assert(frameCount > 0);
+  if (m_recognitionCountWindow.hasSufficientHistory()) {
+    assert(m_recognitionCountWindow.count() > 0);
     for (int i = 0; i < PCBC__COUNT; ++i) {
-      m_pointableCountBucket[i] /= frameCount;
+      m_pointableCountBucket[i] = m_recognitionCountWindow.aggregate().fraction(static_cast<PointableCountBucketCategory>(i));
     }
   } else {
     // not enough history
@@ -85,18 +88,18 @@ void GestureOnlyMode::processFrameInternal() {
   }
 
   // If any bucket breaks the threshold emit the appropriate event, if all buckets are low enough, emit an uncertain event.
-  if (m_pointableCountBucket[PCBC_TWO] >= BUCKET_THRESHOLD) {
+  if (m_pointableCountBucket[PCBC_TWO] >= m_tuning.bucketThreshold) {
     m_stateMachine.RunCurrentState(OMGO__COUNT_TWO);
-  } else if (m_pointableCountBucket[PCBC_THREEPLUS] >= BUCKET_THRESHOLD) {
+  } else if (m_pointableCountBucket[PCBC_THREEPLUS] >= m_tuning.bucketThreshold) {
     m_stateMachine.RunCurrentState(OMGO__COUNT_THREEPLUS);
-  } else if (m_pointableCountBucket[PCBC_OTHER] >= BUCKET_THRESHOLD) {
+  } else if (m_pointableCountBucket[PCBC_OTHER] >= m_tuning.bucketThreshold) {
     m_stateMachine.RunCurrentState(OMGO__COUNT_OTHER);
-  } else if (m_pointableCountBucket[PCBC_PALM] >= BUCKET_THRESHOLD) {
+  } else if (m_pointableCountBucket[PCBC_PALM] >= m_tuning.bucketThreshold) {
     m_stateMachine.RunCurrentState(OMGO__COUNT_PALM);
-  } else if (m_pointableCountBucket[PCBC_TWO] < BUCKET_THRESHOLD_LOW
-             && m_pointableCountBucket[PCBC_THREEPLUS] < BUCKET_THRESHOLD_LOW
-             && m_pointableCountBucket[PCBC_OTHER] < BUCKET_THRESHOLD_LOW
-             && m_pointableCountBucket[PCBC_PALM] < BUCKET_THRESHOLD_LOW) {
+  } else if (m_pointableCountBucket[PCBC_TWO] < m_tuning.bucketThresholdLow
+             && m_pointableCountBucket[PCBC_THREEPLUS] < m_tuning.bucketThresholdLow
+             && m_pointableCountBucket[PCBC_OTHER] < m_tuning.bucketThresholdLow
+             && m_pointableCountBucket[PCBC_PALM] < m_tuning.bucketThresholdLow) {
     m_stateMachine.RunCurrentState(OMGO__COUNT_UNCERTAIN);
   }
 
@@ -127,38 +130,8 @@ void GestureOnlyMode::processFrameInternal() {
 }
 
 void GestureOnlyMode::identifyRelevantPointables (const PointableList &pointables, std::vector<Pointable> &relevantPointables) const {
-  // Remove all ZONE_NONE pointables, backwards pointables, pointables pointing too close to straight up or down,
-  // and compare each pointable to the foremost pointable with the same hand id with a linear discriminant.
-  std::map<int32_t, int32_t> best_pointables; //map hand id to pointable id
-
-  relevantPointables.clear();
-  for (int i=0; i<pointables.count(); i++) {
-    relevantPointables.push_back(pointables[i]);
-
-    // Look for a matching hand in the map
-    auto it = best_pointables.find(pointables[i].hand().id());
-    if (it == best_pointables.end()) {
-      // This is the first pointable on this hand
-      best_pointables[pointables[i].hand().id()] = pointables[i].id();
-    } else {
-      // We've seen this hand before
-      if (m_currentFrame.pointable(it->first).tipPosition().z > pointables[i].tipPosition().z) {
-        // but this pointable is better so use it
-        best_pointables[pointables[i].hand().id()] = pointables[i].id();
-      }
-    }
-  }
-
-  auto new_end = std::remove_if(relevantPointables.begin(),
-                                relevantPointables.end(),
-                                [this, best_pointables] (const Pointable& pointable) -> bool {
-                                  Pointable best = m_currentFrame.pointable(best_pointables.find(pointable.hand().id())->second);
-                                  return pointable.touchZone() == Pointable::ZONE_NONE
-                                  || pointable.direction().z > 0
-                                  || 160 * (1 - pointable.direction().dot(best.direction())) + sqrt((pointable.tipPosition().z - best.tipPosition().z) * (pointable.tipPosition().z - best.tipPosition().z) + (pointable.tipPosition().y - best.tipPosition().y) * (pointable.tipPosition().y - best.tipPosition().y)) > 50
-                                  || std::abs(pointable.direction().y) > 0.60f;
-                                });
-  relevantPointables.erase(new_end, relevantPointables.end());
+  // pointables pointing too close to straight up or down are also removed
+  selectRelevantPointables(pointables, relevantPointables, 0.60f);
 }
 
 void GestureOnlyMode::setForemostPointable (const std::vector<Pointable> &relevantPointables, int32_t &foremostPointableId) const {
@@ -187,14 +160,14 @@ void GestureOnlyMode::generateScrollBetweenFrames (const Frame &currentFrame, co
   applyScroll(scroll_dx, scroll_dy, currentFrame.timestamp() - sinceFrame.timestamp());
 }
 
-void GestureOnlyMode::generateDesktopSwipeBetweenFrames (const Frame &currentFrame, const Frame &sinceFrame) {
+void GestureOnlyMode::generateDesktopSwipeBetweenFrames (const Snapshot &currentFrame, const Snapshot &sinceFrame) {
   float scroll_dx, scroll_dy;
 
   // scaled scrolling
 
   // damp out small motions
-  Vector translation = currentFrame.translation(sinceFrame);
-  float timeDelta = float(currentFrame.timestamp() - sinceFrame.timestamp()) / SECONDS;
+  Vector translation = translationBetween(currentFrame, sinceFrame);
+  float timeDelta = float(currentFrame.data.timestamp - sinceFrame.data.timestamp) / SECONDS;
   translation *= scrollDampingFactor(translation / timeDelta);
 
   scroll_dx = static_cast<float>(translation.x);
@@ -216,7 +189,7 @@ bool GestureOnlyMode::shouldBeInPalmSwipeMode () const {
       hand = m_currentFrame.hands()[0];
     }
   } else {
-    hand = favorite_pointable.hand();
+    hand = handOfPointable(favorite_pointable.id());
   }
   if (!hand.isValid()) {
     return false;
@@ -229,6 +202,10 @@ bool GestureOnlyMode::hasFingersTouching(const Hand& hand) const {
   if (!hand.isValid()) {
     return false;
   }
+  const int h = m_frameFeatures.findHand(hand.id());
+  if (h >= 0) {
+    return m_frameFeatures.handTouchingCount[h] > 0;
+  }
   PointableList pointables = hand.pointables();
   for (int i=0; i<pointables.count(); i++) {
     if (pointables[i].touchZone() == Pointable::ZONE_TOUCHING) {
@@ -240,7 +217,7 @@ bool GestureOnlyMode::hasFingersTouching(const Hand& hand) const {
 
 // This macro is part of the state machine -- used for convenience, to avoid
 // having to type such a long and ugly statement.
-#define GESTUREONLY_TRANSITION_TO(x) m_stateMachine.SetNextState(&GestureOnlyMode::x, #x)
+#define GESTUREONLY_TRANSITION_TO(x) m_stateMachine.SetNextState(x##_Id)
 
 // ////////////////////////////////////////////////////
 // beginning of OUTPUT_MODE_FINGER_MOUSE state handlers
@@ -253,7 +230,7 @@ bool GestureOnlyMode::State_GestureRecognition (StateMachineInput input) {
     return true; // not enough history
   }
 
-  const Frame &frame = frameWindowEnd->second;
+  const Snapshot &frame = frameWindowEnd->second;
 
   switch (input) {
     case OMGO__COUNT_PALM:
@@ -268,7 +245,7 @@ bool GestureOnlyMode::State_GestureRecognition (StateMachineInput input) {
 
     case OMGO__COUNT_THREEPLUS: {
       // 3+ gestures win
-      Vector translation = m_currentFrame.translation(frame);
+      Vector translation = translationBetween(m_currentSnapshot, frame);
       float x_y_distance = sqrtf(translation.x*translation.x + translation.y*translation.y);
       static const float TRANSLATION_DISTANCE_THRESHOLD = 50.0f;
       //std::cerr << "x_y_distance = " << x_y_distance << '\n';
@@ -332,11 +309,8 @@ bool GestureOnlyMode::State_2Fingers_Hovering (StateMachineInput input) {
     case SM_ENTER: {
       resetFavoritePointableId();
       m_lastStateChangeTime = m_currentFrame.timestamp();
-      if (m_currentFrame.pointable(favoritePointableId()).hand().isValid()) {
-        m_favoriteHandId = m_currentFrame.pointable(favoritePointableId()).hand().id();
-      } else {
-        m_favoriteHandId = -1;
-      }
+      const Hand favoriteHand = handOfPointable(favoritePointableId());
+      m_favoriteHandId = favoriteHand.isValid() ? favoriteHand.id() : -1;
       return true;
     }
 
@@ -363,8 +337,11 @@ bool GestureOnlyMode::State_2Fingers_Hovering (StateMachineInput input) {
       }
 
       // see if hand has come into view
-      if (m_favoriteHandId < 0 && favoritePointable.hand().isValid()) {
-        m_favoriteHandId = favoritePointable.hand().id();
+      if (m_favoriteHandId < 0) {
+        const Hand hand = handOfPointable(favoritePointable.id());
+        if (hand.isValid()) {
+          m_favoriteHandId = hand.id();
+        }
       }
 
       // if no hand in view, just draw normal overlay
@@ -401,11 +378,14 @@ bool GestureOnlyMode::State_2Fingers_Scrolling (StateMachineInput input) {
       Hand favoriteHand = m_currentFrame.hand(m_favoriteHandId);
       Pointable favoritePointable = m_currentFrame.pointable(favoritePointableId());
 
+      if (!favoriteHand.isValid()) {
+        favoriteHand = handOfPointable(favoritePointable.id());
+        if (favoriteHand.isValid()) {
+          m_favoriteHandId = favoriteHand.id();
+        }
+      }
       if (favoriteHand.isValid()) {
         setAbsoluteCursorPositionHand(favoriteHand);
-      } else if(favoritePointable.hand().isValid()) {
-        m_favoriteHandId = favoritePointable.hand().id();
-        setAbsoluteCursorPositionHand(favoritePointable.hand());
       } else {
         setAbsoluteCursorPositionPointable(favoritePointable);
       }
@@ -471,7 +451,7 @@ bool GestureOnlyMode::State_3PlusFingers_SwipeVertical (StateMachineInput input)
       // cause the expose to show
       auto it = m_timedFrameHistory.getFrameHavingAgeAtLeast(100*MILLISECONDS);
       if (it != m_timedFrameHistory.end()) {
-        generateDesktopSwipeBetweenFrames(m_currentFrame, it->second);
+        generateDesktopSwipeBetweenFrames(m_currentSnapshot, it->second);
         GESTUREONLY_TRANSITION_TO(State_Cooldown);
         return true;
       }
@@ -503,7 +483,7 @@ bool GestureOnlyMode::State_3PlusFingers_SwipeHorizontal (StateMachineInput inpu
       // cause a swipe of exactly one desktop
       auto it = m_timedFrameHistory.getFrameHavingAgeAtLeast(100*MILLISECONDS);
       if (it != m_timedFrameHistory.end()) {
-        generateDesktopSwipeBetweenFrames(m_currentFrame, it->second);
+        generateDesktopSwipeBetweenFrames(m_currentSnapshot, it->second);
         GESTUREONLY_TRANSITION_TO(State_Cooldown);
       }
       return true;
@@ -531,8 +511,8 @@ bool GestureOnlyMode::State_Palm_Swipe (StateMachineInput input) {
       return true;
 
     case SM_EXIT: {
-      auto it = m_timedFrameHistory.getFrameHavingAgeAtLeast(100*MILLISECONDS + static_cast<int64_t>((1-BUCKET_THRESHOLD_LOW)*GestureRecognitionDuration));
-      auto it2 = m_timedFrameHistory.getFrameHavingAgeAtLeast(static_cast<int64_t>((1-BUCKET_THRESHOLD_LOW)*GestureRecognitionDuration));
+      auto it = m_timedFrameHistory.getFrameHavingAgeAtLeast(100*MILLISECONDS + static_cast<int64_t>((1-m_tuning.bucketThresholdLow)*GestureRecognitionDuration));
+      auto it2 = m_timedFrameHistory.getFrameHavingAgeAtLeast(static_cast<int64_t>((1-m_tuning.bucketThresholdLow)*GestureRecognitionDuration));
       if (it != m_timedFrameHistory.end() && it2 != m_timedFrameHistory.end()) {
         generateDesktopSwipeBetweenFrames(it2->second, it->second);
       }
@@ -12,6 +12,7 @@
 #define __GestureOnlyMode_h__
 
 #include "GestureInteractionManager.h"
+#include "Utility/TimedHistoryWindow.h"
 
 namespace Touchless {
 
@@ -31,13 +32,15 @@ diverge slightly from "gesture only".
 
 class GestureOnlyMode : public GestureInteractionManager {
 public:
-  GestureOnlyMode(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver);
+  GestureOnlyMode(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver, const InteractionTuning& tuning = InteractionTuning());
   virtual ~GestureOnlyMode();
   virtual void stopActiveEvents();
+  virtual const char* stateName () const { return m_stateMachine.CurrentStateName(); }
 
 protected:
 
   virtual void processFrameInternal();
+  virtual void updateFrameStateInternal();
   virtual void identifyRelevantPointables (const PointableList &pointables, std::vector<Pointable> &relevantPointables) const;
   virtual void setForemostPointable (const std::vector<Pointable> &relevantPointables, int32_t &foremostPointableId) const;
 
@@ -56,11 +59,8 @@ private:
   };
 
   // Configuration Parameters
-  static float ZoomScaleFactor;
   static float TranslationScaleFactor;
   static const int64_t GestureRecognitionDuration;
-  static const float BUCKET_THRESHOLD;
-  static const float BUCKET_THRESHOLD_LOW;
 
   enum PointableCountBucketCategory {
     PCBC_TWO = 0,
@@ -73,20 +73,22 @@ private:
   };
 
   typedef TimedHistory<PointableCountBucketCategory,int64_t> TimedCountHistory;
+  typedef TimedHistoryWindow<TimedCountHistory,HistogramAggregate<PointableCountBucketCategory,PCBC__COUNT> > TimedCountWindow;
 
   bool                                        m_noTouching;
   bool                                        m_justScrolled;
-  Frame                                       m_gestureStart;
-  StateMachine<GestureOnlyMode>   m_stateMachine;
+  Snapshot                                    m_gestureStart;
+  TableStateMachine<GestureOnlyMode> m_stateMachine;
   int64_t                                     m_cooldownStartTime;
   int64_t                                     m_lastStateChangeTime;
   // TODO: write "history" filter (based on Gabe's Filter interface) and use CategoricalFilter with it
   TimedCountHistory                           m_timedCountHistory;
+  TimedCountWindow                            m_recognitionCountWindow; // the counts over GestureRecognitionDuration
   float                                       m_pointableCountBucket[PCBC__COUNT];
   int32_t                                     m_favoriteHandId;
 
   void generateScrollBetweenFrames (const Frame &currentFrame, const Frame &sinceFrame);
-  void generateDesktopSwipeBetweenFrames (const Frame &currentFrame, const Frame &sinceFrame);
+  void generateDesktopSwipeBetweenFrames (const Snapshot &currentFrame, const Snapshot &sinceFrame);
   bool shouldBeInPalmSwipeMode () const;
   bool hasFingersTouching(const Hand& hand) const;
 
@@ -103,6 +105,20 @@ private:
   bool State_Palm_GestureRecognition (StateMachineInput input);
   bool State_Palm_Swipe (StateMachineInput input);
   // end of state handlers
+
+  // the states, once each in the order of the state table; the 2 finger gestures other than scrolling and the
+  // palm gesture recognition are declared above but not implemented, so they aren't states yet
+  #define GESTUREONLYMODE_STATES(STATE) \
+    STATE(State_GestureRecognition) \
+    STATE(State_Cooldown) \
+    STATE(State_2Fingers_Hovering) \
+    STATE(State_2Fingers_Scrolling) \
+    STATE(State_3PlusFingers_SwipeVertical) \
+    STATE(State_3PlusFingers_SwipeHorizontal) \
+    STATE(State_Palm_Swipe)
+
+  enum StateId { GESTUREONLYMODE_STATES(STATE_TABLE_ID) GESTUREONLYMODE__STATE_COUNT };
+  static const TableStateMachine<GestureOnlyMode>::StateEntry s_states[GESTUREONLYMODE__STATE_COUNT];
 };
 
 }
@@ -0,0 +1,41 @@
+#if !defined(__InteractionTuning_h__)
+#define __InteractionTuning_h__
+
+#include "common.h"
+
+namespace Touchless {
+
+/// <summary>
+/// Recognition thresholds and gains of an interaction manager
+/// </summary>
+/// <remarks>
+/// These were hand-tuned constants of GestureInteractionManager and its modes.  They are held per instance so that
+/// the offline tuner can run many configurations side by side; the defaults are the hand-tuned values, and each
+/// mode reads only the members which apply to it.
+/// </remarks>
+struct InteractionTuning {
+  InteractionTuning()
+    :
+    pointableCountThreshold(0.8),
+    rtsThreshold(0.9),
+    pointableCountWindowDivisor(15),
+    rtsWindowDivisor(20),
+    bucketThreshold(0.75f),
+    bucketThresholdLow(0.50f),
+    hoverDurationToActivateDrag(500*1000),
+    zoomScaleFactor(1.5f)
+  { }
+
+  double  pointableCountThreshold;      // probability at which the filtered pointable count is unambiguous
+  double  rtsThreshold;                 // probability at which rotating, translating or scaling is unambiguous
+  double  pointableCountWindowDivisor;  // the pointable count is averaged over fps/divisor frames
+  double  rtsWindowDivisor;             // rotating, translating or scaling is averaged over fps/divisor frames
+  float   bucketThreshold;              // GestureOnlyMode: fraction of recent frames to recognize a pointable count
+  float   bucketThresholdLow;           // GestureOnlyMode: fraction below which every pointable count is released
+  int64_t hoverDurationToActivateDrag;  // FingerMouse: microseconds a click is held before it becomes a drag
+  float   zoomScaleFactor;              // gain applied to the hand's scale factor when zooming
+};
+
+}
+
+#endif // __InteractionTuning_h__
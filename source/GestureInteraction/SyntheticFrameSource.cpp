@@ -0,0 +1,226 @@
+#include "stdafx.h"
+#include "SyntheticFrameSource.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Touchless {
+using FrameModel::Vector;
+using FrameModel::FrameData;
+using FrameModel::HandData;
+using FrameModel::PointableData;
+
+// Timestamps are in microseconds, as with the Leap SDK
+static const int64_t SECONDS = 1000000;
+static const int64_t MILLISECONDS = 1000;
+
+// Layout of the synthetic fingers relative to the palm, in millimeters
+static const float FINGER_SPACING = 22.0f;
+static const float FINGER_REACH = 50.0f;
+static const float FINGER_RISE = 30.0f;
+static const float FINGER_LENGTH = 55.0f;
+static const float FINGER_WIDTH = 16.0f;
+
+SyntheticHand::SyntheticHand() :
+  id(1),
+  startTime(0),
+  endTime(0),
+  fingerCount(1),
+  position(0, 200, 0),
+  rotationRate(0),
+  spreadRate(0),
+  touchDistance(0.5f),
+  touchAmplitude(0),
+  touchFrequency(0)
+{ }
+
+SyntheticFrameSource::SyntheticFrameSource(double fps, int64_t duration, uint32_t seed) :
+  m_fps(fps),
+  m_duration(duration),
+  m_frameIndex(0),
+  m_seed(seed ? seed : 1),
+  m_randomState(m_seed),
+  m_jitter(0)
+{ }
+
+void SyntheticFrameSource::addHand(const SyntheticHand& hand) {
+  m_hands.push_back(hand);
+}
+
+void SyntheticFrameSource::addDefaultScript() {
+  static const int64_t SEGMENT = 2*SECONDS;
+  static const int64_t GAP = 250*MILLISECONDS;
+  static const int SEGMENT_TYPES = 8;
+
+  int32_t id = 1;
+  int segment = 0;
+  for (int64_t start = 0; start < m_duration; start += SEGMENT + GAP, segment++) {
+    SyntheticHand hand;
+    hand.id = id++;
+    hand.startTime = start;
+    hand.endTime = std::min(start + SEGMENT, m_duration);
+    switch (segment % SEGMENT_TYPES) {
+      case 0: // point
+        hand.position = Vector(-80, 200, 0);
+        hand.velocity = Vector(80, 0, 0);
+        break;
+      case 1: // click
+        hand.touchDistance = 0.2f;
+        hand.touchAmplitude = 0.5f;
+        hand.touchFrequency = 1.5f;
+        break;
+      case 2: // scroll
+        hand.fingerCount = 2;
+        hand.position = Vector(0, 250, 0);
+        hand.velocity = Vector(0, -100, 0);
+        hand.touchDistance = -0.3f;
+        break;
+      case 3: // rotate
+        hand.fingerCount = 2;
+        hand.rotationRate = 1.2f;
+        hand.touchDistance = -0.3f;
+        break;
+      case 4: // zoom
+        hand.fingerCount = 2;
+        hand.spreadRate = 0.6f;
+        hand.touchDistance = -0.3f;
+        break;
+      case 5: // swipe
+        hand.fingerCount = 4;
+        hand.position = Vector(-150, 200, 0);
+        hand.velocity = Vector(600, 0, 0);
+        hand.touchDistance = 0.6f;
+        break;
+      case 6: // palm swipe
+        hand.fingerCount = 0;
+        hand.position = Vector(-150, 200, 50);
+        hand.velocity = Vector(400, 0, 0);
+        break;
+      case 7: { // two hands moving apart
+        SyntheticHand other = hand;
+        other.id = id++;
+        hand.position = Vector(-40, 200, 0);
+        hand.velocity = Vector(-40, 0, 0);
+        hand.touchDistance = -0.3f;
+        other.position = Vector(40, 200, 0);
+        other.velocity = Vector(40, 0, 0);
+        other.touchDistance = -0.3f;
+        addHand(other);
+        break;
+      }
+    }
+    addHand(hand);
+  }
+}
+
+int64_t SyntheticFrameSource::frameCount() const {
+  return static_cast<int64_t>(std::floor(m_duration*m_fps/SECONDS)) + 1;
+}
+
+bool SyntheticFrameSource::nextFrame(Frame& frame) {
+  const int64_t time = static_cast<int64_t>(m_frameIndex*SECONDS/m_fps + 0.5);
+  if (time > m_duration) {
+    return false;
+  }
+
+  std::shared_ptr<FrameData> data(new FrameData());
+  data->id = m_frameIndex + 1;
+  data->timestamp = time;
+  data->interactionBox = FrameModel::InteractionBox(Vector(0, 200, 0), Vector(200, 200, 200));
+  for (size_t i = 0; i < m_hands.size(); i++) {
+    if (m_hands[i].startTime <= time && time < m_hands[i].endTime) {
+      addHandToFrame(m_hands[i], time, *data);
+    }
+  }
+
+  frame = Frame(data);
+  m_frameIndex++;
+  return true;
+}
+
+void SyntheticFrameSource::rewind() {
+  m_frameIndex = 0;
+  m_randomState = m_seed;
+}
+
+Vector SyntheticFrameSource::palmPosition(const SyntheticHand& hand, double seconds) const {
+  return hand.position + hand.velocity*static_cast<float>(seconds);
+}
+
+Vector SyntheticFrameSource::tipPosition(const SyntheticHand& hand, int finger, double seconds) const {
+  const float angle = static_cast<float>(hand.rotationRate*seconds);
+  const float spread = static_cast<float>(std::exp(hand.spreadRate*seconds));
+  const float x = spread*FINGER_SPACING*(finger - 0.5f*(hand.fingerCount - 1));
+  const float y = FINGER_RISE;
+  const Vector offset(x*std::cos(angle) - y*std::sin(angle), x*std::sin(angle) + y*std::cos(angle), -FINGER_REACH);
+  return palmPosition(hand, seconds) + offset;
+}
+
+float SyntheticFrameSource::touchDistance(const SyntheticHand& hand, double seconds) const {
+  const double distance = hand.touchDistance
+                        + hand.touchAmplitude*std::sin(2*FrameModel::PI*hand.touchFrequency*seconds);
+  return static_cast<float>(std::min(std::max(distance, -1.0), 1.0));
+}
+
+Vector SyntheticFrameSource::noise() {
+  if (m_jitter <= 0) {
+    return Vector();
+  }
+  // xorshift, rather than <random>, so that the sequence is identical on every platform.  The sum of three
+  // uniform samples on [-1, 1] has unit variance and is near enough to normal for jitter.
+  float components[3];
+  for (int i = 0; i < 3; i++) {
+    float sum = 0;
+    for (int j = 0; j < 3; j++) {
+      m_randomState ^= m_randomState << 13;
+      m_randomState ^= m_randomState >> 17;
+      m_randomState ^= m_randomState << 5;
+      sum += static_cast<float>(m_randomState)/4294967295.0f*2.0f - 1.0f;
+    }
+    components[i] = m_jitter*sum;
+  }
+  return Vector(components[0], components[1], components[2]);
+}
+
+void SyntheticFrameSource::addHandToFrame(const SyntheticHand& hand, int64_t time, FrameData& frame) {
+  HandData* handData = frame.addHand();
+  if (!handData) {
+    return;
+  }
+  static const double VELOCITY_STEP = 0.001; // seconds, for finite-difference velocities
+  const double seconds = static_cast<double>(time - hand.startTime)/SECONDS;
+
+  const Vector palm = palmPosition(hand, seconds);
+  handData->id = hand.id;
+  handData->palmPosition = palm + noise();
+  handData->stabilizedPalmPosition = palm;
+  handData->palmVelocity = hand.velocity;
+  handData->palmNormal = Vector(0, -1, 0);
+  handData->direction = Vector(0, 0, -1);
+  handData->timeVisible = static_cast<float>(seconds);
+
+  const float distance = touchDistance(hand, seconds);
+  const int zone = distance <= 0 ? FrameModel::Pointable::ZONE_TOUCHING
+                 : (distance < 1 ? FrameModel::Pointable::ZONE_HOVERING : FrameModel::Pointable::ZONE_NONE);
+  for (int finger = 0; finger < hand.fingerCount; finger++) {
+    PointableData* pointable = frame.addPointable();
+    if (!pointable) {
+      return;
+    }
+    const Vector tip = tipPosition(hand, finger, seconds);
+    const Vector previousTip = tipPosition(hand, finger, seconds - VELOCITY_STEP);
+    pointable->id = hand.id*10 + finger;
+    pointable->handId = hand.id;
+    pointable->tipPosition = tip + noise();
+    pointable->stabilizedTipPosition = tip;
+    pointable->tipVelocity = (tip - previousTip)/static_cast<float>(VELOCITY_STEP);
+    pointable->direction = Vector(0, 0.2f, -1).normalized();
+    pointable->length = FINGER_LENGTH;
+    pointable->width = FINGER_WIDTH;
+    pointable->touchDistance = distance;
+    pointable->touchZone = zone;
+    pointable->timeVisible = static_cast<float>(seconds);
+    pointable->isTool = false;
+  }
+}
+
+}
@@ -0,0 +1,97 @@
+#if !defined(__SyntheticFrameSource_h__)
+#define __SyntheticFrameSource_h__
+
+#include "FrameSource.h"
+#include "Utility/FrameModel.h"
+
+#include <vector>
+
+#if !TOUCHLESS_HEADLESS
+  #error "SyntheticFrameSource produces FrameModel frames, and so is only available to headless builds"
+#endif
+
+namespace Touchless {
+
+/// <summary>
+/// Script for one synthetic hand
+/// </summary>
+/// <remarks>
+/// The fingers are laid out side by side in front of the palm, pointing at the screen.  Over the lifetime of the
+/// hand the palm moves at a constant velocity, the fingers rotate about the palm and spread apart or together at
+/// constant rates, and the touch distance of the fingertips oscillates about a mean, which is enough to script
+/// pointing, clicking, scrolling, rotating, zooming and swiping.
+/// </remarks>
+struct SyntheticHand {
+  SyntheticHand();
+
+  int32_t        id;
+  int64_t        startTime;       // microseconds from the start of the script
+  int64_t        endTime;
+  int            fingerCount;     // 0 through 5
+  FrameModel::Vector position;    // palm position at startTime, millimeters
+  FrameModel::Vector velocity;    // millimeters per second
+  float          rotationRate;    // radians per second about the z axis
+  float          spreadRate;      // fractional change in the finger spacing per second
+  float          touchDistance;   // mean touch distance, +1 .. -1
+  float          touchAmplitude;  // amplitude of the touch distance oscillation
+  float          touchFrequency;  // oscillations per second
+};
+
+/// <summary>
+/// Generates a scripted sequence of frames at a configurable frame rate
+/// </summary>
+/// <remarks>
+/// Lets processFrame be stressed at rates well above those the hardware produces (60, 120, 300 fps or more)
+/// with no device attached.  Output is deterministic for a given script, rate and seed, including the optional
+/// positional jitter, so runs are comparable with one another.
+/// </remarks>
+class SyntheticFrameSource : public FrameSource {
+public:
+  SyntheticFrameSource(double fps, int64_t duration, uint32_t seed = 1);
+
+  /// <summary>
+  /// Adds a hand to the script
+  /// </summary>
+  void addHand(const SyntheticHand& hand);
+
+  /// <summary>
+  /// Fills the duration with a repeating cycle of pointing, clicking, scrolling, rotating, zooming, swiping and
+  /// two-handed segments
+  /// </summary>
+  void addDefaultScript();
+
+  /// <summary>
+  /// Standard deviation, in millimeters, of the noise added to tip and palm positions
+  /// </summary>
+  /// <remarks>
+  /// The stabilized positions are always noise-free.
+  /// </remarks>
+  void setJitter(float jitter) { m_jitter = jitter; }
+
+  bool nextFrame(Frame& frame) override;
+  void rewind() override;
+
+  double fps() const { return m_fps; }
+  int64_t duration() const { return m_duration; }
+  int64_t frameCount() const;
+
+private:
+  FrameModel::Vector palmPosition(const SyntheticHand& hand, double seconds) const;
+  FrameModel::Vector tipPosition(const SyntheticHand& hand, int finger, double seconds) const;
+  float touchDistance(const SyntheticHand& hand, double seconds) const;
+  FrameModel::Vector noise();
+
+  void addHandToFrame(const SyntheticHand& hand, int64_t time, FrameModel::FrameData& frame);
+
+  double                     m_fps;
+  int64_t                    m_duration;
+  int64_t                    m_frameIndex;
+  uint32_t                   m_seed;
+  uint32_t                   m_randomState;
+  float                      m_jitter;
+  std::vector<SyntheticHand> m_hands;
+};
+
+}
+
+#endif // __SyntheticFrameSource_h__
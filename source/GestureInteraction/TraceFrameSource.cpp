@@ -0,0 +1,42 @@
+#include "stdafx.h"
+#include "TraceFrameSource.h"
+
+namespace Touchless {
+
+TraceFrameSource::TraceFrameSource() :
+  m_poolCursor(0)
+{ }
+
+bool TraceFrameSource::open(const std::string& fileName) {
+  return m_reader.Open(fileName);
+}
+
+bool TraceFrameSource::nextFrame(Frame& frame) {
+  std::shared_ptr<FrameModel::FrameData> data = recycledFrameData();
+  if (!m_reader.Next(*data)) {
+    return false;
+  }
+  frame = Frame(data);
+  return true;
+}
+
+void TraceFrameSource::rewind() {
+  m_reader.Rewind();
+}
+
+std::shared_ptr<FrameModel::FrameData> TraceFrameSource::recycledFrameData() {
+  // Blocks are handed out round-robin, so the one at the cursor is the least recently used and the most likely
+  // to have been released by the consumer
+  for (size_t i = 0; i < m_pool.size(); i++) {
+    std::shared_ptr<FrameModel::FrameData>& candidate = m_pool[m_poolCursor];
+    m_poolCursor = (m_poolCursor + 1) % m_pool.size();
+    if (candidate.unique()) {
+      return candidate;
+    }
+  }
+  m_pool.push_back(std::shared_ptr<FrameModel::FrameData>(new FrameModel::FrameData()));
+  m_poolCursor = 0;
+  return m_pool.back();
+}
+
+}
@@ -0,0 +1,52 @@
+#if !defined(__TraceFrameSource_h__)
+#define __TraceFrameSource_h__
+
+#include "FrameSource.h"
+#include "Utility/FrameModel.h"
+#include "Utility/FrameTrace.h"
+
+#include <string>
+#include <vector>
+
+#if !TOUCHLESS_HEADLESS
+  #error "TraceFrameSource produces FrameModel frames, and so is only available to headless builds"
+#endif
+
+namespace Touchless {
+
+/// <summary>
+/// Replays a recorded frame trace (see FrameTrace.h) as fast as it is consumed
+/// </summary>
+/// <remarks>
+/// Frames are decoded from the memory-mapped trace into recycled FrameData blocks.  A block is reused as soon
+/// as nothing but this source refers to it, so once the pool has grown to cover the frames the consumer keeps
+/// alive (its frame history), replay performs no allocation.
+/// </remarks>
+class TraceFrameSource : public FrameSource {
+public:
+  TraceFrameSource();
+
+  bool open(const std::string& fileName);
+  bool isOpen() const { return m_reader.IsOpen(); }
+
+  bool nextFrame(Frame& frame) override;
+  void rewind() override;
+
+  size_t frameCount() const { return m_reader.FrameCount(); }
+
+  /// <summary>
+  /// Number of FrameData blocks allocated so far, which stops growing once replay reaches a steady state
+  /// </summary>
+  size_t poolSize() const { return m_pool.size(); }
+
+private:
+  std::shared_ptr<FrameModel::FrameData> recycledFrameData();
+
+  FrameTrace::Reader                                  m_reader;
+  std::vector<std::shared_ptr<FrameModel::FrameData>> m_pool;
+  size_t                                              m_poolCursor;
+};
+
+}
+
+#endif // __TraceFrameSource_h__
@@ -7,13 +7,13 @@
 namespace Touchless
 {
 
-OSInteractionDriver* OSInteractionDriver::New(LPVirtualScreen &virtualScreen)
+OSInteractionDriver* OSInteractionDriver::New(LPVirtualScreen *virtualScreen)
 {
   return new OSInteractionDriverLinux(virtualScreen);
 }
 
 
-OSInteractionDriverLinux::OSInteractionDriverLinux(LPVirtualScreen &virtualScreen)
+OSInteractionDriverLinux::OSInteractionDriverLinux(LPVirtualScreen *virtualScreen)
   : OSInteractionDriver(virtualScreen)
 { }
 
@@ -109,6 +109,11 @@ bool OSInteractionDriverLinux::touchAvailable() const
   return false;
 }
 
+int OSInteractionDriverLinux::touchVersion() const
+{
+  return 0;
+}
+
 int OSInteractionDriverLinux::numTouchScreens() const
 {
   return 0;
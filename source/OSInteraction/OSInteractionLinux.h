@@ -2,7 +2,7 @@
 
 #include "common.h"
 
-#include "Leap.h"
+#include "Utility/FrameTypes.h"
 
 #include "OSInteraction/OSInteraction.h"
 
@@ -19,7 +19,7 @@ using Leap::Vector;
 class OSInteractionDriverLinux : public OSInteractionDriver
 {
 public:
-  OSInteractionDriverLinux(LPVirtualScreen &virtualScreen);
+  OSInteractionDriverLinux(LPVirtualScreen *virtualScreen);
   ~OSInteractionDriverLinux();
 
   bool initializeTouch();
@@ -33,6 +33,7 @@ public:
   bool checkTouching(const Vector& position, float noTouchBorder) const;
   void emitTouchEvent(const TouchEvent& evt);
   bool touchAvailable() const;
+  int touchVersion() const;
   int numTouchScreens() const;
   void emitKeyboardEvent(int key, bool down);
   void emitKeyboardEvents(int* keys, int numKeys, bool down);
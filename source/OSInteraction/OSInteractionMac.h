@@ -3,7 +3,7 @@
 
 #include "common.h"
 
-#include "Leap.h"
+#include "Utility/FrameTypes.h"
 
 #include "OSInteraction/OSInteraction.h"
 
@@ -6,8 +6,8 @@ using namespace Leap;
 namespace Touchless
 {
 
-TouchPeripheral::TouchPeripheral(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver) :
-  GestureInteractionManager(osInteractionDriver, overlayDriver),
+TouchPeripheral::TouchPeripheral(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver, const InteractionTuning& tuning) :
+  GestureInteractionManager(osInteractionDriver, overlayDriver, tuning),
   m_charmsMode(-1),
   m_lastNumIcons(0)
 {
@@ -13,7 +13,7 @@ class TouchPeripheral : public GestureInteractionManager {
 
 public:
 
-  TouchPeripheral(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver);
+  TouchPeripheral(OSInteractionDriver& osInteractionDriver, OverlayDriver& overlayDriver, const InteractionTuning& tuning = InteractionTuning());
 
 protected:
 
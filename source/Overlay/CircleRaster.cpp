@@ -0,0 +1,476 @@
+#include "stdafx.h"
+#include "Overlay/CircleRaster.h"
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+//Determine minimum version of SSE to require (Windows defaults to SSE2)
+#if defined(__SSE4_2__)
+#define HAS_SSE _X_SSE4_2
+#include <nmmintrin.h>
+#elif defined(__SSE4_1__)
+#define HAS_SSE _X_SSE4_1
+#include <smmintrin.h>
+#elif defined(__SSSE3__)
+#define HAS_SSE _X_SSSE3
+#include <tmmintrin.h>
+#elif defined(__SSE3__)
+#define HAS_SSE _X_SSE3
+#include <pmmintrin.h>
+#else
+#define HAS_SSE _X_SSE2
+#include <emmintrin.h>
+#endif
+
+void CircleRaster::Setup(long width, long height, const Vector2& centerOffset, const Vector2& direction, double velocity,
+                         double outerRadius, double borderRadius, double glow, float r, float g, float b, float a)
+{
+  //Create a velocity based scale warping
+  const double radiusSq = outerRadius*outerRadius;
+  const double borderSq = (outerRadius-borderRadius)*(outerRadius-borderRadius);
+  const double minSize = std::min(width/2.0, height/2.0);
+  const double glowSq = std::min(radiusSq*glow*glow, minSize*minSize); // clamp so that glow doesn't exceed icon
+  velocity = std::max(velocity - 50.0, 0.0);
+  const double yScale = 1.0 + std::min(2.0, velocity / 900.0);
+  const double xScale = std::sqrt(1.0 / yScale);
+
+  //Find axes and center
+  Vector2 aunit = velocity == 0 ? Vector2::UnitX() : direction.normalized();
+  Vector2 bunit = Vector2(aunit.y(), -aunit.x());
+  const Vector2 center(width/2.0 - 1.0 + centerOffset.x(), height/2.0 - 1.0 + centerOffset.y());
+
+  //Calculate the drawing bounds
+  CircleRasterLayout& layout = m_layout;
+  const double xx = Vector2(aunit.x()/xScale, bunit.x()/yScale).norm()*outerRadius*std::abs(glow);
+  const double yy = Vector2(aunit.y()/xScale, bunit.y()/yScale).norm()*outerRadius*std::abs(glow);
+  layout.width = width;
+  layout.minX = std::min(width, std::max(0L, static_cast<long>(center.x() - xx)));
+  layout.minY = std::min(height, std::max(0L, static_cast<long>(center.y() - yy)));
+  layout.maxX = std::min(width, std::max(0L, static_cast<long>(center.x() + xx + 1)));
+  layout.maxY = std::min(height, std::max(0L, static_cast<long>(center.y() + yy + 1)));
+
+  //Pre-scale axes
+  aunit *= xScale;
+  bunit *= yScale;
+  layout.offsetX = static_cast<float>(0.5 - center.x());
+  layout.offsetY = static_cast<float>(0.5 - center.y());
+  layout.ax = static_cast<float>(aunit.x());
+  layout.ay = static_cast<float>(aunit.y());
+  layout.bx = static_cast<float>(bunit.x());
+  layout.by = static_cast<float>(bunit.y());
+  layout.radiusSq = static_cast<float>(radiusSq);
+  layout.borderSq = static_cast<float>(borderSq);
+  layout.glowSq = static_cast<float>(glowSq);
+  layout.invTwoRadius = static_cast<float>(1.0/(2*outerRadius));
+  layout.invGlowBand = static_cast<float>(1.0/(glowSq - radiusSq));
+  layout.alpha = a;
+
+  //Setup colors
+  if (glow > 0.0) {
+    const float mult = (glow > 1.0 ? 1.0f : 0.2f);
+    layout.dark[0] = layout.dark[1] = layout.dark[2] = mult*255;
+  } else {
+    layout.dark[0] = b*0.2f;
+    layout.dark[1] = g*0.2f;
+    layout.dark[2] = r*0.2f;
+  }
+  layout.dark[3] = 200;
+  layout.color[0] = b;
+  layout.color[1] = g;
+  layout.color[2] = r;
+  layout.color[3] = 255;
+  for (int i = 0; i < 4; i++) {
+    layout.gray[i] = (layout.color[i] + 255)*0.5f;
+  }
+}
+
+void CircleRaster::DrawWith(Path path, uint32_t* pixels) const
+{
+  if (path == PATH_AVX2 && CircleRasterDrawAVX2(m_layout, pixels)) {
+    return;
+  }
+  if (path == PATH_SCALAR) {
+    DrawScalar(pixels);
+  } else {
+    CircleRasterDrawSSE(m_layout, pixels);
+  }
+}
+
+void CircleRaster::DrawPremultiplied(uint32_t* pixels) const
+{
+  CircleRasterDrawFixed(m_layout, pixels);
+}
+
+void CircleRaster::DrawPremultipliedScalar(uint32_t* pixels) const
+{
+  for (long y = m_layout.minY; y < m_layout.maxY; y++) {
+    CircleRasterScalarSpanPremultiplied(m_layout, pixels, y, m_layout.minX);
+  }
+}
+
+void CircleRaster::DrawPacked(uint32_t* pixels) const
+{
+  //Draw the same ellipse into an image the size of the bounds
+  CircleRaster packed(*this);
+  CircleRasterLayout& layout = packed.m_layout;
+  layout.offsetX += static_cast<float>(layout.minX);
+  layout.offsetY += static_cast<float>(layout.minY);
+  layout.width = layout.maxX - layout.minX;
+  layout.maxX -= layout.minX;
+  layout.maxY -= layout.minY;
+  layout.minX = 0;
+  layout.minY = 0;
+  packed.DrawPremultiplied(pixels);
+}
+
+void CircleRaster::DrawScalar(uint32_t* pixels) const
+{
+  for (long y = m_layout.minY; y < m_layout.maxY; y++) {
+    CircleRasterScalarSpan(m_layout, pixels, y, m_layout.minX);
+  }
+}
+
+// The shape of the ellipse at the given squared distances, four at a time, with the same operations as
+// ShadeScalar: which of them are inside of the ellipse, the blend from the border color towards the fill or
+// glow color, and the opacity
+struct ShapeSSE {
+  explicit ShapeSSE(const CircleRasterLayout& layout) :
+    zero(_mm_setzero_ps()),
+    one(_mm_set1_ps(1.0f)),
+    radiusSq(_mm_set1_ps(layout.radiusSq)),
+    borderSq(_mm_set1_ps(layout.borderSq)),
+    glowSq(_mm_set1_ps(layout.glowSq)),
+    invTwoRadius(_mm_set1_ps(layout.invTwoRadius)),
+    invGlowBand(_mm_set1_ps(layout.invGlowBand)),
+    alpha(_mm_set1_ps(layout.alpha))
+  {}
+
+  void operator()(__m128 distSq, __m128& inside, __m128& blend, __m128& pixelAlpha) const {
+    inside = _mm_cmplt_ps(distSq, radiusSq);
+
+    //Inside of the ellipse
+    const __m128 insideBlend = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_sub_ps(borderSq, distSq), invTwoRadius), one), zero);
+    __m128 insideAlpha = _mm_mul_ps(alpha, _mm_min_ps(_mm_mul_ps(_mm_sub_ps(glowSq, distSq), invTwoRadius), one));
+    insideAlpha = _mm_mul_ps(insideAlpha, _mm_sub_ps(one, _mm_mul_ps(insideBlend, _mm_set1_ps(0.4f))));
+
+    //Outside of the ellipse, in the glow
+    const __m128 beyond = _mm_sub_ps(distSq, radiusSq);
+    const __m128 glowBlend = _mm_max_ps(_mm_min_ps(_mm_mul_ps(beyond, invTwoRadius), one), zero);
+    const __m128 temp = _mm_sub_ps(one, _mm_mul_ps(beyond, invGlowBand));
+    const __m128 glowAlpha = _mm_mul_ps(alpha, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(temp, temp), temp), _mm_set1_ps(0.9f)));
+
+    blend = _mm_or_ps(_mm_and_ps(inside, insideBlend), _mm_andnot_ps(inside, glowBlend));
+    pixelAlpha = _mm_or_ps(_mm_and_ps(inside, insideAlpha), _mm_andnot_ps(inside, glowAlpha));
+  }
+
+  const __m128 zero, one;
+  const __m128 radiusSq, borderSq, glowSq;
+  const __m128 invTwoRadius, invGlowBand;
+  const __m128 alpha;
+};
+
+void CircleRasterDrawSSE(const CircleRasterLayout& layout, uint32_t* pixels)
+{
+  const ShapeSSE shape(layout);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 ax = _mm_set1_ps(layout.ax);
+  const __m128 bx = _mm_set1_ps(layout.bx);
+  const __m128 glowSq = _mm_set1_ps(layout.glowSq);
+  const __m128i byteMask = _mm_set1_epi32(0x000000FF);
+  const __m128 steps = _mm_set_ps(3, 2, 1, 0);
+
+  for (long y = layout.minY; y < layout.maxY; y++) {
+    uint32_t* row = pixels + layout.width*y;
+    const float py = static_cast<float>(y) + layout.offsetY;
+    const __m128 rowA = _mm_set1_ps(py*layout.ay);
+    const __m128 rowB = _mm_set1_ps(py*layout.by);
+    long x = layout.minX;
+    for (; x + 4 <= layout.maxX; x += 4) {
+      //Calculate normalized distances for points
+      const __m128 px = _mm_add_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(x)), steps), _mm_set1_ps(layout.offsetX));
+      const __m128 fx = _mm_add_ps(_mm_mul_ps(px, ax), rowA);
+      const __m128 fy = _mm_add_ps(_mm_mul_ps(px, bx), rowB);
+      const __m128 distSq = _mm_add_ps(_mm_mul_ps(fx, fx), _mm_mul_ps(fy, fy));
+      const __m128 inGlow = _mm_cmplt_ps(distSq, glowSq);
+      __m128 inside, blend, pixelAlpha;
+      shape(distSq, inside, blend, pixelAlpha);
+      const __m128 unblend = _mm_sub_ps(one, blend);
+
+      //Apply blending to each channel, and pack them
+      __m128i packed = _mm_setzero_si128();
+      for (int c = 0; c < 4; c++) {
+        const __m128 orig = _mm_or_ps(_mm_and_ps(inside, _mm_set1_ps(layout.gray[c])), _mm_andnot_ps(inside, _mm_set1_ps(layout.color[c])));
+        const __m128 blended = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(orig, blend), _mm_mul_ps(_mm_set1_ps(layout.dark[c]), unblend)), pixelAlpha);
+        const __m128i channel = _mm_and_si128(_mm_cvttps_epi32(blended), byteMask);
+        packed = _mm_or_si128(packed, _mm_slli_epi32(channel, 8*c));
+      }
+      packed = _mm_and_si128(packed, _mm_castps_si128(inGlow));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), packed);
+    }
+    CircleRasterScalarSpan(layout, pixels, y, x);
+  }
+}
+
+// The shape of the ellipse at a squared distance within the glow, as for ShapeSSE; returns whether it is inside
+static inline bool ShadeScalar(const CircleRasterLayout& layout, float distSq, float& blend, float& alpha)
+{
+  if (distSq < layout.radiusSq) {
+    blend = std::max(0.0f, std::min((layout.borderSq - distSq)*layout.invTwoRadius, 1.0f));
+    alpha = layout.alpha*std::min((layout.glowSq - distSq)*layout.invTwoRadius, 1.0f);
+    alpha = alpha*(1.0f - blend*0.4f);
+    return true;
+  }
+  const float beyond = distSq - layout.radiusSq;
+  blend = std::max(0.0f, std::min(beyond*layout.invTwoRadius, 1.0f));
+  const float temp = 1.0f - beyond*layout.invGlowBand;
+  alpha = layout.alpha*(temp*temp*temp*0.9f);
+  return false;
+}
+
+void CircleRasterScalarSpan(const CircleRasterLayout& layout, uint32_t* pixels, long y, long x)
+{
+  uint32_t* row = pixels + layout.width*y;
+  const float py = static_cast<float>(y) + layout.offsetY;
+  const float rowA = py*layout.ay;
+  const float rowB = py*layout.by;
+  for (; x < layout.maxX; x++) {
+    //Calculate normalized distances for points
+    const float px = static_cast<float>(x) + layout.offsetX;
+    const float fx = px*layout.ax + rowA;
+    const float fy = px*layout.bx + rowB;
+    const float distSq = fx*fx + fy*fy;
+
+    //Check if point is inside of glow radius
+    if (!(distSq < layout.glowSq)) {
+      row[x] = 0;
+      continue;
+    }
+
+    float blend;
+    float alpha;
+    const float* orig = ShadeScalar(layout, distSq, blend, alpha) ? layout.gray : layout.color;
+
+    //Apply blending to pixel
+    uint32_t packed = 0;
+    for (int c = 0; c < 4; c++) {
+      const float blended = (orig[c]*blend + layout.dark[c]*(1.0f - blend))*alpha;
+      packed |= (static_cast<uint32_t>(static_cast<int32_t>(blended)) & 0xFF) << (8*c);
+    }
+    row[x] = packed;
+  }
+}
+
+void CircleRasterScalarSpanPremultiplied(const CircleRasterLayout& layout, uint32_t* pixels, long y, long x)
+{
+  uint32_t* row = pixels + layout.width*y;
+  const float py = static_cast<float>(y) + layout.offsetY;
+  const float rowA = py*layout.ay;
+  const float rowB = py*layout.by;
+  for (; x < layout.maxX; x++) {
+    const float px = static_cast<float>(x) + layout.offsetX;
+    const float fx = px*layout.ax + rowA;
+    const float fy = px*layout.bx + rowB;
+    const float distSq = fx*fx + fy*fy;
+    if (!(distSq < layout.glowSq)) {
+      row[x] = 0;
+      continue;
+    }
+
+    float blend;
+    float alpha;
+    const float* orig = ShadeScalar(layout, distSq, blend, alpha) ? layout.gray : layout.color;
+    alpha = std::max(0.0f, std::min(alpha, 1.0f));
+
+    //The alpha channel is that of Draw, and every color is scaled by it
+    const float pixelAlpha = (orig[3]*blend + layout.dark[3]*(1.0f - blend))*alpha;
+    uint32_t packed = static_cast<uint32_t>(static_cast<int32_t>(pixelAlpha)) << 24;
+    for (int c = 0; c < 3; c++) {
+      const float blended = (orig[c]*blend + layout.dark[c]*(1.0f - blend))*pixelAlpha*(1.0f/255.0f);
+      packed |= static_cast<uint32_t>(static_cast<int32_t>(blended)) << (8*c);
+    }
+    row[x] = packed;
+  }
+}
+
+// The colors of a layout for the fixed-point kernel.  Each channel's fill or glow color and its border color
+// have 7 fractional bits, and are paired in the low and high halves of a 32-bit lane, so that one
+// _mm_madd_epi16 by the pair of weights blend and 1 - blend, which have 14 fractional bits, blends them.
+struct FixedColors {
+  explicit FixedColors(const CircleRasterLayout& layout) {
+    for (int c = 0; c < 4; c++) {
+      const int32_t dark = ToFixed(layout.dark[c]) << 16;
+      gray[c] = ToFixed(layout.gray[c]) | dark;
+      color[c] = ToFixed(layout.color[c]) | dark;
+    }
+  }
+
+  static int32_t ToFixed(float value) {
+    return static_cast<int32_t>(std::max(0.0f, std::min(value, 255.0f))*128.0f + 0.5f);
+  }
+
+  int32_t gray[4];
+  int32_t color[4];
+};
+
+// Packs a pixel with the same integer operations as a lane of CircleRasterDrawFixed
+static inline uint32_t PackFixed(const int32_t* pairs, float blend, float alpha)
+{
+  // 14 fractional bits of blend, and 16 of alpha
+  const int32_t weight = static_cast<int32_t>(blend*16384.0f);
+  const uint32_t alpha16 = static_cast<uint32_t>(static_cast<int32_t>(std::max(0.0f, std::min(alpha, 1.0f))*65535.0f));
+
+  // the blended channels with 8 fractional bits, from 21
+  uint32_t blended[4];
+  for (int c = 0; c < 4; c++) {
+    blended[c] = static_cast<uint32_t>((pairs[c] & 0xFFFF)*weight + (pairs[c] >> 16)*(16384 - weight)) >> 13;
+  }
+
+  // x/255 is x*257/65536 to well within the precision kept, so the alpha channel plus its top byte scales the
+  // colors by it with a high multiply
+  const uint32_t pixelAlpha = blended[3]*alpha16 >> 16;
+  const uint32_t scale = pixelAlpha + (pixelAlpha >> 8);
+  uint32_t packed = (pixelAlpha >> 8) << 24;
+  for (int c = 0; c < 3; c++) {
+    packed |= ((blended[c]*scale >> 16) >> 8) << (8*c);
+  }
+  return packed;
+}
+
+static void CircleRasterFixedSpan(const CircleRasterLayout& layout, const FixedColors& colors, uint32_t* pixels, long y, long x)
+{
+  uint32_t* row = pixels + layout.width*y;
+  const float py = static_cast<float>(y) + layout.offsetY;
+  const float rowA = py*layout.ay;
+  const float rowB = py*layout.by;
+  for (; x < layout.maxX; x++) {
+    const float px = static_cast<float>(x) + layout.offsetX;
+    const float fx = px*layout.ax + rowA;
+    const float fy = px*layout.bx + rowB;
+    const float distSq = fx*fx + fy*fy;
+    if (!(distSq < layout.glowSq)) {
+      row[x] = 0;
+      continue;
+    }
+
+    float blend;
+    float alpha;
+    const int32_t* pairs = ShadeScalar(layout, distSq, blend, alpha) ? colors.gray : colors.color;
+    row[x] = PackFixed(pairs, blend, alpha);
+  }
+}
+
+void CircleRasterDrawFixed(const CircleRasterLayout& layout, uint32_t* pixels)
+{
+  const ShapeSSE shape(layout);
+  const FixedColors colors(layout);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 ax = _mm_set1_ps(layout.ax);
+  const __m128 bx = _mm_set1_ps(layout.bx);
+  const __m128 glowSq = _mm_set1_ps(layout.glowSq);
+  const __m128 steps = _mm_set_ps(3, 2, 1, 0);
+  const __m128i unit = _mm_set1_epi32(16384);
+  __m128i gray[4], color[4];
+  for (int c = 0; c < 4; c++) {
+    gray[c] = _mm_set1_epi32(colors.gray[c]);
+    color[c] = _mm_set1_epi32(colors.color[c]);
+  }
+
+  for (long y = layout.minY; y < layout.maxY; y++) {
+    uint32_t* row = pixels + layout.width*y;
+    const float py = static_cast<float>(y) + layout.offsetY;
+    const __m128 rowA = _mm_set1_ps(py*layout.ay);
+    const __m128 rowB = _mm_set1_ps(py*layout.by);
+    long x = layout.minX;
+    for (; x + 4 <= layout.maxX; x += 4) {
+      // the shape in single precision, as for CircleRasterDrawSSE, so the thresholds select the same pixels
+      const __m128 px = _mm_add_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(x)), steps), _mm_set1_ps(layout.offsetX));
+      const __m128 fx = _mm_add_ps(_mm_mul_ps(px, ax), rowA);
+      const __m128 fy = _mm_add_ps(_mm_mul_ps(px, bx), rowB);
+      const __m128 distSq = _mm_add_ps(_mm_mul_ps(fx, fx), _mm_mul_ps(fy, fy));
+      const __m128 inGlow = _mm_cmplt_ps(distSq, glowSq);
+      __m128 inside, blend, pixelAlpha;
+      shape(distSq, inside, blend, pixelAlpha);
+
+      // and the colors in fixed point, as for PackFixed; every value fits in the low half of its 32-bit lane
+      const __m128i weight = _mm_cvttps_epi32(_mm_mul_ps(blend, _mm_set1_ps(16384.0f)));
+      const __m128i weights = _mm_or_si128(weight, _mm_slli_epi32(_mm_sub_epi32(unit, weight), 16));
+      const __m128i alpha16 = _mm_cvttps_epi32(_mm_mul_ps(_mm_max_ps(_mm_min_ps(pixelAlpha, one), zero), _mm_set1_ps(65535.0f)));
+      const __m128i insideMask = _mm_castps_si128(inside);
+      __m128i blended[4];
+      for (int c = 0; c < 4; c++) {
+        const __m128i pairs = _mm_or_si128(_mm_and_si128(insideMask, gray[c]), _mm_andnot_si128(insideMask, color[c]));
+        blended[c] = _mm_srli_epi32(_mm_madd_epi16(pairs, weights), 13);
+      }
+      const __m128i alphaChannel = _mm_mulhi_epu16(blended[3], alpha16);
+      const __m128i scale = _mm_add_epi32(alphaChannel, _mm_srli_epi32(alphaChannel, 8));
+      __m128i packed = _mm_slli_epi32(_mm_srli_epi32(alphaChannel, 8), 24);
+      for (int c = 0; c < 3; c++) {
+        const __m128i channel = _mm_srli_epi32(_mm_mulhi_epu16(blended[c], scale), 8);
+        packed = _mm_or_si128(packed, _mm_slli_epi32(channel, 8*c));
+      }
+      packed = _mm_and_si128(packed, _mm_castps_si128(inGlow));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), packed);
+    }
+    CircleRasterFixedSpan(layout, colors, pixels, y, x);
+  }
+}
+
+static bool HasAVX2()
+{
+  // AVX2 needs the processor's AVX, AVX2 and OSXSAVE bits, and the operating system to save the YMM registers
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  const unsigned int features = static_cast<unsigned int>(info[2]);
+  __cpuidex(info, 7, 0);
+  const unsigned int extendedFeatures = static_cast<unsigned int>(info[1]);
+#else
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_max(0, 0) < 7) {
+    return false;
+  }
+  __cpuid(1, eax, ebx, ecx, edx);
+  const unsigned int features = ecx;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  const unsigned int extendedFeatures = ebx;
+#endif
+  const unsigned int OSXSAVE = 1u << 27;
+  const unsigned int AVX = 1u << 28;
+  const unsigned int AVX2 = 1u << 5;
+  if ((features & (OSXSAVE | AVX)) != (OSXSAVE | AVX) || !(extendedFeatures & AVX2)) {
+    return false;
+  }
+#if defined(_MSC_VER)
+  const unsigned long long xcr0 = _xgetbv(0);
+#else
+  unsigned int xcr0Low, xcr0High;
+  __asm__ ("xgetbv" : "=a" (xcr0Low), "=d" (xcr0High) : "c" (0));
+  const unsigned long long xcr0 = xcr0Low;
+#endif
+  return (xcr0 & 6) == 6; // XMM and YMM state
+}
+
+CircleRaster::Path CircleRaster::BestPath()
+{
+  static const Path best = CircleRasterAVX2Compiled && HasAVX2() ? PATH_AVX2 : PATH_SSE;
+  return best;
+}
+
+const char* CircleRaster::PathName(Path path)
+{
+  switch (path) {
+  case PATH_SCALAR: return "scalar";
+  case PATH_SSE:    return "sse";
+  case PATH_AVX2:   return "avx2";
+  }
+  return "";
+}
@@ -0,0 +1,81 @@
+#if !defined(__CircleRaster_h__)
+#define __CircleRaster_h__
+#include "common.h"
+#include "Utility/LPGeometry.h"
+#include "Overlay/CircleRasterKernels.h"
+
+/// <summary>
+/// The velocity-stretched, glowing ellipse of a procedural overlay icon, ready to be rasterized
+/// </summary>
+/// <remarks>
+/// Setup works out the ellipse's axes, radii and colors once per icon, in double precision, and stores them as
+/// floats.  Draw then evaluates the pixels of its bounds several at a time: four per iteration with SSE, or
+/// eight with AVX2 where the processor and the operating system support it, which is detected once with cpuid.
+/// The inside, border and glow of the ellipse are computed for every pixel and selected with masks rather than
+/// branches, and pixels outside the glow are written as transparent, so every pixel within the bounds is
+/// written.
+///
+/// DrawScalar is the reference for the vector paths: it performs the same single-precision operations in the
+/// same order, so every path produces exactly the same pixels.  The pixels are BGRA, with the colors scaled by
+/// the icon's alpha.
+///
+/// The overlay draws with DrawPremultiplied instead, whose pixels are premultiplied BGRA, as the LPIcon backends
+/// blend them.  It selects and shapes the pixels with the same single-precision operations, so it covers exactly
+/// the same pixels, and only blends the colors and scales them by the alpha channel in fixed point.
+/// </remarks>
+class CircleRaster {
+public:
+  enum Path {
+    PATH_SCALAR,
+    PATH_SSE,
+    PATH_AVX2
+  };
+
+  /// <summary>
+  /// Lays out the ellipse in an image of the given size; see LPImage::RasterCircle for the parameters
+  /// </summary>
+  void Setup(long width, long height, const Vector2& centerOffset, const Vector2& direction, double velocity,
+             double outerRadius, double borderRadius, double glow, float r, float g, float b, float a);
+
+  /// <summary>
+  /// Writes the pixels within the bounds into an image of the size given to Setup, using the fastest path
+  /// </summary>
+  void Draw(uint32_t* pixels) const { DrawWith(BestPath(), pixels); }
+  void DrawWith(Path path, uint32_t* pixels) const;
+  void DrawScalar(uint32_t* pixels) const;
+
+  /// <summary>
+  /// Writes the pixels within the bounds with premultiplied alpha, blending the colors in fixed point
+  /// </summary>
+  /// <remarks>
+  /// The alpha channel is that of Draw, and every color is scaled by it, so a compositor can add the pixel to the
+  /// background scaled by one minus its alpha without a divide.  The colors and the alpha are 16-bit fixed point
+  /// in 32-bit lanes, and every channel is within one of DrawPremultipliedScalar, the single-precision reference.
+  /// </remarks>
+  void DrawPremultiplied(uint32_t* pixels) const;
+  void DrawPremultipliedScalar(uint32_t* pixels) const;
+
+  /// <summary>
+  /// Writes the pixels within the bounds as tightly packed rows, MaxX() - MinX() wide, with DrawPremultiplied
+  /// </summary>
+  void DrawPacked(uint32_t* pixels) const;
+
+  /// <summary>
+  /// The fastest path this processor supports
+  /// </summary>
+  static Path BestPath();
+  static const char* PathName(Path path);
+
+  // the pixels which may be drawn, as a half-open rectangle
+  long MinX() const { return m_layout.minX; }
+  long MinY() const { return m_layout.minY; }
+  long MaxX() const { return m_layout.maxX; }
+  long MaxY() const { return m_layout.maxY; }
+
+  const CircleRasterLayout& Layout() const { return m_layout; }
+
+private:
+  CircleRasterLayout m_layout;
+};
+
+#endif // __CircleRaster_h__
@@ -0,0 +1,83 @@
+// The AVX2 kernel of CircleRaster.  This file alone is compiled for AVX2, and is only called once cpuid has
+// shown that the processor and the operating system support it; see CircleRasterKernels.h.
+#include "Overlay/CircleRasterKernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+extern const bool CircleRasterAVX2Compiled = true;
+
+bool CircleRasterDrawAVX2(const CircleRasterLayout& layout, uint32_t* pixels)
+{
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 ax = _mm256_set1_ps(layout.ax);
+  const __m256 bx = _mm256_set1_ps(layout.bx);
+  const __m256 radiusSq = _mm256_set1_ps(layout.radiusSq);
+  const __m256 borderSq = _mm256_set1_ps(layout.borderSq);
+  const __m256 glowSq = _mm256_set1_ps(layout.glowSq);
+  const __m256 invTwoRadius = _mm256_set1_ps(layout.invTwoRadius);
+  const __m256 invGlowBand = _mm256_set1_ps(layout.invGlowBand);
+  const __m256 alpha = _mm256_set1_ps(layout.alpha);
+  const __m256i byteMask = _mm256_set1_epi32(0x000000FF);
+  const __m256 steps = _mm256_set_ps(7, 6, 5, 4, 3, 2, 1, 0);
+  __m256 gray[4], color[4], dark[4];
+  for (int c = 0; c < 4; c++) {
+    gray[c] = _mm256_set1_ps(layout.gray[c]);
+    color[c] = _mm256_set1_ps(layout.color[c]);
+    dark[c] = _mm256_set1_ps(layout.dark[c]);
+  }
+
+  for (long y = layout.minY; y < layout.maxY; y++) {
+    uint32_t* row = pixels + layout.width*y;
+    const float py = static_cast<float>(y) + layout.offsetY;
+    const __m256 rowA = _mm256_set1_ps(py*layout.ay);
+    const __m256 rowB = _mm256_set1_ps(py*layout.by);
+    long x = layout.minX;
+    for (; x + 8 <= layout.maxX; x += 8) {
+      // the same operations as CircleRasterScalarSpan, on eight pixels
+      const __m256 px = _mm256_add_ps(_mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), steps), _mm256_set1_ps(layout.offsetX));
+      const __m256 fx = _mm256_add_ps(_mm256_mul_ps(px, ax), rowA);
+      const __m256 fy = _mm256_add_ps(_mm256_mul_ps(px, bx), rowB);
+      const __m256 distSq = _mm256_add_ps(_mm256_mul_ps(fx, fx), _mm256_mul_ps(fy, fy));
+      const __m256 inGlow = _mm256_cmp_ps(distSq, glowSq, _CMP_LT_OQ);
+      const __m256 inside = _mm256_cmp_ps(distSq, radiusSq, _CMP_LT_OQ);
+
+      const __m256 insideBlend = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(borderSq, distSq), invTwoRadius), one), zero);
+      __m256 insideAlpha = _mm256_mul_ps(alpha, _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(glowSq, distSq), invTwoRadius), one));
+      insideAlpha = _mm256_mul_ps(insideAlpha, _mm256_sub_ps(one, _mm256_mul_ps(insideBlend, _mm256_set1_ps(0.4f))));
+
+      const __m256 beyond = _mm256_sub_ps(distSq, radiusSq);
+      const __m256 glowBlend = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(beyond, invTwoRadius), one), zero);
+      const __m256 temp = _mm256_sub_ps(one, _mm256_mul_ps(beyond, invGlowBand));
+      const __m256 glowAlpha = _mm256_mul_ps(alpha, _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(temp, temp), temp), _mm256_set1_ps(0.9f)));
+
+      const __m256 blend = _mm256_blendv_ps(glowBlend, insideBlend, inside);
+      const __m256 pixelAlpha = _mm256_blendv_ps(glowAlpha, insideAlpha, inside);
+      const __m256 unblend = _mm256_sub_ps(one, blend);
+
+      __m256i packed = _mm256_setzero_si256();
+      for (int c = 0; c < 4; c++) {
+        const __m256 orig = _mm256_blendv_ps(color[c], gray[c], inside);
+        const __m256 blended = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(orig, blend), _mm256_mul_ps(dark[c], unblend)), pixelAlpha);
+        const __m256i channel = _mm256_and_si256(_mm256_cvttps_epi32(blended), byteMask);
+        packed = _mm256_or_si256(packed, _mm256_slli_epi32(channel, 8*c));
+      }
+      packed = _mm256_and_si256(packed, _mm256_castps_si256(inGlow));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + x), packed);
+    }
+    CircleRasterScalarSpan(layout, pixels, y, x);
+  }
+  return true;
+}
+
+#else
+
+extern const bool CircleRasterAVX2Compiled = false;
+
+bool CircleRasterDrawAVX2(const CircleRasterLayout&, uint32_t*)
+{
+  return false;
+}
+
+#endif
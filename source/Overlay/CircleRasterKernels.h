@@ -0,0 +1,41 @@
+#if !defined(__CircleRasterKernels_h__)
+#define __CircleRasterKernels_h__
+#include <stdint.h>
+
+/// <summary>
+/// The layout of a CircleRaster, as read by its kernels
+/// </summary>
+/// <remarks>
+/// This header is kept free of the rest of the program, since it is included by the AVX2 kernel, which is compiled
+/// for AVX2 and must not contain any code which might run on other processors: no static initializers, and no
+/// inline functions or templates which the linker might pick over the copies compiled for every processor.
+/// </remarks>
+struct CircleRasterLayout {
+  long  width;
+  long  minX, minY, maxX, maxY;     // the pixels which may be drawn, as a half-open rectangle
+  float offsetX, offsetY;           // from the center of pixel (0, 0) to the center of the ellipse
+  float ax, ay, bx, by;             // the ellipse's axes, scaled by the velocity stretch
+  float radiusSq;
+  float borderSq;                   // inside of the border
+  float glowSq;
+  float invTwoRadius;               // the reciprocal of the width of the antialiased edges
+  float invGlowBand;                // the reciprocal of glowSq - radiusSq
+  float alpha;
+  float color[4];                   // of the glow, in BGRA order
+  float gray[4];                    // of the inside
+  float dark[4];                    // of the border
+};
+
+// shades the pixels [x, maxX) of row y with the scalar reference, which the vector kernels use for remainders
+void CircleRasterScalarSpan(const CircleRasterLayout& layout, uint32_t* pixels, long y, long x);
+void CircleRasterDrawSSE(const CircleRasterLayout& layout, uint32_t* pixels);
+
+// the same with premultiplied alpha, in single precision as the reference, and with the colors in fixed point
+void CircleRasterScalarSpanPremultiplied(const CircleRasterLayout& layout, uint32_t* pixels, long y, long x);
+void CircleRasterDrawFixed(const CircleRasterLayout& layout, uint32_t* pixels);
+
+// the AVX2 kernel is in its own translation unit, which is compiled for AVX2; where it isn't, it returns false
+extern const bool CircleRasterAVX2Compiled;
+bool CircleRasterDrawAVX2(const CircleRasterLayout& layout, uint32_t* pixels);
+
+#endif // __CircleRasterKernels_h__
@@ -0,0 +1,150 @@
+#include "stdafx.h"
+#include "Overlay/CircleSpriteCache.h"
+#include "Overlay/CircleRaster.h"
+#include <algorithm>
+#include <cmath>
+
+// The grid the parameters are snapped to, in steps per unit; see CircleSpriteCache
+static const double PHASE_STEPS = 4.0;
+static const double RADIUS_STEPS = 4.0;
+static const double GLOW_STEPS = 32.0;
+static const double ALPHA_STEPS = 64.0;
+static const double STRETCH_STEPS = 32.0;
+static const int32_t ANGLE_STEPS = 32;
+
+// The stretch CircleRaster derives from the velocity, from none at 50 to the most at 1850
+static const double STRETCH_START = 50.0;
+static const double STRETCH_VELOCITY = 900.0;
+static const double STRETCH_MAX = 2.0;
+
+static const double PI = 3.14159265358979323846;
+
+static int32_t Snap(double value, double steps)
+{
+  return static_cast<int32_t>(std::floor(value*steps + 0.5));
+}
+
+static uint32_t SnapChannel(float value)
+{
+  return static_cast<uint32_t>(std::min(255, std::max(0, Snap(value, 1.0))));
+}
+
+CircleSpriteCache::CircleSpriteCache():
+  m_budget(DEFAULT_BUDGET),
+  m_bytes(0),
+  m_hits(0),
+  m_misses(0)
+{
+}
+
+std::shared_ptr<const CircleSprite> CircleSpriteCache::Get(long width, long height, const Vector2& centerOffset, const Vector2& direction, double velocity,
+                                                           double outerRadius, double borderRadius, double glow, float r, float g, float b, float a)
+{
+  Key key;
+  key.width = static_cast<int32_t>(width);
+  key.height = static_cast<int32_t>(height);
+  key.phaseX = Snap(centerOffset.x(), PHASE_STEPS);
+  key.phaseY = Snap(centerOffset.y(), PHASE_STEPS);
+  key.stretch = Snap(std::min(STRETCH_MAX, std::max(velocity - STRETCH_START, 0.0) / STRETCH_VELOCITY), STRETCH_STEPS);
+  key.angle = 0;
+  if (key.stretch > 0) {
+    // The ellipse is symmetric under a half turn, so only the direction modulo a half turn matters
+    key.angle = Snap(std::atan2(direction.y(), direction.x()), ANGLE_STEPS/PI) % ANGLE_STEPS;
+    if (key.angle < 0)
+      key.angle += ANGLE_STEPS;
+  }
+  key.radius = Snap(outerRadius, RADIUS_STEPS);
+  key.border = Snap(borderRadius, RADIUS_STEPS);
+  key.glow = Snap(glow, GLOW_STEPS);
+  key.alpha = std::max(0, Snap(a, ALPHA_STEPS));
+  key.color = SnapChannel(b) | SnapChannel(g) << 8 | SnapChannel(r) << 16;
+
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  std::map<Key, EntryList::iterator>::iterator found = m_index.find(key);
+  if (found != m_index.end()) {
+    m_hits++;
+    m_entries.splice(m_entries.begin(), m_entries, found->second);
+    return found->second->sprite;
+  }
+  m_misses++;
+
+  // Draw without holding the lock, so that other icons can be looked up and drawn meanwhile
+  lock.unlock();
+  Entry entry;
+  entry.key = key;
+  entry.sprite = Draw(key);
+  entry.bytes = sizeof(Entry) + sizeof(CircleSprite) + sizeof(uint32_t)*entry.sprite->pixels.size();
+  lock.lock();
+
+  // Another thread may have drawn the same sprite meanwhile, in which case either will do
+  if (m_index.find(key) == m_index.end()) {
+    m_entries.push_front(entry);
+    m_index[key] = m_entries.begin();
+    m_bytes += entry.bytes;
+    Evict();
+  }
+  return entry.sprite;
+}
+
+std::shared_ptr<const CircleSprite> CircleSpriteCache::Draw(const Key& key)
+{
+  const double stretch = key.stretch / STRETCH_STEPS;
+  const double angle = key.angle*PI/ANGLE_STEPS;
+
+  CircleRaster circle;
+  circle.Setup(
+    key.width,
+    key.height,
+    Vector2(key.phaseX/PHASE_STEPS, key.phaseY/PHASE_STEPS),
+    Vector2(std::cos(angle), std::sin(angle)),
+    key.stretch > 0 ? STRETCH_START + stretch*STRETCH_VELOCITY : 0.0,
+    key.radius/RADIUS_STEPS,
+    key.border/RADIUS_STEPS,
+    key.glow/GLOW_STEPS,
+    static_cast<float>(key.color >> 16 & 0xFF),
+    static_cast<float>(key.color >> 8 & 0xFF),
+    static_cast<float>(key.color & 0xFF),
+    static_cast<float>(key.alpha/ALPHA_STEPS)
+  );
+
+  std::shared_ptr<CircleSprite> sprite(new CircleSprite);
+  sprite->bounds.left = circle.MinX();
+  sprite->bounds.top = circle.MinY();
+  sprite->bounds.right = circle.MaxX();
+  sprite->bounds.bottom = circle.MaxY();
+
+  const long spriteWidth = circle.MaxX() - circle.MinX();
+  const long spriteHeight = circle.MaxY() - circle.MinY();
+  if (spriteWidth > 0 && spriteHeight > 0) {
+    sprite->pixels.resize(spriteWidth*spriteHeight);
+    circle.DrawPacked(&sprite->pixels[0]);
+  }
+  return sprite;
+}
+
+void CircleSpriteCache::SetBudget(size_t bytes)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  m_budget = bytes;
+  Evict();
+}
+
+void CircleSpriteCache::Evict()
+{
+  // m_mutex must be held
+  // The most recent sprite is always kept, even if it alone exceeds the budget
+  while (m_bytes > m_budget && m_index.size() > 1) {
+    const Entry& oldest = m_entries.back();
+    m_bytes -= oldest.bytes;
+    m_index.erase(oldest.key);
+    m_entries.pop_back();
+  }
+}
+
+void CircleSpriteCache::Clear()
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_index.clear();
+  m_bytes = 0;
+}
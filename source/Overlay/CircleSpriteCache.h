@@ -0,0 +1,106 @@
+#if !defined(__CircleSpriteCache_h__)
+#define __CircleSpriteCache_h__
+#include "common.h"
+#include "C++11/cpp11.h"
+#include "Utility/LPGeometry.h"
+#include SHARED_PTR_HEADER
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <list>
+#include <map>
+#include <vector>
+
+/// <summary>
+/// The pixels of a rasterized procedural icon, covering only the bounds of its glow
+/// </summary>
+struct CircleSprite {
+  // Where the pixels go in an image of the size the sprite was drawn for, as a half-open rectangle
+  RECT bounds;
+  // The rows of bounds, tightly packed, as premultiplied BGRA
+  std::vector<uint32_t> pixels;
+};
+
+/// <summary>
+/// Rasterized procedural icons, keyed by their quantized parameters and evicted least recently used first
+/// </summary>
+/// <remarks>
+/// The parameters of a procedural icon change only slightly from one frame to the next, so rather than
+/// evaluating the ellipse for every pixel of every frame, Get snaps them onto a grid and reuses the sprite
+/// drawn for the same grid point.  The grid is fine enough that snapping is not visible:  quarter pixels of
+/// radius and border, 1/32 of glow, whole color values, 1/64 of alpha, 32 directions over the half turn in
+/// which the ellipse is symmetric, and 1/32 of the velocity stretch.  The sub-pixel center offset is snapped to
+/// a quarter pixel, so each sprite has at most sixteen phase variants.
+///
+/// Misses are drawn with CircleRaster at the snapped parameters, straight into the sprite.  A hovering finger
+/// hits on nearly every frame, and a hit is only a copy of the sprite; a fast-moving one mostly misses, which
+/// costs a little more than drawing the icon directly.  Sprites are shared, so one which is evicted while a
+/// caller still holds it stays valid.  Get may be called from several threads at once: lookups are made under
+/// a lock, but misses are drawn outside it.
+/// </remarks>
+class CircleSpriteCache {
+public:
+  CircleSpriteCache();
+
+  /// <summary>
+  /// The sprite for the given icon; see LPImage::RasterCircle for the parameters
+  /// </summary>
+  std::shared_ptr<const CircleSprite> Get(long width, long height, const Vector2& centerOffset, const Vector2& direction, double velocity,
+                                          double outerRadius, double borderRadius, double glow, float r, float g, float b, float a);
+
+  /// <summary>
+  /// The approximate number of bytes the cached sprites may occupy before the least recently used are evicted
+  /// </summary>
+  void SetBudget(size_t bytes);
+  size_t Budget() const { return m_budget; }
+  size_t Bytes() const { return m_bytes; }
+  size_t Count() const { return m_index.size(); }
+
+  void Clear();
+
+  // Lookup statistics since construction
+  uint64_t Hits() const { return m_hits; }
+  uint64_t Misses() const { return m_misses; }
+
+  static const size_t DEFAULT_BUDGET = 4*1024*1024;
+
+private:
+  // The snapped parameters, as grid indices.  Every field is 32 bits wide, so there is no padding and keys may
+  // be compared bytewise.
+  struct Key {
+    int32_t width;
+    int32_t height;
+    int32_t phaseX;
+    int32_t phaseY;
+    int32_t angle;
+    int32_t stretch;
+    int32_t radius;
+    int32_t border;
+    int32_t glow;
+    int32_t alpha;
+    uint32_t color;
+
+    bool operator<(const Key& rhs) const { return memcmp(this, &rhs, sizeof(Key)) < 0; }
+  };
+
+  struct Entry {
+    Key key;
+    std::shared_ptr<const CircleSprite> sprite;
+    size_t bytes;
+  };
+  typedef std::list<Entry> EntryList;
+
+  std::shared_ptr<const CircleSprite> Draw(const Key& key);
+  void Evict();
+
+  boost::mutex m_mutex;
+
+  // Most recently used first
+  EntryList m_entries;
+  std::map<Key, EntryList::iterator> m_index;
+  size_t m_budget;
+  size_t m_bytes;
+  uint64_t m_hits;
+  uint64_t m_misses;
+};
+
+#endif // __CircleSpriteCache_h__
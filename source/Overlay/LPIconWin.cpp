@@ -4,7 +4,9 @@
 #include "Overlay/LPImage.h"
 #include "Overlay/LPImageWin.h"
 
-LPIconWin::LPIconWin(void) {
+LPIconWin::LPIconWin(void):
+  m_uploadedImage(nullptr)
+{
   // Create the window with the class registered as part of application
   // initialization.  This window will be used to draw overlay icons.
   m_hWnd = CreateWindowExW(
@@ -109,18 +111,39 @@ bool LPIconWin::Update(void) {
   // Need a DC for the screen
   HDC hDC = GetDC(nullptr);
 
+  // The window keeps the pixels it was last given, so if it already holds this image then only the rectangle
+  // which changed since then needs to be copied.  The DIB is bottom-up, so its rows are flipped relative to
+  // the window's.
+  RECT rcDirty = {0, 0, wndSize.cx, wndSize.cy};
+  if (m_uploadedImage == m_image.get()) {
+    if (!m_image->IsDirty()) {
+      ReleaseDC(nullptr, hDC);
+      return true;
+    }
+    const RECT& rcImage = m_image->GetDirtyRect();
+    rcDirty.left = rcImage.left;
+    rcDirty.right = rcImage.right;
+    rcDirty.top = wndSize.cy - rcImage.bottom;
+    rcDirty.bottom = wndSize.cy - rcImage.top;
+  }
+
   auto pWinIcon = static_cast<LPImageWin*>(m_image.get());
-  BOOL rs = UpdateLayeredWindow(
-    m_hWnd,          // The window to be updated.
-    hDC,          // The DC for the screen where the window will be rendered
-    nullptr,        // Default destination point
-    &wndSize,        // Size is our own window size--won't default correctly
-    pWinIcon->GetDC(),    // Source DC is the image's source DC
-    &ptSrc,          // Source point is the origin
-    0,            // No color key
-    &blend,          // Blend function specified above
-    ULW_ALPHA        // Alpha channel is in the image
-  );
+  UPDATELAYEREDWINDOWINFO info;
+  info.cbSize = sizeof(info);
+  info.hdcDst = hDC;                // The DC for the screen where the window will be rendered
+  info.pptDst = nullptr;            // Default destination point
+  info.psize = &wndSize;            // Size is our own window size--won't default correctly
+  info.hdcSrc = pWinIcon->GetDC();  // Source DC is the image's source DC
+  info.pptSrc = &ptSrc;             // Source point is the origin
+  info.crKey = 0;                   // No color key
+  info.pblend = &blend;             // Blend function specified above
+  info.dwFlags = ULW_ALPHA;         // Alpha channel is in the image
+  info.prcDirty = &rcDirty;         // Only this part of the source needs to be copied
+  BOOL rs = UpdateLayeredWindowIndirect(m_hWnd, &info);
+  if (rs) {
+    m_uploadedImage = m_image.get();
+    m_image->ResetDirtyRect();
+  }
 
   // Done with our DC
   ReleaseDC(nullptr, hDC);
@@ -16,6 +16,10 @@ public:
 protected:
   HWND m_hWnd;
 
+  // The image whose pixels the window last received, which it keeps between updates.  Only compared by
+  // address: a newly allocated image is entirely dirty, so it is uploaded in full regardless.
+  const LPImage* m_uploadedImage;
+
   friend class LPIconWindowClass;
 
 public:
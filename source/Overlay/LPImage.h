@@ -15,9 +15,35 @@ public:
 
   static LPImage* New(void);
 
+  /// <summary>
+  /// Draws a procedural icon into the image, leaving the rest of the image transparent
+  /// </summary>
+  /// <remarks>
+  /// Only the pixels of the previous drawing which the new one does not cover are cleared, and the union of
+  /// the two is added to the dirty rectangle.
+  /// </remarks>
   void RasterCircle(const Vector2& centerOffset, const Vector2& direction, double velocity, double outerRadius, double borderRadius, double glow, float r, float g, float b, float a);
   void Clear();
 
+  /// <summary>
+  /// Draws pre-rendered pixels into the image in the same way, leaving the rest of the image transparent
+  /// </summary>
+  /// <param name="bounds">Where the pixels go, as a half-open rectangle which must lie within the image</param>
+  /// <param name="pixels">The rows of the rectangle, tightly packed</param>
+  void DrawSprite(const RECT& bounds, const uint32_t* pixels);
+
+  /// <summary>
+  /// The pixels which have changed since ResetDirtyRect was last called
+  /// </summary>
+  /// <remarks>
+  /// The rectangle is half-open, in the rows and columns of GetInternalImage, and is empty when nothing has
+  /// changed.  Platform icons upload just this region and then reset it, so an image which is redrawn should only be
+  /// shown by one icon.
+  /// </remarks>
+  const RECT& GetDirtyRect() const { return m_dirtyRect; }
+  bool IsDirty() const { return m_dirtyRect.left < m_dirtyRect.right && m_dirtyRect.top < m_dirtyRect.bottom; }
+  void ResetDirtyRect();
+
   /// <summary>
   /// Creates an image from the passed file
   /// </summary>
@@ -36,6 +62,24 @@ protected:
   POINT m_hotspot;
   SIZE m_size;
 
+  // The pixels which may not be transparent, and the pixels which have changed since the dirty rectangle was
+  // last reset.  Both are half-open.
+  RECT m_drawnRect;
+  RECT m_dirtyRect;
+
+  /// <summary>
+  /// Marks every pixel as drawn and dirty, for backends which have just allocated or written the whole image
+  /// </summary>
+  void InvalidateImage();
+
+private:
+  // The steps shared by every drawing: clearing what the drawing in the given rectangle won't overwrite, and
+  // then recording it as the drawn rectangle
+  void ClearOutside(const RECT& drawn);
+  void SetDrawnRect(const RECT& drawn);
+
+protected:
+
   /// <summary>
   /// Constructs an image
   /// </summary>
@@ -72,6 +72,8 @@ bool LPImageMac::InitImage(long width, long height, const POINT* pHotspot) {
 
   delete [] m_colors;
   m_colors = new RGBQUAD[m_size.cx*m_size.cy];
+  // The new buffer is uninitialized, so the first drawing has to clear all of it
+  InvalidateImage();
 
   return status;
 }
\ No newline at end of file
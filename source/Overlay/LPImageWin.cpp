@@ -169,6 +169,9 @@ bool LPImageWin::InitImage(long width, long height, const POINT* pHotspot) {
   // Attach the DC:
   SetDC(hDC, pHotspot);
 
+  // The whole of the new bitmap has to be uploaded
+  InvalidateImage();
+
   // Done, return.
   return true;
 }
\ No newline at end of file
@@ -149,35 +149,97 @@ double OverlayDriver::touchDistanceToRadius (float touchDistance)
 }
 
 void OverlayDriver::drawRasterIcon(int iconIndex, float x, float y, bool visible, const Vector3& velocity, float touchDistance, double radius, float clampDistance, float alphaMult, int numFingers)
+{
+  queueRasterIcon(iconIndex, x, y, visible, velocity, touchDistance, radius, clampDistance, alphaMult, numFingers);
+  drawQueuedIcons();
+}
+
+void OverlayDriver::queueRasterIcon(int iconIndex, float x, float y, bool visible, const Vector3& velocity, float touchDistance, double radius, float clampDistance, float alphaMult, int numFingers)
 {
   if (iconIndex < 0 || iconIndex >= m_numOverlayPoints) {
     return;
   }
-  if (visible) {
-    Vector2 velXY(velocity.x(), velocity.y());
-    double velNorm = velXY.norm();
-    float r = 255;
-    float g = 255;
-    float b = 255;
-    float a = std::min(1.0f - touchDistance*touchDistance, 1.0f);
-    double borderRadius = std::min(radius, 2.5 + std::max(0.0, 15.0 - radius));
-    double glow = std::max(-touchDistance*2.0, 0.0) + (touchDistance < 0.0 ? 3.0 : 1.0);
-    if (touchDistance < 0.0f) {
-      r = 100;
-      g = 225;
-      b = 100;
-      borderRadius = 2;
-      //radius = 10.0;
+  if (!visible) {
+    setIconVisibility(iconIndex, false);
+    return;
+  }
+
+  // An icon queued twice before being drawn is only drawn the second way, so that no two jobs share an image
+  RasterJob* job = nullptr;
+  for (size_t i = 0; i < m_rasterJobs.size(); i++) {
+    if (m_rasterJobs[i].iconIndex == iconIndex) {
+      job = &m_rasterJobs[i];
     }
-    a *= (1.0f - std::min(1.0f, (clampDistance / acceptableClampDistance())));
-    a *= alphaMult;
-    Vector2 centerOffset(std::fmod(x, 1.0f), 1.0f-std::fmod(y, 1.0f));
-    LPPoint position = LPPointMake(static_cast<LPFloat>(x), static_cast<LPFloat>(y));
-    m_overlayImages[iconIndex]->RasterCircle(centerOffset, velXY, velNorm, radius, borderRadius, glow, r, g, b, a);
-    m_overlayPoints[iconIndex]->SetImage(m_overlayImages[iconIndex], false);
-    m_overlayPoints[iconIndex]->SetPosition(position);
   }
-  setIconVisibility(iconIndex, visible);
+  if (!job) {
+    m_rasterJobs.push_back(RasterJob());
+    job = &m_rasterJobs.back();
+  }
+
+  Vector2 velXY(velocity.x(), velocity.y());
+  float r = 255;
+  float g = 255;
+  float b = 255;
+  float a = std::min(1.0f - touchDistance*touchDistance, 1.0f);
+  double borderRadius = std::min(radius, 2.5 + std::max(0.0, 15.0 - radius));
+  double glow = std::max(-touchDistance*2.0, 0.0) + (touchDistance < 0.0 ? 3.0 : 1.0);
+  if (touchDistance < 0.0f) {
+    r = 100;
+    g = 225;
+    b = 100;
+    borderRadius = 2;
+    //radius = 10.0;
+  }
+  a *= (1.0f - std::min(1.0f, (clampDistance / acceptableClampDistance())));
+  a *= alphaMult;
+
+  job->iconIndex = iconIndex;
+  job->position = LPPointMake(static_cast<LPFloat>(x), static_cast<LPFloat>(y));
+  job->offsetX = std::fmod(x, 1.0f);
+  job->offsetY = 1.0f-std::fmod(y, 1.0f);
+  job->directionX = velXY.x();
+  job->directionY = velXY.y();
+  job->velocity = velXY.norm();
+  job->radius = radius;
+  job->borderRadius = borderRadius;
+  job->glow = glow;
+  job->r = r;
+  job->g = g;
+  job->b = b;
+  job->a = a;
+}
+
+void OverlayDriver::drawQueuedIcons()
+{
+  if (m_rasterJobs.empty()) {
+    return;
+  }
+
+  // Each job draws into its own image, so they can be rasterized concurrently; the icons are only touched
+  // once all of them are done
+  m_workerPool.ParallelFor(static_cast<int>(m_rasterJobs.size()), [this] (int i) {
+    this->rasterize(m_rasterJobs[i]);
+  });
+
+  for (size_t i = 0; i < m_rasterJobs.size(); i++) {
+    const RasterJob& job = m_rasterJobs[i];
+    m_overlayPoints[job.iconIndex]->SetImage(m_overlayImages[job.iconIndex], false);
+    m_overlayPoints[job.iconIndex]->SetPosition(job.position);
+    setIconVisibility(job.iconIndex, true);
+  }
+  m_rasterJobs.clear();
+}
+
+void OverlayDriver::rasterize(const RasterJob& job)
+{
+  const std::shared_ptr<LPImage>& image = m_overlayImages[job.iconIndex];
+  if (!image->GetInternalImage()) {
+    return;
+  }
+  const std::shared_ptr<const CircleSprite> sprite =
+    m_spriteCache.Get(image->GetWidth(), image->GetHeight(), Vector2(job.offsetX, job.offsetY), Vector2(job.directionX, job.directionY),
+                      job.velocity, job.radius, job.borderRadius, job.glow, job.r, job.g, job.b, job.a);
+  image->DrawSprite(sprite->bounds, sprite->pixels.empty() ? nullptr : &sprite->pixels[0]);
 }
 
 bool OverlayDriver::useProceduralOverlay() const
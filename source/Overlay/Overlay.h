@@ -3,13 +3,15 @@
 
 #include "common.h"
 
-#include "LeapMath.h"
+#include "Utility/FrameTypes.h"
 
 #if __APPLE__
 #include "Overlay/LPOverlay.h"
 #elif !defined _WIN32
 #endif
 #include "Utility/LPVirtualScreen.h"
+#include "Overlay/CircleSpriteCache.h"
+#include "Utility/WorkerPool.h"
 #include "AxisAlignedBox.h"
 #include "FileSystemUtil.h"
 
@@ -45,6 +47,20 @@ public:
 
   static double touchDistanceToRadius (float touchDistance);
   void drawRasterIcon(int iconIndex, float x, float y, bool visible, const Vector3& velocity, float touchDistance, double radius, float clampDistance, float alphaMult, int numFingers = 1);
+
+  /// <summary>
+  /// Works out a procedural icon like drawRasterIcon, but leaves it to be drawn by drawQueuedIcons
+  /// </summary>
+  /// <remarks>
+  /// Icons which are not visible are hidden straight away.
+  /// </remarks>
+  void queueRasterIcon(int iconIndex, float x, float y, bool visible, const Vector3& velocity, float touchDistance, double radius, float clampDistance, float alphaMult, int numFingers = 1);
+
+  /// <summary>
+  /// Rasterizes the queued icons across the worker pool, and then shows them at their new positions
+  /// </summary>
+  void drawQueuedIcons();
+
   bool checkTouching(const Vector& position, float noTouchBorder) const;
   bool touchAvailable() const;
 
@@ -64,10 +80,31 @@ public:
   int                                     m_filledImageIdx;
   int                                     m_lastNumIcons;
   bool                                    m_UseProceduralOverlay;
+  CircleSpriteCache                       m_spriteCache;
+  WorkerPool                              m_workerPool;
 #if __APPLE__
   LPOverlay                               m_overlay;
 #endif
 
+private:
+  // A procedural icon waiting to be drawn by drawQueuedIcons.  Vectors are kept as scalars, which unlike
+  // Eigen's fixed-size vectors need no particular alignment within a std::vector.
+  struct RasterJob {
+    int iconIndex;
+    LPPoint position;
+    double offsetX, offsetY;
+    double directionX, directionY;
+    double velocity;
+    double radius;
+    double borderRadius;
+    double glow;
+    float r, g, b, a;
+  };
+
+  void rasterize(const RasterJob& job);
+
+  std::vector<RasterJob>                  m_rasterJobs;
+
 };
 
 }
@@ -2,9 +2,25 @@
 #include "TouchlessListener.h"
 #include "Configuration/Config.h"
 #include "FileSystemUtil.h"
+#include "LatencyMonitor.h"
+#include "TransitionTrace.h"
+#include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
 
-TouchlessListener::TouchlessListener()
+// where the transition trace is dumped when transition_dump_file is set; read by the terminate handler
+static std::string s_transitionDumpFile;
+
+// dumps the recent state machine transitions before an unhandled exception takes the process down
+static void dumpTransitionsAndAbort() {
+  TransitionTrace::Dump(s_transitionDumpFile);
+  std::abort();
+}
+
+TouchlessListener::TouchlessListener() :
+  m_latencyDump(0)
 {
   Config::InitializeDefaults();
   std::string configPath = FileSystemUtil::GetUserPath("touchless-config.json");
@@ -19,8 +35,32 @@ TouchlessListener::TouchlessListener()
   }
 
   Config::LoadFromFile(configPath, false);
+  int debounceMilliseconds = ConfigPersister::DEFAULT_DEBOUNCE_MILLISECONDS;
+  Config::GetAttribute<int>("config_save_debounce_ms", debounceMilliseconds);
+  m_configPersister.SetDebounceWindow(static_cast<uint32_t>(std::max(debounceMilliseconds, 0)));
+  std::string frameTraceFile;
+  if (Config::GetAttribute<std::string>("frame_trace_file", frameTraceFile) && !frameTraceFile.empty()) {
+    m_frameTraceRecorder.Open(frameTraceFile);
+  }
+  int latencyDumpMilliseconds = 0;
+  if (Config::GetAttribute<int>("latency_dump_interval_ms", latencyDumpMilliseconds) && latencyDumpMilliseconds > 0) {
+    m_latencyDump.SetTimeout(static_cast<uint32_t>(latencyDumpMilliseconds));
+    m_latencyDump.Start([] () {LatencyMonitor::Dump(std::cerr);});
+  }
+  if (Config::GetAttribute<std::string>("transition_dump_file", s_transitionDumpFile) && !s_transitionDumpFile.empty()) {
+    std::set_terminate(dumpTransitionsAndAbort);
+  }
   m_desiredMode = Touchless::GestureInteractionMode::OUTPUT_MODE_DISABLED;
-  m_updateSettings = false;
+  m_stopProcessing = false;
+  m_processingIdle = false;
+  m_resetLastFrame = false;
+  m_modeChanged = false;
+  m_framesReceived = 0;
+  m_framesProcessed = 0;
+  m_framesDropped = 0;
+  m_framesCoalesced = 0;
+  m_coalesceFrames = true;
+  Config::GetAttribute<bool>("frame_coalescing", m_coalesceFrames);
   m_useMultipleMonitors = false;
   m_ready = false;
   m_osInteractionDriver = Touchless::OSInteractionDriver::New(&m_virtualScreen);
@@ -31,9 +71,24 @@ TouchlessListener::TouchlessListener()
   m_overlayDriver->initializeOverlay();
 
   updateDefaultScreen();
+
+  m_processingThread = boost::thread([this] () {this->processingLoop();});
 }
 
 TouchlessListener::~TouchlessListener() {
+  // Signal the processing thread to terminate, and wait for it before tearing down what it uses:
+  m_stopProcessing = true;
+  {
+    boost::lock_guard<boost::mutex> lock(m_frameMutex);
+  }
+  m_frameAvailable.notify_all();
+  m_processingThread.join();
+  m_latencyDump.Stop();
+  m_configPersister.Flush();
+  if (!s_transitionDumpFile.empty()) {
+    TransitionTrace::Dump(s_transitionDumpFile);
+  }
+
   delete m_osInteractionDriver;
   delete m_overlayDriver;
   delete m_interactionManager;
@@ -57,7 +112,7 @@ void TouchlessListener::onConnect(const Leap::Controller& leap) {
 
 void TouchlessListener::onDisconnect(const Leap::Controller& leap) {
   m_osInteractionDriver->cancelGestureEvents();
-  m_lastFrame = Leap::Frame();
+  m_resetLastFrame = true;
   Q_EMIT(connectChangedSignal(false, static_cast<int>(m_desiredMode), m_useMultipleMonitors));
 }
 
@@ -67,27 +122,90 @@ void TouchlessListener::onExit(const Leap::Controller& leap) {
 }
 
 void TouchlessListener::onFrame(const Leap::Controller& leap) {
-  const Leap::Frame frame = leap.frame();
+  ++m_framesReceived;
+  ReceivedFrame received;
+  received.receivedAt = LatencyMonitor::Now();
+  received.frame = leap.frame();
+  m_frameTraceRecorder.Record(received.frame);
+  if (!m_frameQueue.Enqueue(received)) {
+    // processing is stalled with a full queue, which it will coalesce once it resumes
+    ++m_framesDropped;
+    return;
+  }
+  // Pairs with the fence in waitForFrame: either we see that the processing thread is idle and wake it, or it
+  // sees this frame before it waits.  Taking the lock orders the notification after it has started waiting.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_processingIdle.load(std::memory_order_relaxed)) {
+    boost::lock_guard<boost::mutex> lock(m_frameMutex);
+    m_frameAvailable.notify_one();
+  }
+}
+
+void TouchlessListener::waitForFrame() {
+  boost::unique_lock<boost::mutex> lock(m_frameMutex);
+  m_processingIdle.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  while (m_frameQueue.IsEmpty() && !m_stopProcessing) {
+    m_frameAvailable.wait(lock);
+  }
+  m_processingIdle.store(false, std::memory_order_relaxed);
+}
+
+void TouchlessListener::processingLoop() {
+  ReceivedFrame received;
+  while (!m_stopProcessing) {
+    if (!m_frameQueue.Dequeue(received)) {
+      waitForFrame();
+      continue;
+    }
+    // A newer frame already waiting means processing has fallen behind the device.  Rather than let the lag
+    // compound, only fold this one into the history and filters, and process the newest frame instead.
+    if (m_coalesceFrames && !m_frameQueue.IsEmpty()) {
+      coalesceFrame(received.frame);
+      ++m_framesCoalesced;
+      continue;
+    }
+    LatencyMonitor::BeginFrame(received.receivedAt);
+    processFrame(received.frame);
+    LatencyMonitor::EndFrame();
+    ++m_framesProcessed;
+  }
+}
 
-  if (m_updateSettings) {
-    Config::SetAttribute("os_interaction_multi_monitor", m_useMultipleMonitors, true);
-    Config::SetAttribute("os_interaction_mode", static_cast<int>(m_desiredMode), true);
-    Config::Save();
-    m_updateSettings = false;
+void TouchlessListener::updateInteractionManager() {
+  if (m_modeChanged.exchange(false)) {
+    delete m_interactionManager;
+    m_osInteractionDriver->cancelGestureEvents();
+    m_interactionManager = Touchless::GestureInteractionManager::New(m_desiredMode, *m_osInteractionDriver, *m_overlayDriver);
+  }
+}
+
+void TouchlessListener::processFrame(const Leap::Frame& frame) {
+  updateInteractionManager();
+  if (m_resetLastFrame.exchange(false)) {
+    m_lastFrame = Leap::Frame();
   }
   if (m_interactionManager) {
+    // m_lastFrame is the last processed frame, so the motion since it includes any coalesced frames
     m_interactionManager->processFrame(frame, m_lastFrame);
   }
   m_lastFrame = frame;
 }
 
+void TouchlessListener::coalesceFrame(const Leap::Frame& frame) {
+  updateInteractionManager();
+  if (m_interactionManager) {
+    m_interactionManager->coalesceFrame(frame);
+  }
+}
+
 void TouchlessListener::onFocusGained(const Leap::Controller& leap) {
   updateDefaultScreen();
 }
 
 void TouchlessListener::onFocusLost(const Leap::Controller& leap) {
   m_osInteractionDriver->cancelGestureEvents();
-  m_lastFrame = Leap::Frame();
+  m_resetLastFrame = true;
 }
 
 Touchless::GestureInteractionMode TouchlessListener::getDesiredMode() const {
@@ -96,11 +214,9 @@ Touchless::GestureInteractionMode TouchlessListener::getDesiredMode() const {
 
 void TouchlessListener::setDesiredMode(Touchless::GestureInteractionMode mode) {
   m_desiredMode = mode;
-  m_updateSettings = true;
-
-  delete m_interactionManager;
-  m_osInteractionDriver->cancelGestureEvents();
-  m_interactionManager  = Touchless::GestureInteractionManager::New(m_desiredMode, *m_osInteractionDriver, *m_overlayDriver);
+  m_configPersister.SetAttribute("os_interaction_mode", static_cast<int>(mode));
+  // the interaction manager is owned by the processing thread, which recreates it before its next frame
+  m_modeChanged = true;
 }
 
 bool TouchlessListener::getUseMultipleMonitors() const {
@@ -109,7 +225,7 @@ bool TouchlessListener::getUseMultipleMonitors() const {
 
 void TouchlessListener::setUseMultipleMonitors(bool use) {
   m_useMultipleMonitors = use;
-  m_updateSettings = true;
+  m_configPersister.SetAttribute("os_interaction_multi_monitor", m_useMultipleMonitors);
   updateDefaultScreen();
 }
 
@@ -7,10 +7,15 @@
 #include "OSInteraction.h"
 #include "Overlay.h"
 #include "GestureInteractionManager.h"
+#include "AtomicBoundedQueue.h"
+#include "FrameTraceRecorder.h"
+#include "Heartbeat.h"
+#include "Configuration/ConfigPersister.h"
 
 #include <qobject.h>
 
 #include <boost/thread.hpp>
+#include ATOMIC_HEADER
 
 class TouchlessListener : public QObject, public Leap::Listener {
 
@@ -38,6 +43,12 @@ public:
 
   void setReady();
 
+  // frame handoff statistics, safe to read from any thread
+  uint64_t framesReceived() const { return m_framesReceived; }
+  uint64_t framesProcessed() const { return m_framesProcessed; }
+  uint64_t framesDropped() const { return m_framesDropped; }
+  uint64_t framesCoalesced() const { return m_framesCoalesced; }
+
 Q_SIGNALS:
 
   void connectChangedSignal(bool connected, int mode, bool useMultiMonitors);
@@ -45,9 +56,47 @@ Q_SIGNALS:
 private:
 
   void updateDefaultScreen();
+  void processingLoop();
+  void waitForFrame();
+  void processFrame(const Leap::Frame& frame);
+  void coalesceFrame(const Leap::Frame& frame);
+  void updateInteractionManager();
+
+  // a frame together with the monotonic time at which the callback received it (see LatencyMonitor)
+  struct ReceivedFrame {
+    Leap::Frame frame;
+    int64_t receivedAt;
+  };
+
+  // Frames are handed from the Leap callback thread to m_processingThread through this lock-free queue, so that
+  // slow gesture processing, overlay rasterization or event injection never stalls the SDK's frame delivery.
+  // The processing thread keeps the queue short by coalescing every frame which already has a newer one behind
+  // it, so it only fills while processing is stalled; the frames which arrive meanwhile are dropped.
+  typedef AtomicBoundedQueue<ReceivedFrame, 8> FrameQueue;
+
+  FrameQueue m_frameQueue;
+  boost::thread m_processingThread;
+  // The callback only takes m_frameMutex to wake the processing thread when m_processingIdle says it is waiting
+  // for a frame, and the processing thread only waits with the queue empty
+  boost::condition_variable m_frameAvailable;
+  boost::mutex m_frameMutex;
+  std::atomic<bool> m_processingIdle;
+  std::atomic<bool> m_stopProcessing;
+  std::atomic<bool> m_resetLastFrame;
+  std::atomic<bool> m_modeChanged;
+  std::atomic<uint64_t> m_framesReceived;
+  std::atomic<uint64_t> m_framesProcessed;
+  std::atomic<uint64_t> m_framesDropped;
+  std::atomic<uint64_t> m_framesCoalesced;
+  // when set, frames which are already stale by the time they are dequeued are coalesced instead of processed
+  bool m_coalesceFrames;
 
   Leap::Frame m_lastFrame;
-  bool m_updateSettings;
+  // records every frame delivered by the device when frame_trace_file is set, for offline replay
+  FrameTraceRecorder m_frameTraceRecorder;
+  ConfigPersister m_configPersister;
+  // periodically dumps the pipeline latency histograms when latency_dump_interval_ms is set
+  Heartbeat m_latencyDump;
   bool m_useMultipleMonitors;
   boost::condition_variable m_condVar;
   boost::mutex m_mutex;
@@ -56,7 +105,8 @@ private:
   LPVirtualScreen                       m_virtualScreen;
   Touchless::OSInteractionDriver       *m_osInteractionDriver;
   Touchless::OverlayDriver             *m_overlayDriver;
-  Touchless::GestureInteractionMode     m_desiredMode;
+  // set by the UI thread, and read by the processing thread when m_modeChanged tells it to recreate the manager
+  std::atomic<Touchless::GestureInteractionMode> m_desiredMode;
   Touchless::GestureInteractionManager *m_interactionManager;
 };
 
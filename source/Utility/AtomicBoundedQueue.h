@@ -0,0 +1,95 @@
+/*==================================================================================================================
+
+    Copyright (c) 2010 - 2014 Leap Motion. All rights reserved.
+
+  The intellectual and technical concepts contained herein are proprietary and confidential to Leap Motion, and are
+  protected by trade secret or copyright law. Dissemination of this information or reproduction of this material is
+  strictly forbidden unless prior written permission is obtained from Leap Motion.
+
+===================================================================================================================*/
+
+#ifndef __AtomicBoundedQueue_h__
+#define __AtomicBoundedQueue_h__
+
+#include <cstdlib>
+#include "common.h"
+#include ATOMIC_HEADER
+
+/// <summary>
+/// Lock-free single-producer/single-consumer queue with a maximum capacity
+/// </summary>
+/// <remarks>
+/// This is the same circular array as BoundedQueue, except that the front and back indices are atomic so that
+/// one thread may Enqueue while another thread Dequeues without taking a lock.  Exactly one thread may call the
+/// producer methods (Enqueue) and exactly one thread may call the consumer methods (Dequeue).
+/// Size and IsEmpty may be called from either side, but are only a snapshot.
+///
+/// The indices are free-running counters which are reduced modulo maxSize on access, so maxSize must be a power
+/// of two.
+///
+/// Maintainers: Raffi
+/// </remarks>
+
+template <class T, size_t maxSize>
+class AtomicBoundedQueue {
+
+public:
+
+  AtomicBoundedQueue() :
+    m_CurFront(0),
+    m_CurBack(0)
+  {
+    STATIC_ASSERT(maxSize > 0 && (maxSize & (maxSize - 1)) == 0, MaxSizeMustBeAPowerOfTwo);
+  }
+
+  /// <summary>
+  /// Producer side.  Returns false, leaving the queue untouched, if the queue is full.
+  /// </summary>
+  bool Enqueue(const T& data) {
+    const size_t back = m_CurBack.load(std::memory_order_relaxed);
+    if (back - m_CurFront.load(std::memory_order_acquire) == maxSize) {
+      return false;
+    }
+    m_Data[back % maxSize] = data;
+    m_CurBack.store(back + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// <summary>
+  /// Consumer side.  Returns false if the queue is empty.
+  /// </summary>
+  bool Dequeue(T& data) {
+    const size_t front = m_CurFront.load(std::memory_order_relaxed);
+    if (front == m_CurBack.load(std::memory_order_acquire)) {
+      return false;
+    }
+    data = m_Data[front % maxSize];
+    m_CurFront.store(front + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t Size() const {
+    return m_CurBack.load(std::memory_order_acquire) - m_CurFront.load(std::memory_order_acquire);
+  }
+
+  bool IsEmpty() const {
+    return Size() == 0;
+  }
+
+  size_t Capacity() const {
+    return maxSize;
+  }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+
+  // the indices are padded onto separate cache lines so the producer and consumer don't false-share
+  T                   m_Data[maxSize];
+  std::atomic<size_t> m_CurFront;
+  char                m_Padding[64];
+  std::atomic<size_t> m_CurBack;
+
+};
+
+#endif
@@ -17,13 +17,16 @@
 #include <vector>
 #include EXCEPTION_PTR_HEADER
 
-#include "FilterBase.h"
+#include "StaticFilter.h"
 
-template <typename Category_, unsigned int CATEGORY_COUNT>
+// Filter_ is a static filter (see StaticFilter.h) of dimension CATEGORY_COUNT, held by value.  Only its prediction
+// is read, so the default doesn't track a covariance.  Use PolymorphicFilter to supply a FilterBase chosen at runtime.
+template <typename Category_, unsigned int CATEGORY_COUNT, typename Filter_ = StaticCategoricalRollingMean<double,CATEGORY_COUNT> >
 class CategoricalFilter {
 public:
 
   typedef Category_ Category;
+  typedef Filter_ Filter;
   typedef std::vector<Category> CategoryVector;
   typedef Eigen::Matrix<double, CATEGORY_COUNT, 1> ProbabilityVector;
 
@@ -34,19 +37,16 @@ public:
 
   // the elements of categories must be unique
   CategoricalFilter (CategoryVector const &categories,
-                     FilterBase<CATEGORY_COUNT> *filter,
                      double uniformCategorizationThreshold,
-                     bool deleteFilterUponDestruction = true)
+                     Filter const &filter = Filter())
     :
     m_categories(categories),
     m_filter(filter),
-    m_deleteFilterUponDestruction(deleteFilterUponDestruction),
     m_uniformCategorizationThreshold(uniformCategorizationThreshold),
     m_valuesAreCached(false)
   {
     assert(CATEGORY_COUNT > 0);
     assert(m_categories.size() == CATEGORY_COUNT);
-    assert(m_filter != NULL);
     assert(0.0 < m_uniformCategorizationThreshold && m_uniformCategorizationThreshold <= 1.0);
 
     // generate the index map, checking that the elements of the category vector are unique
@@ -63,12 +63,6 @@ public:
     // put the filter into a neutral state -- completely ambiguous probabilities
     reset();
   }
-  ~CategoricalFilter ()
-  {
-    if (m_deleteFilterUponDestruction) {
-      delete m_filter;
-    }
-  }
 
   // general property accessors
 
@@ -76,12 +70,8 @@ public:
   const CategoryVector &categories () const { return m_categories; }
   // will throw if the category is not in the original category vector
   unsigned int indexOfCategory (const Category &c) const { return m_indexMap.at(c); }
-  FilterBase<CATEGORY_COUNT> const &getFilter () const { return *m_filter; }
-  FilterBase<CATEGORY_COUNT> &getFilter () { return *m_filter; }
-  template <typename FilterType>
-  FilterType const &getFilterAs () const { return *dynamic_cast<FilterType const *>(m_filter); }
-  template <typename FilterType>
-  FilterType &getFilterAs () { return *dynamic_cast<FilterType *>(m_filter); }
+  Filter const &getFilter () const { return m_filter; }
+  Filter &getFilter () { return m_filter; }
 
   // statistical property accessors
 
@@ -117,15 +107,15 @@ public:
   // add a measurement to the filter in the form of a normalized probability vector.
   void updateWithProbabilityVector (ProbabilityVector const &probVec, double weight = 1.0) {
     // TODO: check that probabilityVector is normalized?
-    m_filter->Update(1, probVec, UncertaintyMatrix::Zero(), weight);
+    m_filter.Update(1, probVec.template cast<typename Filter::Scalar>(), static_cast<typename Filter::Scalar>(weight));
     m_valuesAreCached = false;
   }
   // resets the filter and sets all probabilities to equal ("completely ambiguous")
   void reset () {
-    m_filter->Reset();
+    m_filter.Reset();
     // equal probability for all
-    m_filter->Update(1, ambiguousProbabilityVector(), UncertaintyMatrix::Zero(), 1.0);
-    assert(m_filter->Ready());
+    m_filter.Update(1, ambiguousProbabilityVector().template cast<typename Filter::Scalar>(), 1);
+    assert(m_filter.Ready());
     m_valuesAreCached = false;
   }
 
@@ -138,10 +128,10 @@ private:
       return;
     }
 
-    assert(m_filter->Ready());
+    assert(m_filter.Ready());
     m_valuesAreCached = true;
 
-    const ProbabilityVector &probabilities = m_filter->Predict(0);
+    const ProbabilityVector probabilities = m_filter.Predict(0).template cast<double>();
     double normalizationFactor = 0.0;
     for (unsigned int i = 0; i < CATEGORY_COUNT; ++i) {
       assert(0.0 <= probabilities(i));
@@ -180,15 +170,13 @@ private:
   }
 
   typedef std::map<Category,unsigned int> IndexMap;
-  typedef Eigen::Matrix<double, CATEGORY_COUNT, CATEGORY_COUNT> UncertaintyMatrix;
 
   CategoryVector              m_categories; // vector of unique categories
   IndexMap                    m_indexMap;   // given a category, produces its category vector index
 
   // TODO: filter on N-1 dimensions, using 1-sum(p_i) as the remaining value.  then
   // the normalizing constraint is always satisfied, and there is no wasted dimension.
-  FilterBase<CATEGORY_COUNT> *m_filter;
-  bool                        m_deleteFilterUponDestruction;
+  Filter                      m_filter;
   double                      m_uniformCategorizationThreshold;
 
   mutable bool                m_valuesAreCached;
@@ -0,0 +1,149 @@
+//ABOUT: Banks of independent filters, updated together.
+//A bank holds the state of Lanes filters of dimension Dim in structure-of-arrays
+//layout: each component of the state is an array across the lanes, so an Update
+//of every lane is a handful of whole-array expressions which Eigen vectorizes,
+//instead of one virtual call and a few scalar operations per filter.  Lanes
+//should be a multiple of the SIMD width (4 floats or 2 doubles) to avoid a
+//scalar tail.
+//
+//Update takes a measurement and a weight for every lane.  A lane with zero
+//weight is left exactly as it was, so lanes without a measurement this frame are
+//simply given zero weight.  ResetLane clears one lane, as when the object it
+//tracked disappears and another takes its place.
+//
+//FilterBankLanes assigns lanes to the ids of the tracked objects from frame to
+//frame.  Lane returns isNew for an id which was not present in the previous
+//frame, and the caller resets that lane before updating it.
+
+#ifndef FilterBank_h
+#define FilterBank_h
+
+#include "common.h"
+#include <Eigen/Core>
+
+//RollingMeanBank: A RollingMean (without the second moment) in each lane
+template <typename Scalar, int Lanes, int Dim>
+class RollingMeanBank {
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW //Ensure alignment when allocated from heap
+  typedef Eigen::Array<Scalar,Lanes,1> LaneArray;
+  typedef Eigen::Matrix<Scalar,Dim,1> StateVector;
+
+  RollingMeanBank() {
+    Sample = 1; //DEFAULT: No filtering
+    Reset();
+  };
+
+  //Ready: Returns true when the lane has sufficient data to make a prediction
+  bool Ready(int Lane) const {
+    return(1-Integral(Lane) <= Sample);
+  };
+  void Reset() {
+    Integral.setZero();
+    for (int d=0; d<Dim; d++) {
+      P1[d].setZero();
+    }
+  };
+  void ResetLane(int Lane) {
+    Integral(Lane) = 0;
+    for (int d=0; d<Dim; d++) {
+      P1[d](Lane) = 0;
+    }
+  };
+
+  StateVector Predict(int Lane) const {
+    StateVector mean;
+    for (int d=0; d<Dim; d++) {
+      mean(d) = Integral(Lane) > 0 ? P1[d](Lane)/Integral(Lane) : 0;
+    }
+    return(mean);
+  };
+
+  //Update: Meas_State[d] holds component d of every lane's measurement
+  void Update(const LaneArray (&Meas_State)[Dim], const LaneArray& Weight) {
+    const LaneArray Filter = Weight*Sample;
+    const LaneArray Keep = 1-Filter;
+    Integral = Filter + Keep*Integral;
+    for (int d=0; d<Dim; d++) {
+      P1[d] = Filter*Meas_State[d] + Keep*P1[d];
+    }
+  };
+
+  void SetWindow(double newWindow) {
+    if (1. <= newWindow) {
+      Sample = static_cast<Scalar>(1./newWindow);
+    }
+  };
+
+protected:
+  Scalar Sample;
+  LaneArray Integral;
+  LaneArray P1[Dim];
+};
+
+//FilterBankLanes: Assigns bank lanes to the ids of tracked objects
+template <int Lanes>
+class FilterBankLanes {
+public:
+  FilterBankLanes() {
+    Clear();
+  };
+
+  void Clear() {
+    for (int i=0; i<Lanes; i++) {
+      Used[i] = false;
+      Seen[i] = false;
+    }
+  };
+
+  //BeginFrame: Starts a frame; lanes whose id is not looked up again are released by EndFrame
+  void BeginFrame() {
+    for (int i=0; i<Lanes; i++) {
+      Seen[i] = false;
+    }
+  };
+  //Lane: The lane of the id, claiming a free one (and setting isNew) if it has
+  //none.  Returns -1 if every lane is taken.
+  int Lane(int64_t Id, bool& isNew) {
+    isNew = false;
+    int free = -1;
+    for (int i=0; i<Lanes; i++) {
+      if (Used[i] && Ids[i] == Id) {
+        Seen[i] = true;
+        return(i);
+      }
+      if (!Used[i] && free < 0) {
+        free = i;
+      }
+    }
+    if (free >= 0) {
+      Used[free] = true;
+      Seen[free] = true;
+      Ids[free] = Id;
+      isNew = true;
+    }
+    return(free);
+  };
+  void EndFrame() {
+    for (int i=0; i<Lanes; i++) {
+      Used[i] = Used[i] && Seen[i];
+    }
+  };
+
+  //Find: The lane of the id, or -1 if it has none
+  int Find(int64_t Id) const {
+    for (int i=0; i<Lanes; i++) {
+      if (Used[i] && Ids[i] == Id) {
+        return(i);
+      }
+    }
+    return(-1);
+  };
+
+protected:
+  int64_t Ids[Lanes];
+  bool Used[Lanes];
+  bool Seen[Lanes];
+};
+
+#endif
@@ -0,0 +1,256 @@
+#include "stdafx.h"
+#include "FrameModel.h"
+#include <algorithm>
+
+namespace FrameModel {
+
+Vector InteractionBox::normalizePoint(const Vector& position, bool clamp) const {
+  Vector result(
+    (position.x - m_center.x)/m_size.x + 0.5f,
+    (position.y - m_center.y)/m_size.y + 0.5f,
+    (position.z - m_center.z)/m_size.z + 0.5f
+  );
+  if (clamp) {
+    result.x = std::min(std::max(result.x, 0.0f), 1.0f);
+    result.y = std::min(std::max(result.y, 0.0f), 1.0f);
+    result.z = std::min(std::max(result.z, 0.0f), 1.0f);
+  }
+  return result;
+}
+
+Vector InteractionBox::denormalizePoint(const Vector& normalizedPosition) const {
+  return Vector(
+    (normalizedPosition.x - 0.5f)*m_size.x + m_center.x,
+    (normalizedPosition.y - 0.5f)*m_size.y + m_center.y,
+    (normalizedPosition.z - 0.5f)*m_size.z + m_center.z
+  );
+}
+
+HandData* FrameData::addHand() {
+  if (handCount >= MAX_FRAME_HANDS) {
+    return nullptr;
+  }
+  return &hands[handCount++];
+}
+
+PointableData* FrameData::addPointable() {
+  if (pointableCount >= MAX_FRAME_POINTABLES) {
+    return nullptr;
+  }
+  return &pointables[pointableCount++];
+}
+
+Frame Pointable::frame() const {
+  return isValid() ? Frame(m_frame) : Frame();
+}
+
+Hand Pointable::hand() const {
+  if (isValid()) {
+    const int32_t handId = data().handId;
+    for (int i = 0; i < m_frame->handCount; i++) {
+      if (m_frame->hands[i].id == handId) {
+        return Hand(m_frame, i);
+      }
+    }
+  }
+  return Hand();
+}
+
+const Pointable& Pointable::invalid() {
+  static const Pointable s_invalid;
+  return s_invalid;
+}
+
+Frame Hand::frame() const {
+  return isValid() ? Frame(m_frame) : Frame();
+}
+
+PointableList Hand::pointables() const {
+  PointableList list(m_frame);
+  if (isValid()) {
+    const int32_t handId = data().id;
+    for (int i = 0; i < m_frame->pointableCount; i++) {
+      if (m_frame->pointables[i].handId == handId) {
+        list.append(i);
+      }
+    }
+  }
+  return list;
+}
+
+Pointable Hand::pointable(int32_t id) const {
+  if (isValid()) {
+    for (int i = 0; i < m_frame->pointableCount; i++) {
+      if (m_frame->pointables[i].id == id && m_frame->pointables[i].handId == data().id) {
+        return Pointable(m_frame, i);
+      }
+    }
+  }
+  return Pointable();
+}
+
+const Hand& Hand::invalid() {
+  static const Hand s_invalid;
+  return s_invalid;
+}
+
+PointableList Frame::pointables() const {
+  PointableList list(m_data);
+  if (m_data) {
+    for (int i = 0; i < m_data->pointableCount; i++) {
+      list.append(i);
+    }
+  }
+  return list;
+}
+
+Hand Frame::hand(int32_t id) const {
+  if (m_data) {
+    for (int i = 0; i < m_data->handCount; i++) {
+      if (m_data->hands[i].id == id) {
+        return Hand(m_data, i);
+      }
+    }
+  }
+  return Hand();
+}
+
+Pointable Frame::pointable(int32_t id) const {
+  if (m_data) {
+    for (int i = 0; i < m_data->pointableCount; i++) {
+      if (m_data->pointables[i].id == id) {
+        return Pointable(m_data, i);
+      }
+    }
+  }
+  return Pointable();
+}
+
+const Frame& Frame::invalid() {
+  static const Frame s_invalid;
+  return s_invalid;
+}
+
+FrameMotion MotionBetween(const FrameData& current, const FrameData& since, const Vector& axis) {
+  FrameMotion motion;
+
+  // Pair up the palms and tips which appear in both frames
+  Vector now[MAX_FRAME_HANDS + MAX_FRAME_POINTABLES];
+  Vector then[MAX_FRAME_HANDS + MAX_FRAME_POINTABLES];
+  int count = 0;
+  for (int i = 0; i < current.handCount; i++) {
+    for (int j = 0; j < since.handCount; j++) {
+      if (current.hands[i].id == since.hands[j].id) {
+        now[count] = current.hands[i].palmPosition;
+        then[count] = since.hands[j].palmPosition;
+        count++;
+        break;
+      }
+    }
+  }
+  for (int i = 0; i < current.pointableCount; i++) {
+    for (int j = 0; j < since.pointableCount; j++) {
+      if (current.pointables[i].id == since.pointables[j].id) {
+        now[count] = current.pointables[i].tipPosition;
+        then[count] = since.pointables[j].tipPosition;
+        count++;
+        break;
+      }
+    }
+  }
+  motion.matched = count;
+  if (count == 0) {
+    return motion;
+  }
+
+  Vector nowCentroid, thenCentroid;
+  for (int i = 0; i < count; i++) {
+    nowCentroid += now[i];
+    thenCentroid += then[i];
+  }
+  nowCentroid /= static_cast<float>(count);
+  thenCentroid /= static_cast<float>(count);
+  motion.translation = nowCentroid - thenCentroid;
+
+  // The rotation is the angle of the summed cross and dot products of the centroid-relative offsets, projected
+  // onto the plane normal to the axis, which weights each point by its distance from the centroid.
+  const Vector unitAxis = axis.normalized();
+  float sinSum = 0;
+  float cosSum = 0;
+  float nowSpread = 0;
+  float thenSpread = 0;
+  for (int i = 0; i < count; i++) {
+    const Vector nowOffset = now[i] - nowCentroid;
+    const Vector thenOffset = then[i] - thenCentroid;
+    const Vector nowProjected = nowOffset - unitAxis*unitAxis.dot(nowOffset);
+    const Vector thenProjected = thenOffset - unitAxis*unitAxis.dot(thenOffset);
+    sinSum += unitAxis.dot(thenProjected.cross(nowProjected));
+    cosSum += thenProjected.dot(nowProjected);
+    nowSpread += nowOffset.magnitude();
+    thenSpread += thenOffset.magnitude();
+  }
+  nowSpread /= static_cast<float>(count);
+  thenSpread /= static_cast<float>(count);
+  if (sinSum != 0 || cosSum != 0) {
+    motion.rotationAngle = std::atan2(sinSum, cosSum);
+  }
+  if (thenSpread > 0) {
+    motion.scaleFactor = nowSpread/thenSpread;
+  }
+  motion.spread = 0.5f*(nowSpread + thenSpread);
+  return motion;
+}
+
+void FrameMotion::probabilities(float& rotationProbability, float& translationProbability, float& scaleProbability) const {
+  const double translationDistance = translation.magnitude();
+  const double rotationDistance = std::abs(rotationAngle)*spread;
+  const double scaleDistance = std::abs(scaleFactor - 1)*spread;
+  const double total = translationDistance + rotationDistance + scaleDistance;
+  if (matched == 0 || total <= 0) {
+    rotationProbability = translationProbability = scaleProbability = 0;
+    return;
+  }
+  rotationProbability = static_cast<float>(rotationDistance/total);
+  translationProbability = static_cast<float>(translationDistance/total);
+  scaleProbability = static_cast<float>(scaleDistance/total);
+}
+
+FrameMotion Frame::motionSince(const Frame& sinceFrame, const Vector& axis) const {
+  if (!m_data || !sinceFrame.m_data) {
+    return FrameMotion();
+  }
+  return MotionBetween(*m_data, *sinceFrame.m_data, axis);
+}
+
+Vector Frame::translation(const Frame& sinceFrame) const {
+  return motionSince(sinceFrame, Vector::zAxis()).translation;
+}
+
+float Frame::rotationAngle(const Frame& sinceFrame, const Vector& axis) const {
+  return motionSince(sinceFrame, axis).rotationAngle;
+}
+
+float Frame::scaleFactor(const Frame& sinceFrame) const {
+  return motionSince(sinceFrame, Vector::zAxis()).scaleFactor;
+}
+
+float Frame::translationProbability(const Frame& sinceFrame) const {
+  // Rotation is measured in the screen plane, which is the only one the interaction modes use
+  float rotation, translation, scale;
+  motionSince(sinceFrame, Vector::zAxis()).probabilities(rotation, translation, scale);
+  return translation;
+}
+
+float Frame::rotationProbability(const Frame& sinceFrame) const {
+  float rotation, translation, scale;
+  motionSince(sinceFrame, Vector::zAxis()).probabilities(rotation, translation, scale);
+  return rotation;
+}
+
+float Frame::scaleProbability(const Frame& sinceFrame) const {
+  float rotation, translation, scale;
+  motionSince(sinceFrame, Vector::zAxis()).probabilities(rotation, translation, scale);
+  return scale;
+}
+
+}
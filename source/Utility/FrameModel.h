@@ -0,0 +1,379 @@
+#if !defined(__FrameModel_h__)
+#define __FrameModel_h__
+#include "common.h"
+#include <cmath>
+#include SHARED_PTR_HEADER
+
+/// <summary>
+/// Lightweight value model of the Leap frame/pointable/hand types
+/// </summary>
+/// <remarks>
+/// These classes mirror the subset of the Leap SDK interface which the interaction code consumes, but are plain
+/// C++ with no dependency on the SDK or on a device.  A frame is an immutable FrameData block shared between the
+/// Frame, Hand, Pointable and list handles which refer into it, so copying any of them is as cheap as it is with
+/// the SDK types.
+///
+/// Headless builds (TOUCHLESS_HEADLESS, see FrameTypes.h) substitute these types for the SDK ones so that the
+/// interaction modes may be driven from a FrameSource.
+///
+/// Quantities which the SDK derives internally (translation, rotation, scale and their probabilities) are
+/// approximated from the hands and pointables present in both frames.
+/// </remarks>
+namespace FrameModel {
+
+static const float PI          = 3.1415926536f;
+static const float DEG_TO_RAD  = 0.0174532925f;
+static const float RAD_TO_DEG  = 57.295779513f;
+
+/// <summary>
+/// Maximum number of hands and pointables which may be stored in a single frame
+/// </summary>
+static const int MAX_FRAME_HANDS      = 4;
+static const int MAX_FRAME_POINTABLES = 20;
+
+struct Vector {
+  Vector() : x(0), y(0), z(0) {}
+  Vector(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+
+  float x;
+  float y;
+  float z;
+
+  static Vector zero()  { return Vector(0, 0, 0); }
+  static Vector xAxis() { return Vector(1, 0, 0); }
+  static Vector yAxis() { return Vector(0, 1, 0); }
+  static Vector zAxis() { return Vector(0, 0, 1); }
+
+  float magnitude() const { return std::sqrt(magnitudeSquared()); }
+  float magnitudeSquared() const { return x*x + y*y + z*z; }
+  float distanceTo(const Vector& other) const { return (*this - other).magnitude(); }
+  float dot(const Vector& other) const { return x*other.x + y*other.y + z*other.z; }
+  Vector cross(const Vector& other) const {
+    return Vector(y*other.z - z*other.y, z*other.x - x*other.z, x*other.y - y*other.x);
+  }
+  Vector normalized() const {
+    const float norm = magnitude();
+    return norm > 0 ? *this / norm : Vector();
+  }
+  float angleTo(const Vector& other) const {
+    const float denom = magnitudeSquared() * other.magnitudeSquared();
+    if (denom <= 0) {
+      return 0;
+    }
+    const float cosine = dot(other) / std::sqrt(denom);
+    return std::acos(cosine > 1 ? 1 : (cosine < -1 ? -1 : cosine));
+  }
+
+  Vector operator+(const Vector& other) const { return Vector(x + other.x, y + other.y, z + other.z); }
+  Vector operator-(const Vector& other) const { return Vector(x - other.x, y - other.y, z - other.z); }
+  Vector operator-() const { return Vector(-x, -y, -z); }
+  Vector operator*(float scalar) const { return Vector(x*scalar, y*scalar, z*scalar); }
+  Vector operator/(float scalar) const { return Vector(x/scalar, y/scalar, z/scalar); }
+  Vector& operator+=(const Vector& other) { x += other.x; y += other.y; z += other.z; return *this; }
+  Vector& operator-=(const Vector& other) { x -= other.x; y -= other.y; z -= other.z; return *this; }
+  Vector& operator*=(float scalar) { x *= scalar; y *= scalar; z *= scalar; return *this; }
+  Vector& operator/=(float scalar) { x /= scalar; y /= scalar; z /= scalar; return *this; }
+  bool operator==(const Vector& other) const { return x == other.x && y == other.y && z == other.z; }
+  bool operator!=(const Vector& other) const { return !(*this == other); }
+  float operator[](unsigned int index) const { return (&x)[index]; }
+
+  template<class Vector3Type>
+  Vector3Type toVector3() const { return Vector3Type(x, y, z); }
+};
+
+inline Vector operator*(float scalar, const Vector& vector) { return vector*scalar; }
+
+class InteractionBox {
+public:
+  InteractionBox() : m_center(0, 200, 0), m_size(200, 200, 200), m_isValid(false) {}
+  InteractionBox(const Vector& center, const Vector& size) : m_center(center), m_size(size), m_isValid(true) {}
+
+  /// <summary>
+  /// Maps a point inside the box onto [0, 1] along each axis, optionally clamping points outside of it
+  /// </summary>
+  Vector normalizePoint(const Vector& position, bool clamp = true) const;
+  Vector denormalizePoint(const Vector& normalizedPosition) const;
+
+  Vector center() const { return m_center; }
+  float width() const { return m_size.x; }
+  float height() const { return m_size.y; }
+  float depth() const { return m_size.z; }
+  bool isValid() const { return m_isValid; }
+
+private:
+  Vector m_center;
+  Vector m_size;
+  bool   m_isValid;
+};
+
+struct PointableData {
+  int32_t id;
+  int32_t handId;                 // -1 if the pointable is not attached to a hand
+  Vector  tipPosition;            // millimeters
+  Vector  stabilizedTipPosition;
+  Vector  tipVelocity;            // millimeters per second
+  Vector  direction;              // unit vector
+  float   length;                 // millimeters
+  float   width;
+  float   touchDistance;          // +1 .. -1, see Leap::Pointable::touchDistance
+  int32_t touchZone;              // Pointable::Zone
+  float   timeVisible;            // seconds
+  bool    isTool;
+};
+
+struct HandData {
+  int32_t id;
+  Vector  palmPosition;
+  Vector  stabilizedPalmPosition;
+  Vector  palmVelocity;
+  Vector  palmNormal;
+  Vector  direction;
+  float   timeVisible;
+};
+
+/// <summary>
+/// Plain storage for a single frame
+/// </summary>
+/// <remarks>
+/// Fixed capacity so that a FrameData may be filled in place, copied with memcpy and recycled.
+/// </remarks>
+struct FrameData {
+  FrameData() : id(0), timestamp(0), handCount(0), pointableCount(0) {}
+
+  int64_t        id;
+  int64_t        timestamp;       // microseconds
+  InteractionBox interactionBox;
+  int32_t        handCount;
+  int32_t        pointableCount;
+  HandData       hands[MAX_FRAME_HANDS];
+  PointableData  pointables[MAX_FRAME_POINTABLES];
+
+  /// <summary>
+  /// Appends an entry, returning nullptr if the frame is already full
+  /// </summary>
+  HandData* addHand();
+  PointableData* addPointable();
+};
+
+/// <summary>
+/// Motion of the tracked points between two frames
+/// </summary>
+/// <remarks>
+/// Hands and pointables which are present in both frames are matched by id, and the motion of the matched
+/// points is decomposed into the translation of their centroid, the rotation about the given axis through it,
+/// and the change in their spread about it.  Each probability is the share of the total displacement (in
+/// millimeters) explained by that kind of motion, so the three sum to one, or are all zero if nothing could be
+/// matched or nothing moved.
+/// </remarks>
+struct FrameMotion {
+  FrameMotion() : rotationAngle(0), scaleFactor(1), spread(0), matched(0) {}
+
+  Vector translation;
+  float  rotationAngle;
+  float  scaleFactor;
+  float  spread;                  // mean distance of the matched points from their centroid
+  int    matched;
+
+  void probabilities(float& rotationProbability, float& translationProbability, float& scaleProbability) const;
+};
+
+FrameMotion MotionBetween(const FrameData& current, const FrameData& since, const Vector& axis = Vector::zAxis());
+
+class Frame;
+class Hand;
+class PointableList;
+
+class Pointable {
+public:
+  // in the same order as Leap::Pointable::Zone
+  enum Zone { ZONE_NONE = 0, ZONE_HOVERING = 1, ZONE_TOUCHING = 2 };
+
+  Pointable() : m_index(-1) {}
+  Pointable(const std::shared_ptr<const FrameData>& frame, int index) : m_frame(frame), m_index(index) {}
+
+  bool isValid() const { return m_index >= 0; }
+  int32_t id() const { return isValid() ? data().id : -1; }
+  Frame frame() const;
+  Hand hand() const;
+  Vector tipPosition() const { return isValid() ? data().tipPosition : Vector(); }
+  Vector stabilizedTipPosition() const { return isValid() ? data().stabilizedTipPosition : Vector(); }
+  Vector tipVelocity() const { return isValid() ? data().tipVelocity : Vector(); }
+  Vector direction() const { return isValid() ? data().direction : Vector(); }
+  float length() const { return isValid() ? data().length : 0; }
+  float width() const { return isValid() ? data().width : 0; }
+  float touchDistance() const { return isValid() ? data().touchDistance : 0; }
+  Zone touchZone() const { return isValid() ? static_cast<Zone>(data().touchZone) : ZONE_NONE; }
+  float timeVisible() const { return isValid() ? data().timeVisible : 0; }
+  bool isTool() const { return isValid() && data().isTool; }
+  bool isFinger() const { return isValid() && !data().isTool; }
+
+  bool operator==(const Pointable& other) const { return m_frame == other.m_frame && m_index == other.m_index; }
+  bool operator!=(const Pointable& other) const { return !(*this == other); }
+
+  static const Pointable& invalid();
+
+private:
+  const PointableData& data() const { return m_frame->pointables[m_index]; }
+
+  std::shared_ptr<const FrameData> m_frame;
+  int                              m_index;
+};
+
+/// <summary>
+/// A selection of pointables from a single frame
+/// </summary>
+class PointableList {
+public:
+  PointableList() : m_count(0) {}
+  explicit PointableList(const std::shared_ptr<const FrameData>& frame) : m_frame(frame), m_count(0) {}
+
+  int count() const { return m_count; }
+  bool isEmpty() const { return m_count == 0; }
+  Pointable operator[](int i) const { return Pointable(m_frame, m_indices[i]); }
+
+  void append(int index) { m_indices[m_count++] = static_cast<int8_t>(index); }
+
+private:
+  std::shared_ptr<const FrameData> m_frame;
+  int                              m_count;
+  int8_t                           m_indices[MAX_FRAME_POINTABLES];
+};
+
+class Hand {
+public:
+  Hand() : m_index(-1) {}
+  Hand(const std::shared_ptr<const FrameData>& frame, int index) : m_frame(frame), m_index(index) {}
+
+  bool isValid() const { return m_index >= 0; }
+  int32_t id() const { return isValid() ? data().id : -1; }
+  Frame frame() const;
+  PointableList pointables() const;
+  Pointable pointable(int32_t id) const;
+  Vector palmPosition() const { return isValid() ? data().palmPosition : Vector(); }
+  Vector stabilizedPalmPosition() const { return isValid() ? data().stabilizedPalmPosition : Vector(); }
+  Vector palmVelocity() const { return isValid() ? data().palmVelocity : Vector(); }
+  Vector palmNormal() const { return isValid() ? data().palmNormal : Vector(); }
+  Vector direction() const { return isValid() ? data().direction : Vector(); }
+  float timeVisible() const { return isValid() ? data().timeVisible : 0; }
+
+  bool operator==(const Hand& other) const { return m_frame == other.m_frame && m_index == other.m_index; }
+  bool operator!=(const Hand& other) const { return !(*this == other); }
+
+  static const Hand& invalid();
+
+private:
+  const HandData& data() const { return m_frame->hands[m_index]; }
+
+  std::shared_ptr<const FrameData> m_frame;
+  int                              m_index;
+};
+
+class HandList {
+public:
+  HandList() {}
+  explicit HandList(const std::shared_ptr<const FrameData>& frame) : m_frame(frame) {}
+
+  int count() const { return m_frame ? m_frame->handCount : 0; }
+  bool isEmpty() const { return count() == 0; }
+  Hand operator[](int i) const { return Hand(m_frame, i); }
+
+private:
+  std::shared_ptr<const FrameData> m_frame;
+};
+
+class Frame {
+public:
+  Frame() {}
+  explicit Frame(const std::shared_ptr<const FrameData>& data) : m_data(data) {}
+
+  bool isValid() const { return static_cast<bool>(m_data); }
+  int64_t id() const { return m_data ? m_data->id : -1; }
+  int64_t timestamp() const { return m_data ? m_data->timestamp : 0; }
+  InteractionBox interactionBox() const { return m_data ? m_data->interactionBox : InteractionBox(); }
+
+  HandList hands() const { return HandList(m_data); }
+  PointableList pointables() const;
+  Hand hand(int32_t id) const;
+  Pointable pointable(int32_t id) const;
+
+  /// <summary>
+  /// Motion of the tracked points between sinceFrame and this one, as estimated by MotionBetween
+  /// </summary>
+  Vector translation(const Frame& sinceFrame) const;
+  float rotationAngle(const Frame& sinceFrame, const Vector& axis) const;
+  float scaleFactor(const Frame& sinceFrame) const;
+  float translationProbability(const Frame& sinceFrame) const;
+  float rotationProbability(const Frame& sinceFrame) const;
+  float scaleProbability(const Frame& sinceFrame) const;
+
+  /// <summary>
+  /// The storage backing this frame, or nullptr if it is invalid
+  /// </summary>
+  const FrameData* data() const { return m_data.get(); }
+
+  bool operator==(const Frame& other) const { return m_data == other.m_data; }
+  bool operator!=(const Frame& other) const { return !(*this == other); }
+
+  static const Frame& invalid();
+
+private:
+  FrameMotion motionSince(const Frame& sinceFrame, const Vector& axis) const;
+
+  std::shared_ptr<const FrameData> m_data;
+};
+
+template<class VectorType>
+Vector ToVector(const VectorType& vector) {
+  return Vector(vector.x, vector.y, vector.z);
+}
+
+/// <summary>
+/// Copies a frame with the Leap interface (the SDK's, or this model's) into a FrameData
+/// </summary>
+/// <remarks>
+/// Hands and pointables beyond the capacity of FrameData are dropped.  No allocation is performed.
+/// </remarks>
+template<class FrameType>
+void CaptureFrame(const FrameType& frame, FrameData& data) {
+  data.id = frame.id();
+  data.timestamp = frame.timestamp();
+  const auto box = frame.interactionBox();
+  data.interactionBox = box.isValid() ? InteractionBox(ToVector(box.center()), Vector(box.width(), box.height(), box.depth()))
+                                      : InteractionBox();
+  data.handCount = 0;
+  const auto hands = frame.hands();
+  for (int i = 0; i < hands.count() && data.handCount < MAX_FRAME_HANDS; i++) {
+    const auto hand = hands[i];
+    HandData& handData = data.hands[data.handCount++];
+    handData.id = hand.id();
+    handData.palmPosition = ToVector(hand.palmPosition());
+    handData.stabilizedPalmPosition = ToVector(hand.stabilizedPalmPosition());
+    handData.palmVelocity = ToVector(hand.palmVelocity());
+    handData.palmNormal = ToVector(hand.palmNormal());
+    handData.direction = ToVector(hand.direction());
+    handData.timeVisible = hand.timeVisible();
+  }
+  data.pointableCount = 0;
+  const auto pointables = frame.pointables();
+  for (int i = 0; i < pointables.count() && data.pointableCount < MAX_FRAME_POINTABLES; i++) {
+    const auto pointable = pointables[i];
+    const auto hand = pointable.hand();
+    PointableData& pointableData = data.pointables[data.pointableCount++];
+    pointableData.id = pointable.id();
+    pointableData.handId = hand.isValid() ? hand.id() : -1;
+    pointableData.tipPosition = ToVector(pointable.tipPosition());
+    pointableData.stabilizedTipPosition = ToVector(pointable.stabilizedTipPosition());
+    pointableData.tipVelocity = ToVector(pointable.tipVelocity());
+    pointableData.direction = ToVector(pointable.direction());
+    pointableData.length = pointable.length();
+    pointableData.width = pointable.width();
+    pointableData.touchDistance = pointable.touchDistance();
+    pointableData.touchZone = static_cast<int32_t>(pointable.touchZone());
+    pointableData.timeVisible = pointable.timeVisible();
+    pointableData.isTool = pointable.isTool();
+  }
+}
+
+}
+
+#endif // __FrameModel_h__
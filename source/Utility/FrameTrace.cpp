@@ -0,0 +1,315 @@
+#include "stdafx.h"
+#include "FrameTrace.h"
+#include <algorithm>
+#include <cstring>
+#include <boost/filesystem.hpp>
+
+namespace FrameTrace {
+using FrameModel::Vector;
+using FrameModel::FrameData;
+using FrameModel::HandData;
+using FrameModel::PointableData;
+
+static void store(float* out, const Vector& vector) {
+  out[0] = vector.x;
+  out[1] = vector.y;
+  out[2] = vector.z;
+}
+
+static Vector load(const float* in) {
+  return Vector(in[0], in[1], in[2]);
+}
+
+Writer::Writer() :
+  m_file(nullptr)
+{
+  m_buffer.resize(sizeof(FrameRecord) + FrameModel::MAX_FRAME_HANDS*sizeof(HandRecord) +
+                  FrameModel::MAX_FRAME_POINTABLES*sizeof(PointableRecord));
+}
+
+Writer::~Writer() {
+  Close();
+}
+
+// The length of the trace up to the end of its last complete record, walking the records with the same checks
+// as Reader::recordAt
+static uint64_t CompleteLength(std::FILE* file, const FileHeader& header, uint64_t fileSize) {
+  uint64_t position = header.headerSize;
+  if (std::fseek(file, header.headerSize, SEEK_SET) != 0) {
+    return position;
+  }
+  FrameRecord record;
+  while (fileSize - position >= header.frameRecordSize && std::fread(&record, sizeof(FrameRecord), 1, file) == 1) {
+    const uint64_t minimumSize = header.frameRecordSize + record.handCount*header.handRecordSize +
+                                 record.pointableCount*header.pointableRecordSize;
+    if (record.size < minimumSize || record.size > fileSize - position) {
+      break;
+    }
+    position += record.size;
+    if (std::fseek(file, static_cast<long>(record.size - sizeof(FrameRecord)), SEEK_CUR) != 0) {
+      break;
+    }
+  }
+  return position;
+}
+
+bool Writer::Open(const std::string& fileName) {
+  Close();
+  boost::system::error_code error;
+  const uint64_t fileSize = boost::filesystem::file_size(fileName, error);
+  const bool existing = !error && fileSize > 0;
+  if (existing) {
+    // Appending to an existing trace, which must have the same layout as the records we write
+    std::FILE* file = std::fopen(fileName.c_str(), "rb");
+    if (!file) {
+      return false;
+    }
+    FileHeader header;
+    const bool compatible = std::fread(&header, sizeof(header), 1, file) == 1
+                         && std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+                         && header.version == VERSION
+                         && header.headerSize == sizeof(FileHeader)
+                         && header.frameRecordSize == sizeof(FrameRecord)
+                         && header.handRecordSize == sizeof(HandRecord)
+                         && header.pointableRecordSize == sizeof(PointableRecord);
+    const uint64_t length = compatible ? CompleteLength(file, header, fileSize) : 0;
+    std::fclose(file);
+    if (!compatible) {
+      return false;
+    }
+
+    // A session which crashed mid-record leaves a partial record at the end, whose size would swallow the first
+    // record appended after it, so the trace is cut back to its last complete record
+    if (length < fileSize) {
+      boost::filesystem::resize_file(fileName, length, error);
+      if (error) {
+        return false;
+      }
+    }
+  }
+
+  m_file = std::fopen(fileName.c_str(), "ab");
+  if (!m_file) {
+    return false;
+  }
+  if (existing) {
+    return true;
+  }
+
+  FileHeader header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.headerSize = sizeof(FileHeader);
+  header.frameRecordSize = sizeof(FrameRecord);
+  header.handRecordSize = sizeof(HandRecord);
+  header.pointableRecordSize = sizeof(PointableRecord);
+  header.reserved = 0;
+  if (std::fwrite(&header, sizeof(header), 1, m_file) != 1) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void Writer::Close() {
+  if (m_file) {
+    std::fclose(m_file);
+    m_file = nullptr;
+  }
+}
+
+bool Writer::Write(const FrameData& frame) {
+  if (!m_file) {
+    return false;
+  }
+  const int handCount = std::min(std::max(frame.handCount, 0), FrameModel::MAX_FRAME_HANDS);
+  const int pointableCount = std::min(std::max(frame.pointableCount, 0), FrameModel::MAX_FRAME_POINTABLES);
+  char* out = &m_buffer[0];
+
+  FrameRecord* frameRecord = reinterpret_cast<FrameRecord*>(out);
+  std::memset(frameRecord, 0, sizeof(FrameRecord));
+  frameRecord->size = static_cast<uint32_t>(sizeof(FrameRecord) + handCount*sizeof(HandRecord) + pointableCount*sizeof(PointableRecord));
+  frameRecord->handCount = static_cast<uint8_t>(handCount);
+  frameRecord->pointableCount = static_cast<uint8_t>(pointableCount);
+  frameRecord->id = frame.id;
+  frameRecord->timestamp = frame.timestamp;
+  if (frame.interactionBox.isValid()) {
+    store(frameRecord->boxCenter, frame.interactionBox.center());
+    store(frameRecord->boxSize, Vector(frame.interactionBox.width(), frame.interactionBox.height(), frame.interactionBox.depth()));
+  }
+  out += sizeof(FrameRecord);
+
+  for (int i = 0; i < handCount; i++, out += sizeof(HandRecord)) {
+    const HandData& hand = frame.hands[i];
+    HandRecord* record = reinterpret_cast<HandRecord*>(out);
+    record->id = hand.id;
+    store(record->palmPosition, hand.palmPosition);
+    store(record->stabilizedPalmPosition, hand.stabilizedPalmPosition);
+    store(record->palmVelocity, hand.palmVelocity);
+    store(record->palmNormal, hand.palmNormal);
+    store(record->direction, hand.direction);
+    record->timeVisible = hand.timeVisible;
+  }
+
+  for (int i = 0; i < pointableCount; i++, out += sizeof(PointableRecord)) {
+    const PointableData& pointable = frame.pointables[i];
+    PointableRecord* record = reinterpret_cast<PointableRecord*>(out);
+    record->id = pointable.id;
+    record->handId = pointable.handId;
+    store(record->tipPosition, pointable.tipPosition);
+    store(record->stabilizedTipPosition, pointable.stabilizedTipPosition);
+    store(record->tipVelocity, pointable.tipVelocity);
+    store(record->direction, pointable.direction);
+    record->length = pointable.length;
+    record->width = pointable.width;
+    record->touchDistance = pointable.touchDistance;
+    record->timeVisible = pointable.timeVisible;
+    record->touchZone = static_cast<uint8_t>(pointable.touchZone);
+    record->isTool = pointable.isTool ? 1 : 0;
+    record->reserved = 0;
+  }
+
+  return std::fwrite(&m_buffer[0], frameRecord->size, 1, m_file) == 1;
+}
+
+void Writer::Flush() {
+  if (m_file) {
+    std::fflush(m_file);
+  }
+}
+
+Reader::Reader() :
+  m_begin(nullptr),
+  m_end(nullptr),
+  m_position(nullptr)
+{
+  std::memset(&m_header, 0, sizeof(m_header));
+}
+
+bool Reader::Open(const std::string& fileName) {
+  Close();
+  try {
+    boost::interprocess::file_mapping mapping(fileName.c_str(), boost::interprocess::read_only);
+    boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+    m_mapping.swap(mapping);
+    m_region.swap(region);
+  } catch (const boost::interprocess::interprocess_exception&) {
+    return false;
+  }
+
+  const char* begin = static_cast<const char*>(m_region.get_address());
+  const char* end = begin + m_region.get_size();
+  if (static_cast<size_t>(end - begin) < sizeof(FileHeader)) {
+    Close();
+    return false;
+  }
+  std::memcpy(&m_header, begin, sizeof(FileHeader));
+  const bool understood = std::memcmp(m_header.magic, MAGIC, sizeof(MAGIC)) == 0
+                       && m_header.version >= 1
+                       && m_header.headerSize >= sizeof(FileHeader)
+                       && m_header.frameRecordSize >= sizeof(FrameRecord)
+                       && m_header.handRecordSize >= sizeof(HandRecord)
+                       && m_header.pointableRecordSize >= sizeof(PointableRecord)
+                       && static_cast<size_t>(end - begin) >= m_header.headerSize;
+  if (!understood) {
+    Close();
+    return false;
+  }
+  m_begin = begin + m_header.headerSize;
+  m_end = end;
+  m_position = m_begin;
+  return true;
+}
+
+void Reader::Close() {
+  boost::interprocess::mapped_region().swap(m_region);
+  boost::interprocess::file_mapping().swap(m_mapping);
+  m_begin = m_end = m_position = nullptr;
+}
+
+void Reader::Rewind() {
+  m_position = m_begin;
+}
+
+const char* Reader::recordAt(const char* position) const {
+  // Returns the end of the complete record at position, or nullptr if there is none
+  if (!position || static_cast<size_t>(m_end - position) < m_header.frameRecordSize) {
+    return nullptr;
+  }
+  FrameRecord record;
+  std::memcpy(&record, position, sizeof(FrameRecord));
+  const size_t minimumSize = m_header.frameRecordSize + record.handCount*m_header.handRecordSize +
+                             record.pointableCount*m_header.pointableRecordSize;
+  if (record.size < minimumSize || record.size > static_cast<size_t>(m_end - position)) {
+    return nullptr;
+  }
+  return position + record.size;
+}
+
+bool Reader::Next(FrameData& frame) {
+  const char* next = recordAt(m_position);
+  if (!next) {
+    return false;
+  }
+  FrameRecord frameRecord;
+  std::memcpy(&frameRecord, m_position, sizeof(FrameRecord));
+  const char* in = m_position + m_header.frameRecordSize;
+
+  frame.id = frameRecord.id;
+  frame.timestamp = frameRecord.timestamp;
+  const Vector boxSize = load(frameRecord.boxSize);
+  frame.interactionBox = boxSize.magnitudeSquared() > 0 ? FrameModel::InteractionBox(load(frameRecord.boxCenter), boxSize)
+                                                        : FrameModel::InteractionBox();
+
+  frame.handCount = std::min(static_cast<int>(frameRecord.handCount), FrameModel::MAX_FRAME_HANDS);
+  for (int i = 0; i < frameRecord.handCount; i++, in += m_header.handRecordSize) {
+    if (i >= frame.handCount) {
+      continue;
+    }
+    HandRecord record;
+    std::memcpy(&record, in, sizeof(HandRecord));
+    HandData& hand = frame.hands[i];
+    hand.id = record.id;
+    hand.palmPosition = load(record.palmPosition);
+    hand.stabilizedPalmPosition = load(record.stabilizedPalmPosition);
+    hand.palmVelocity = load(record.palmVelocity);
+    hand.palmNormal = load(record.palmNormal);
+    hand.direction = load(record.direction);
+    hand.timeVisible = record.timeVisible;
+  }
+
+  frame.pointableCount = std::min(static_cast<int>(frameRecord.pointableCount), FrameModel::MAX_FRAME_POINTABLES);
+  for (int i = 0; i < frameRecord.pointableCount; i++, in += m_header.pointableRecordSize) {
+    if (i >= frame.pointableCount) {
+      continue;
+    }
+    PointableRecord record;
+    std::memcpy(&record, in, sizeof(PointableRecord));
+    PointableData& pointable = frame.pointables[i];
+    pointable.id = record.id;
+    pointable.handId = record.handId;
+    pointable.tipPosition = load(record.tipPosition);
+    pointable.stabilizedTipPosition = load(record.stabilizedTipPosition);
+    pointable.tipVelocity = load(record.tipVelocity);
+    pointable.direction = load(record.direction);
+    pointable.length = record.length;
+    pointable.width = record.width;
+    pointable.touchDistance = record.touchDistance;
+    pointable.timeVisible = record.timeVisible;
+    pointable.touchZone = record.touchZone;
+    pointable.isTool = record.isTool != 0;
+  }
+
+  m_position = next;
+  return true;
+}
+
+size_t Reader::FrameCount() const {
+  size_t count = 0;
+  for (const char* position = recordAt(m_begin); position; position = recordAt(position)) {
+    count++;
+  }
+  return count;
+}
+
+}
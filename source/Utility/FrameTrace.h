@@ -0,0 +1,145 @@
+#if !defined(__FrameTrace_h__)
+#define __FrameTrace_h__
+#include "common.h"
+#include "FrameModel.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+/// <summary>
+/// Binary trace of per-frame hand and pointable state
+/// </summary>
+/// <remarks>
+/// A trace is a FileHeader followed by any number of frame records, each of which is a FrameRecord followed by
+/// its HandRecords and then its PointableRecords.  All values are little-endian.  Traces are append-only: a
+/// record is never rewritten once it has been written, so a trace cut short by a crash loses at most its final,
+/// partial record, which readers ignore and which a writer appending to the trace cuts off first.
+///
+/// The header records the size of each kind of record.  Fields may be appended to the records in later
+/// versions, and readers skip whatever trailing fields they don't know about.
+/// </remarks>
+namespace FrameTrace {
+
+static const char MAGIC[4] = {'L', 'P', 'F', 'T'};
+static const uint16_t VERSION = 1;
+
+struct FileHeader {
+  char     magic[4];
+  uint16_t version;
+  uint16_t headerSize;
+  uint16_t frameRecordSize;
+  uint16_t handRecordSize;
+  uint16_t pointableRecordSize;
+  uint16_t reserved;
+};
+
+struct FrameRecord {
+  uint32_t size;                  // of the whole frame record, including its hands and pointables
+  uint8_t  handCount;
+  uint8_t  pointableCount;
+  uint16_t reserved;
+  int64_t  id;
+  int64_t  timestamp;             // microseconds
+  float    boxCenter[3];          // interaction box, all zero if it was invalid
+  float    boxSize[3];
+};
+
+struct HandRecord {
+  int32_t id;
+  float   palmPosition[3];
+  float   stabilizedPalmPosition[3];
+  float   palmVelocity[3];
+  float   palmNormal[3];
+  float   direction[3];
+  float   timeVisible;
+};
+
+struct PointableRecord {
+  int32_t id;
+  int32_t handId;
+  float   tipPosition[3];
+  float   stabilizedTipPosition[3];
+  float   tipVelocity[3];
+  float   direction[3];
+  float   length;
+  float   width;
+  float   touchDistance;
+  float   timeVisible;
+  uint8_t touchZone;
+  uint8_t isTool;
+  uint16_t reserved;
+};
+
+/// <summary>
+/// Appends frames to a trace file
+/// </summary>
+/// <remarks>
+/// Not thread-safe; see FrameTraceRecorder for recording from a device callback.
+/// </remarks>
+class Writer {
+public:
+  Writer();
+  ~Writer();
+
+  /// <summary>
+  /// Opens a trace for appending, writing the header if the file is new or empty, and otherwise truncating it to
+  /// the end of its last complete record
+  /// </summary>
+  /// <returns>false if the file can't be opened or truncated, or holds a trace of a different version</returns>
+  bool Open(const std::string& fileName);
+  void Close();
+  bool IsOpen() const { return m_file != nullptr; }
+
+  bool Write(const FrameModel::FrameData& frame);
+  void Flush();
+
+private:
+  std::FILE*        m_file;
+  std::vector<char> m_buffer;
+};
+
+/// <summary>
+/// Reads frames from a memory-mapped trace file
+/// </summary>
+/// <remarks>
+/// Frames are decoded directly out of the mapping into storage supplied by the caller, so reading performs no
+/// allocation.
+/// </remarks>
+class Reader {
+public:
+  Reader();
+
+  /// <returns>false if the file can't be mapped or isn't a trace this reader understands</returns>
+  bool Open(const std::string& fileName);
+  void Close();
+  bool IsOpen() const { return m_begin != nullptr; }
+
+  /// <summary>
+  /// Decodes the next frame into frame
+  /// </summary>
+  /// <returns>false, leaving frame untouched, at the end of the trace</returns>
+  bool Next(FrameModel::FrameData& frame);
+
+  void Rewind();
+
+  /// <summary>
+  /// Counts the complete frames in the trace by walking the record sizes
+  /// </summary>
+  size_t FrameCount() const;
+
+private:
+  const char* recordAt(const char* position) const;
+
+  boost::interprocess::file_mapping  m_mapping;
+  boost::interprocess::mapped_region m_region;
+  const char* m_begin;
+  const char* m_end;
+  const char* m_position;
+  FileHeader  m_header;
+};
+
+}
+
+#endif // __FrameTrace_h__
@@ -0,0 +1,59 @@
+#include "stdafx.h"
+#include "FrameTraceRecorder.h"
+
+FrameTraceRecorder::FrameTraceRecorder() :
+  m_recording(false),
+  m_stop(false),
+  m_framesRecorded(0),
+  m_framesDropped(0)
+{
+}
+
+FrameTraceRecorder::~FrameTraceRecorder() {
+  Close();
+}
+
+bool FrameTraceRecorder::Open(const std::string& fileName) {
+  Close();
+  {
+    boost::lock_guard<boost::mutex> lock(m_writerMutex);
+    if (!m_writer.Open(fileName)) {
+      return false;
+    }
+  }
+  m_stop = false;
+  m_recording = true;
+  m_thread = boost::thread([this] () {this->loop();});
+  return true;
+}
+
+void FrameTraceRecorder::Close() {
+  m_recording = false;
+  if (m_thread.joinable()) {
+    m_stop = true;
+    m_thread.join();
+  }
+  boost::lock_guard<boost::mutex> lock(m_writerMutex);
+  drain();
+  m_writer.Close();
+}
+
+void FrameTraceRecorder::loop() {
+  while (!m_stop) {
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(POLL_MILLISECONDS));
+    boost::lock_guard<boost::mutex> lock(m_writerMutex);
+    drain();
+  }
+}
+
+void FrameTraceRecorder::drain() {
+  // m_writerMutex must be held, which also makes this the only consumer of m_queue
+  bool wrote = false;
+  while (m_queue.Dequeue(m_pending)) {
+    m_writer.Write(m_pending);
+    wrote = true;
+  }
+  if (wrote) {
+    m_writer.Flush();
+  }
+}
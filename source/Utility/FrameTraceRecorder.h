@@ -0,0 +1,71 @@
+#if !defined(__FrameTraceRecorder_h__)
+#define __FrameTraceRecorder_h__
+#include "common.h"
+#include "AtomicBoundedQueue.h"
+#include "FrameModel.h"
+#include "FrameTrace.h"
+#include <boost/thread/thread.hpp>
+#include ATOMIC_HEADER
+
+/// <summary>
+/// Records frames to a trace file without blocking the thread which delivers them
+/// </summary>
+/// <remarks>
+/// Record captures the frame into a FrameData and hands it to a writer thread through a lock-free queue, so it
+/// is safe to call from the device callback: it takes no lock, performs no allocation and does no file IO.  If
+/// the writer falls so far behind that the queue fills, frames are dropped from the trace and counted.
+/// </remarks>
+class FrameTraceRecorder {
+public:
+  FrameTraceRecorder();
+  ~FrameTraceRecorder();
+
+  /// <summary>
+  /// Starts appending frames to the named trace, closing any trace already being recorded
+  /// </summary>
+  bool Open(const std::string& fileName);
+
+  /// <summary>
+  /// Writes out any queued frames and stops recording
+  /// </summary>
+  void Close();
+
+  bool IsRecording() const { return m_recording; }
+
+  template<class FrameType>
+  void Record(const FrameType& frame) {
+    if (!m_recording) {
+      return;
+    }
+    FrameModel::CaptureFrame(frame, m_capture);
+    if (m_queue.Enqueue(m_capture)) {
+      ++m_framesRecorded;
+    } else {
+      ++m_framesDropped;
+    }
+  }
+
+  uint64_t FramesRecorded() const { return m_framesRecorded; }
+  uint64_t FramesDropped() const { return m_framesDropped; }
+
+private:
+  void loop();
+  void drain();
+
+  // the writer thread runs only between Open and Close, and polls at this interval, so that recording never
+  // has to signal it
+  static const uint32_t POLL_MILLISECONDS = 20;
+
+  AtomicBoundedQueue<FrameModel::FrameData, 64> m_queue;
+  FrameModel::FrameData  m_capture;           // producer-side scratch
+  FrameModel::FrameData  m_pending;           // consumer-side scratch
+  FrameTrace::Writer     m_writer;
+  boost::mutex           m_writerMutex;
+  boost::thread          m_thread;
+  std::atomic<bool>      m_recording;
+  std::atomic<bool>      m_stop;
+  std::atomic<uint64_t>  m_framesRecorded;
+  std::atomic<uint64_t>  m_framesDropped;
+};
+
+#endif // __FrameTraceRecorder_h__
@@ -0,0 +1,31 @@
+#if !defined(__FrameTypes_h__)
+#define __FrameTypes_h__
+
+/// <summary>
+/// Selects the frame/pointable/hand types consumed by the interaction code
+/// </summary>
+/// <remarks>
+/// Normal builds use the Leap SDK types directly.  Headless builds (TOUCHLESS_HEADLESS) have no SDK, and instead
+/// alias the value model from FrameModel.h into the Leap namespace, so that code written against Leap::Frame and
+/// friends compiles unchanged and can be driven by a FrameSource.
+/// </remarks>
+#if TOUCHLESS_HEADLESS
+  #include "Utility/FrameModel.h"
+
+  namespace Leap {
+    using FrameModel::Vector;
+    using FrameModel::InteractionBox;
+    using FrameModel::Pointable;
+    using FrameModel::PointableList;
+    using FrameModel::Hand;
+    using FrameModel::HandList;
+    using FrameModel::Frame;
+    using FrameModel::PI;
+    using FrameModel::DEG_TO_RAD;
+    using FrameModel::RAD_TO_DEG;
+  }
+#else
+  #include "Leap.h"
+#endif
+
+#endif // __FrameTypes_h__
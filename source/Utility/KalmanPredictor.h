@@ -0,0 +1,188 @@
+//ABOUT: A constant-velocity Kalman filter for extrapolating a stream of positions.
+//Each axis is filtered independently with a (position, velocity) state driven by
+//white-noise acceleration.  Unlike RollingMean, Predict extrapolates along the
+//estimated velocity, which is what hides latency when the prediction is asked for
+//"now" rather than for the time of the last measurement.
+//
+//The length of a step is set by the caller through SetStepDuration: with a step
+//duration of 1e-6 the frame_t arguments are microseconds, so Update can be given
+//timestamp differences directly.  NoiseDensity is given per second, so it doesn't
+//depend on the step duration.
+//
+//Overshoot: a constant-velocity model keeps moving for a while after the
+//measurements stop, so a prediction is clamped to within MaxExtrapolation of the
+//most recent measurement.
+
+#ifndef KalmanPredictor_h
+#define KalmanPredictor_h
+
+#include "FilterBase.h"
+
+template <int dim>
+class KalmanPredictor : public FilterBase<dim> {
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW //Ensure alignment when allocated from heap
+
+  KalmanPredictor() {
+    StepDuration = 1.;
+    NoiseDensity = 1.;
+    MeasVariance = 1.;
+    MaxExtrapolation = -1.; //DEFAULT: No clamping
+    Reset();
+  };
+
+  virtual FilterBase<dim>* ChildCopy() const {
+    return(new KalmanPredictor<dim>(*this));
+  };
+
+  //Ready: Velocity is only observable after the second measurement
+  virtual bool Ready() const {
+    return(Updates >= 2);
+  };
+  virtual void Reset() {
+    Updates = 0;
+    Position.setZero();
+    Velocity.setZero();
+    LastMeas.setZero();
+    PP.setZero();
+    PV.setZero();
+    VV.setZero();
+  };
+
+  virtual const Eigen::Matrix<double,dim,1>& Predict(frame_t Pred_Frames) const {
+    C1 = Position;
+    if (!Ready() || Pred_Frames <= 0) {
+      return(C1);
+    }
+    C1 += (StepDuration*Pred_Frames)*Velocity;
+    //Overshoot: never stray further than MaxExtrapolation from the latest measurement
+    const Eigen::Matrix<double,dim,1> offset = C1 - LastMeas;
+    const double norm = offset.norm();
+    if (MaxExtrapolation >= 0. && norm > MaxExtrapolation) {
+      C1 = LastMeas + (MaxExtrapolation/norm)*offset;
+    }
+    return(C1);
+  };
+  virtual const Eigen::Matrix<double,dim,dim>& Unc2Cov(frame_t Pred_Frames) const {
+    const double dt = Pred_Frames > 0 ? StepDuration*Pred_Frames : 0.;
+    C2.setZero();
+    for (int i=0; i<dim; i++) {
+      C2(i,i) = PP(i) + 2.*dt*PV(i) + dt*dt*VV(i) + NoiseDensity*dt*dt*dt/3.;
+    }
+    return(C2);
+  };
+
+  //Update: Meas_C2Unc is used as the measurement covariance when it is nonzero,
+  //otherwise the variance set by SetMeasurementVariance.  Weight scales the
+  //measurement's confidence.
+  virtual void Update(frame_t Step_Frames,
+                      const Eigen::Matrix<double,dim,1>& Meas_State,
+                      const Eigen::Matrix<double,dim,dim>& Meas_C2Unc,
+                      double Weight) {
+    if (Weight <= 0.) {
+      return;
+    }
+    LastMeas = Meas_State;
+    if (Updates == 0) {
+      Position = Meas_State;
+      Velocity.setZero();
+      for (int i=0; i<dim; i++) {
+        PP(i) = MeasurementVariance(Meas_C2Unc, i, Weight);
+        VV(i) = LargeVariance;
+        PV(i) = 0.;
+      }
+      Updates = 1;
+      return;
+    }
+    const double dt = StepDuration*(Step_Frames > 0 ? Step_Frames : 0);
+    for (int i=0; i<dim; i++) {
+      //Time update
+      Position(i) += dt*Velocity(i);
+      const double pp = PP(i) + 2.*dt*PV(i) + dt*dt*VV(i) + NoiseDensity*dt*dt*dt/3.;
+      const double pv = PV(i) + dt*VV(i) + NoiseDensity*dt*dt/2.;
+      const double vv = VV(i) + NoiseDensity*dt;
+      //Measurement update
+      const double s = pp + MeasurementVariance(Meas_C2Unc, i, Weight);
+      const double kp = pp/s;
+      const double kv = pv/s;
+      const double innovation = Meas_State(i) - Position(i);
+      Position(i) += kp*innovation;
+      Velocity(i) += kv*innovation;
+      PP(i) = (1. - kp)*pp;
+      PV(i) = (1. - kp)*pv;
+      VV(i) = vv - kv*pv;
+    }
+    if (Updates < 2) {
+      Updates++;
+    }
+  };
+
+  //Transform: Positions are mapped affinely, velocities linearly.  The covariance
+  //is only kept exact for diagonal Mul, which covers translations and scalings.
+  virtual void Transform(const Eigen::Matrix<double,dim,dim>& Mul, const Eigen::Matrix<double,dim,1>& Add) {
+    Position = (Mul*Position + Add).eval();
+    LastMeas = (Mul*LastMeas + Add).eval();
+    Velocity = (Mul*Velocity).eval();
+    for (int i=0; i<dim; i++) {
+      const double m = Mul(i,i);
+      PP(i) *= m*m;
+      PV(i) *= m*m;
+      VV(i) *= m*m;
+    }
+  };
+
+  //SetStepDuration: The length in seconds of a frame_t step
+  void SetStepDuration(double newStepDuration) {
+    if (0. < newStepDuration) {
+      StepDuration = newStepDuration;
+    }
+  };
+  //SetNoiseDensity: Spectral density of the unmodeled acceleration, in units^2/s^3.
+  //Larger values follow changes of direction faster but extrapolate more noise.
+  void SetNoiseDensity(double newNoiseDensity) {
+    if (0. < newNoiseDensity) {
+      NoiseDensity = newNoiseDensity;
+    }
+  };
+  void SetMeasurementVariance(double newMeasVariance) {
+    if (0. < newMeasVariance) {
+      MeasVariance = newMeasVariance;
+    }
+  };
+  //SetMaxExtrapolation: Largest distance a prediction may be from the most recent
+  //measurement.  Negative disables the clamp.
+  void SetMaxExtrapolation(double newMaxExtrapolation) {
+    MaxExtrapolation = newMaxExtrapolation;
+  };
+
+  const Eigen::Matrix<double,dim,1>& EstimatedVelocity() const { return(Velocity); };
+
+protected:
+  double MeasurementVariance(const Eigen::Matrix<double,dim,dim>& Meas_C2Unc, int i, double Weight) const {
+    return((Meas_C2Unc(i,i) > 0. ? Meas_C2Unc(i,i) : MeasVariance)/Weight);
+  };
+
+  static const double LargeVariance;
+
+  double StepDuration;
+  double NoiseDensity;
+  double MeasVariance;
+  double MaxExtrapolation;
+  int Updates;
+  Eigen::Matrix<double,dim,1> Position;
+  Eigen::Matrix<double,dim,1> Velocity;
+  Eigen::Matrix<double,dim,1> LastMeas;
+  //Per-axis covariance of (position, velocity)
+  Eigen::Matrix<double,dim,1> PP;
+  Eigen::Matrix<double,dim,1> PV;
+  Eigen::Matrix<double,dim,1> VV;
+
+  mutable Eigen::Matrix<double,dim,1> C1;
+  mutable Eigen::Matrix<double,dim,dim> C2;
+};
+
+//The velocity is unknown until the second measurement
+template <int dim>
+const double KalmanPredictor<dim>::LargeVariance = 1e12;
+
+#endif
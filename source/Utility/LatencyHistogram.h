@@ -0,0 +1,124 @@
+#if !defined(__LatencyHistogram_h__)
+#define __LatencyHistogram_h__
+#include "common.h"
+#include ATOMIC_HEADER
+
+/// <summary>
+/// Lock-free histogram of durations with log-linear buckets
+/// </summary>
+/// <remarks>
+/// Values below SUB_BUCKET_COUNT get a bucket each; above that, every power of two is split into SUB_BUCKET_COUNT
+/// linear buckets, so any recorded value is reported to within 1/SUB_BUCKET_COUNT of itself (about 6%) whatever
+/// its magnitude.  Values beyond the largest bucket are counted in it.
+///
+/// Record is a single relaxed atomic increment, so any number of threads may record while another queries.  A
+/// query is not a consistent snapshot of concurrent records, which is fine for percentiles.
+/// </remarks>
+class LatencyHistogram {
+public:
+  static const int SUB_BUCKET_BITS = 4;
+  static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+  // the largest bucket starts at 2^MAX_EXPONENT, which in nanoseconds is over 18 minutes
+  static const int MAX_EXPONENT = 40;
+  static const int BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2)*SUB_BUCKET_COUNT;
+
+  LatencyHistogram() {
+    Reset();
+  }
+
+  void Record(uint64_t value) {
+    m_counts[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) { }
+  }
+
+  /// <summary>
+  /// Clears every bucket.  Records made concurrently with a reset may be partially lost.
+  /// </summary>
+  void Reset() {
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+      m_counts[i].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+  }
+
+  uint64_t Count() const { return m_count.load(std::memory_order_relaxed); }
+  uint64_t Max() const { return m_max.load(std::memory_order_relaxed); }
+  double Mean() const {
+    const uint64_t count = Count();
+    return count ? static_cast<double>(m_sum.load(std::memory_order_relaxed))/count : 0.0;
+  }
+
+  /// <summary>
+  /// The value at or below which the given fraction (0 to 1) of the recorded values lie, reported as the upper
+  /// bound of the bucket it falls in.  Returns zero if nothing has been recorded.
+  /// </summary>
+  uint64_t Quantile(double fraction) const {
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+      total += m_counts[i].load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+      return 0;
+    }
+    fraction = fraction < 0 ? 0 : (fraction > 1 ? 1 : fraction);
+    uint64_t rank = static_cast<uint64_t>(fraction*total + 0.5);
+    rank = rank < 1 ? 1 : rank;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+      seen += m_counts[i].load(std::memory_order_relaxed);
+      if (seen >= rank) {
+        const uint64_t upper = BucketUpperBound(i);
+        const uint64_t max = Max();
+        return upper < max || max == 0 ? upper : max;
+      }
+    }
+    return Max();
+  }
+
+  static int BucketIndex(uint64_t value) {
+    if (value < static_cast<uint64_t>(SUB_BUCKET_COUNT)) {
+      return static_cast<int>(value);
+    }
+    const int exponent = HighestBit(value) - SUB_BUCKET_BITS;
+    if (exponent > MAX_EXPONENT - SUB_BUCKET_BITS) {
+      return BUCKET_COUNT - 1;
+    }
+    return (exponent + 1)*SUB_BUCKET_COUNT + static_cast<int>((value >> exponent) - SUB_BUCKET_COUNT);
+  }
+
+  static uint64_t BucketLowerBound(int index) {
+    if (index < SUB_BUCKET_COUNT) {
+      return static_cast<uint64_t>(index);
+    }
+    const int exponent = index/SUB_BUCKET_COUNT - 1;
+    return static_cast<uint64_t>(index%SUB_BUCKET_COUNT + SUB_BUCKET_COUNT) << exponent;
+  }
+
+  static uint64_t BucketUpperBound(int index) {
+    return index + 1 < BUCKET_COUNT ? BucketLowerBound(index + 1) - 1 : ~static_cast<uint64_t>(0);
+  }
+
+private:
+  static int HighestBit(uint64_t value) {
+    int bit = 0;
+    for (int shift = 32; shift > 0; shift >>= 1) {
+      if (value >> shift) {
+        value >>= shift;
+        bit += shift;
+      }
+    }
+    return bit;
+  }
+
+  std::atomic<uint64_t> m_counts[BUCKET_COUNT];
+  std::atomic<uint64_t> m_count;
+  std::atomic<uint64_t> m_sum;
+  std::atomic<uint64_t> m_max;
+};
+
+#endif // __LatencyHistogram_h__
@@ -0,0 +1,128 @@
+#include "stdafx.h"
+#include "LatencyMonitor.h"
+#include <boost/chrono.hpp>
+#include <iomanip>
+#include <ostream>
+
+LatencyHistogram LatencyMonitor::s_histograms[LatencyMonitor::NUM_STAGES];
+
+// The bookkeeping of the frame being processed on this thread, between BeginFrame and EndFrame
+struct FrameState {
+  bool    inFrame;
+  bool    emitted;
+  int64_t receivedAt;
+  int64_t lastMark;
+  int64_t nestedSinceMark;
+  int64_t nested[LatencyMonitor::NUM_STAGES];
+};
+static THREAD_LOCAL FrameState s_frame;
+
+static uint64_t Elapsed(int64_t start, int64_t end) {
+  return end > start ? static_cast<uint64_t>(end - start) : 0;
+}
+
+int64_t LatencyMonitor::Now() {
+  return boost::chrono::duration_cast<boost::chrono::nanoseconds>(boost::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatencyMonitor::BeginFrame(int64_t receivedAt) {
+  const int64_t now = Now();
+  s_frame.inFrame = true;
+  s_frame.emitted = false;
+  s_frame.receivedAt = receivedAt;
+  s_frame.lastMark = now;
+  s_frame.nestedSinceMark = 0;
+  for (int i = 0; i < NUM_STAGES; i++) {
+    s_frame.nested[i] = -1;
+  }
+  s_histograms[STAGE_RECEIVE].Record(Elapsed(receivedAt, now));
+}
+
+void LatencyMonitor::Mark(Stage stage) {
+  if (!s_frame.inFrame) {
+    return;
+  }
+  const int64_t now = Now();
+  s_histograms[stage].Record(Elapsed(s_frame.lastMark + s_frame.nestedSinceMark, now));
+  s_frame.lastMark = now;
+  s_frame.nestedSinceMark = 0;
+}
+
+void LatencyMonitor::EndFrame() {
+  if (!s_frame.inFrame) {
+    return;
+  }
+  for (int i = 0; i < NUM_STAGES; i++) {
+    if (s_frame.nested[i] >= 0) {
+      s_histograms[i].Record(static_cast<uint64_t>(s_frame.nested[i]));
+    }
+  }
+  s_histograms[STAGE_TOTAL].Record(Elapsed(s_frame.receivedAt, Now()));
+  s_frame.inFrame = false;
+}
+
+int64_t LatencyMonitor::CurrentFrameAge() {
+  return s_frame.inFrame ? static_cast<int64_t>(Elapsed(s_frame.receivedAt, Now())) : 0;
+}
+
+void LatencyMonitor::AddNested(Stage stage, int64_t start, int64_t end) {
+  if (!s_frame.inFrame) {
+    return;
+  }
+  const int64_t elapsed = static_cast<int64_t>(Elapsed(start, end));
+  s_frame.nested[stage] = (s_frame.nested[stage] < 0 ? 0 : s_frame.nested[stage]) + elapsed;
+  s_frame.nestedSinceMark += elapsed;
+  if (stage == STAGE_OS_EMIT && !s_frame.emitted) {
+    s_frame.emitted = true;
+    s_histograms[STAGE_RECEIVE_TO_EVENT].Record(Elapsed(s_frame.receivedAt, end));
+  }
+}
+
+LatencyMonitor::Summary LatencyMonitor::Query(Stage stage) {
+  const LatencyHistogram& histogram = s_histograms[stage];
+  Summary summary;
+  summary.count = histogram.Count();
+  summary.p50 = histogram.Quantile(0.5);
+  summary.p99 = histogram.Quantile(0.99);
+  summary.p999 = histogram.Quantile(0.999);
+  summary.max = histogram.Max();
+  return summary;
+}
+
+void LatencyMonitor::Dump(std::ostream& stream) {
+  const std::ios::fmtflags flags = stream.flags();
+  const std::streamsize precision = stream.precision();
+  stream << std::fixed << std::setprecision(1);
+  for (int i = 0; i < NUM_STAGES; i++) {
+    const Summary summary = Query(static_cast<Stage>(i));
+    stream << std::setw(20) << std::left << StageName(static_cast<Stage>(i)) << std::right
+           << " n=" << std::setw(9) << summary.count
+           << " p50=" << std::setw(9) << summary.p50/1000.0
+           << " p99=" << std::setw(9) << summary.p99/1000.0
+           << " p999=" << std::setw(9) << summary.p999/1000.0
+           << " max=" << std::setw(9) << summary.max/1000.0 << " us\n";
+  }
+  stream.flush();
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+void LatencyMonitor::Reset() {
+  for (int i = 0; i < NUM_STAGES; i++) {
+    s_histograms[i].Reset();
+  }
+}
+
+const char* LatencyMonitor::StageName(Stage stage) {
+  switch (stage) {
+  case STAGE_RECEIVE: return "receive";
+  case STAGE_POINTABLE_SELECTION: return "pointable_selection";
+  case STAGE_FILTER_UPDATE: return "filter_update";
+  case STAGE_STATE_MACHINE: return "state_machine";
+  case STAGE_OVERLAY_RASTER: return "overlay_raster";
+  case STAGE_OS_EMIT: return "os_emit";
+  case STAGE_RECEIVE_TO_EVENT: return "receive_to_event";
+  case STAGE_TOTAL: return "total";
+  default: return "unknown";
+  }
+}
@@ -0,0 +1,89 @@
+#if !defined(__LatencyMonitor_h__)
+#define __LatencyMonitor_h__
+#include "common.h"
+#include "LatencyHistogram.h"
+#include <iosfwd>
+
+/// <summary>
+/// Per-stage latency of the frame processing pipeline, from the device callback to the emitted OS event
+/// </summary>
+/// <remarks>
+/// The frame processing thread brackets each frame with BeginFrame and EndFrame, and calls Mark as each
+/// sequential stage completes, which attributes the time since the previous mark to that stage.  Overlay
+/// rasterization and OS event emission are interleaved with the state machines, so they are timed with
+/// ScopedStage instead; that time is accumulated over the frame and excluded from the enclosing sequential stage.
+/// The first OS event of a frame also records the receive-to-event latency: the time since the frame arrived.
+/// This stands in for the latency from the motion itself, which would be measured from the frame's device
+/// timestamp, but the device clock can't be compared with the monotonic clock, so the time the device spent
+/// tracking and delivering the frame is not included.
+///
+/// Timestamps are monotonic nanoseconds.  The per-frame bookkeeping is thread-local, so threads which process
+/// frames of their own, such as the tuner's workers, neither see nor disturb each other's, while the histograms are
+/// shared and may be queried, dumped or reset from any thread.
+/// </remarks>
+class LatencyMonitor {
+public:
+  enum Stage {
+    STAGE_RECEIVE,              // from the device callback until the processing thread picks the frame up
+    STAGE_POINTABLE_SELECTION,
+    STAGE_FILTER_UPDATE,
+    STAGE_STATE_MACHINE,
+    STAGE_OVERLAY_RASTER,
+    STAGE_OS_EMIT,
+    STAGE_RECEIVE_TO_EVENT,     // from the device callback until the first OS event the frame caused
+    STAGE_TOTAL,                // from the device callback until processing of the frame completed
+    NUM_STAGES
+  };
+
+  struct Summary {
+    uint64_t count;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+  };
+
+  /// <summary>
+  /// Monotonic clock in nanoseconds
+  /// </summary>
+  static int64_t Now();
+
+  static void BeginFrame(int64_t receivedAt);
+  static void Mark(Stage stage);
+  static void EndFrame();
+
+  /// <summary>
+  /// Nanoseconds since the frame being processed on this thread was received, or zero outside BeginFrame/EndFrame
+  /// </summary>
+  static int64_t CurrentFrameAge();
+
+  /// <summary>
+  /// Times a nested stage (overlay raster or OS emit) for as long as it is in scope
+  /// </summary>
+  class ScopedStage {
+  public:
+    ScopedStage(Stage stage) : m_stage(stage), m_start(Now()) { }
+    ~ScopedStage() { LatencyMonitor::AddNested(m_stage, m_start, Now()); }
+  private:
+    Stage m_stage;
+    int64_t m_start;
+  };
+
+  static const LatencyHistogram& Histogram(Stage stage) { return s_histograms[stage]; }
+  static Summary Query(Stage stage);
+
+  /// <summary>
+  /// Writes a line per stage with its p50, p99 and p999 in microseconds
+  /// </summary>
+  static void Dump(std::ostream& stream);
+  static void Reset();
+
+  static const char* StageName(Stage stage);
+
+private:
+  static void AddNested(Stage stage, int64_t start, int64_t end);
+
+  static LatencyHistogram s_histograms[NUM_STAGES];
+};
+
+#endif // __LatencyMonitor_h__
@@ -0,0 +1,195 @@
+#include "stdafx.h"
+#include "MultiPositionalDeltaTracker.h"
+#include <algorithm>
+#include <limits>
+
+using namespace Leap;
+
+// the cost of a pair which may not be matched; large enough that no assignment prefers it
+static const double UNMATCHABLE = 1e9;
+
+MultiPositionalDeltaTracker::MultiPositionalDeltaTracker(int32_t firstId)
+  :
+  m_nextId(firstId),
+  m_maxDropout(250*1000),
+  m_maxDistance(100),
+  m_velocityWeight(0.05f)
+{
+  clear();
+}
+
+void MultiPositionalDeltaTracker::update(int64_t timestamp, const Measurement *measurements, int count) {
+  if (timestamp < m_timestamp) {
+    clear(); // a different stream of frames
+  }
+  m_timestamp = timestamp;
+
+  // forget the targets which have been missing for too long
+  int kept = 0;
+  for (int j = 0; j < m_count; j++) {
+    if (timestamp - m_targets[j].lastSeen <= m_maxDropout) {
+      m_targets[kept++] = m_targets[j];
+    }
+  }
+  m_count = kept;
+
+  // rows are measurements then one dummy row per target, columns are targets then one dummy column per
+  // measurement; a measurement or target matched to a dummy goes unmatched, at the cost of the maximum distance
+  const int numMeasurements = std::min(count, static_cast<int>(MAX_TARGETS));
+  const int numTargets = m_count;
+  const int size = numMeasurements + numTargets;
+  for (int i = 0; i < size; i++) {
+    for (int j = 0; j < size; j++) {
+      if (i < numMeasurements && j < numTargets) {
+        const Target &target = m_targets[j];
+        const Measurement &measurement = measurements[i];
+        const float dt = static_cast<float>(timestamp - target.lastSeen)*1e-6f;
+        const Vector predicted = target.position + target.velocity*dt;
+        const float distance = predicted.distanceTo(measurement.position);
+        m_cost[i][j] = distance > m_maxDistance ? UNMATCHABLE
+                                                : distance + m_velocityWeight*target.velocity.distanceTo(measurement.velocity);
+      } else if (i < numMeasurements || j < numTargets) {
+        m_cost[i][j] = m_maxDistance;
+      } else {
+        m_cost[i][j] = 0;
+      }
+    }
+  }
+  int columns[MAX_ASSIGNMENT];
+  if (size > 0) {
+    assign(size, columns);
+  }
+
+  for (int j = 0; j < numTargets; j++) {
+    m_targets[j].visible = false;
+  }
+  m_numMeasurements = numMeasurements;
+  for (int i = 0; i < numMeasurements; i++) {
+    const Measurement &measurement = measurements[i];
+    int j = columns[i];
+    if (j < numTargets && m_cost[i][j] < UNMATCHABLE) {
+      Target &target = m_targets[j];
+      // a different hand or pointable takes over the target, so accumulate a delta to keep it continuous
+      if (measurement.handId != target.handId || measurement.pointableId != target.pointableId) {
+        target.delta = target.position + target.delta - measurement.position;
+      }
+      target.handId = measurement.handId;
+      target.pointableId = measurement.pointableId;
+      target.position = measurement.position;
+      target.velocity = measurement.velocity;
+      target.touchDistance = measurement.touchDistance;
+      target.lastSeen = timestamp;
+      target.visible = true;
+    } else if (m_count < MAX_TARGETS) {
+      j = m_count++;
+      Target &target = m_targets[j];
+      target.id = m_nextId++;
+      target.slot = freeSlot(j);
+      target.handId = measurement.handId;
+      target.pointableId = measurement.pointableId;
+      target.position = measurement.position;
+      target.velocity = measurement.velocity;
+      target.delta = Vector::zero();
+      target.touchDistance = measurement.touchDistance;
+      target.firstSeen = timestamp;
+      target.lastSeen = timestamp;
+      target.visible = true;
+    } else {
+      j = -1;
+    }
+    m_matched[i] = j;
+  }
+}
+
+int MultiPositionalDeltaTracker::numVisible(void) const {
+  int visible = 0;
+  for (int j = 0; j < m_count; j++) {
+    if (m_targets[j].visible) {
+      visible++;
+    }
+  }
+  return visible;
+}
+
+int MultiPositionalDeltaTracker::freeSlot(int count) const {
+  // there are fewer than MAX_TARGETS other targets, so one of the slots is free
+  bool used[MAX_TARGETS] = {false};
+  for (int j = 0; j < count; j++) {
+    used[m_targets[j].slot] = true;
+  }
+  int slot = 0;
+  while (used[slot]) {
+    slot++;
+  }
+  return slot;
+}
+
+int MultiPositionalDeltaTracker::find(int32_t id) const {
+  for (int j = 0; j < m_count; j++) {
+    if (m_targets[j].id == id) {
+      return j;
+    }
+  }
+  return -1;
+}
+
+void MultiPositionalDeltaTracker::clear(void) {
+  m_count = 0;
+  m_numMeasurements = 0;
+  m_timestamp = std::numeric_limits<int64_t>::min();
+}
+
+void MultiPositionalDeltaTracker::assign(int size, int *columns) const {
+  // the Hungarian method with row and column potentials, O(size^3); index 0 is a sentinel column
+  double u[MAX_ASSIGNMENT + 1], v[MAX_ASSIGNMENT + 1], minv[MAX_ASSIGNMENT + 1];
+  int row[MAX_ASSIGNMENT + 1], way[MAX_ASSIGNMENT + 1];
+  bool used[MAX_ASSIGNMENT + 1];
+  std::fill(u, u + size + 1, 0.0);
+  std::fill(v, v + size + 1, 0.0);
+  std::fill(row, row + size + 1, 0);
+
+  for (int i = 1; i <= size; i++) {
+    row[0] = i;
+    int j0 = 0;
+    std::fill(minv, minv + size + 1, std::numeric_limits<double>::max());
+    std::fill(used, used + size + 1, false);
+    do {
+      used[j0] = true;
+      const int i0 = row[j0];
+      double delta = std::numeric_limits<double>::max();
+      int j1 = 0;
+      for (int j = 1; j <= size; j++) {
+        if (!used[j]) {
+          const double reduced = m_cost[i0 - 1][j - 1] - u[i0] - v[j];
+          if (reduced < minv[j]) {
+            minv[j] = reduced;
+            way[j] = j0;
+          }
+          if (minv[j] < delta) {
+            delta = minv[j];
+            j1 = j;
+          }
+        }
+      }
+      for (int j = 0; j <= size; j++) {
+        if (used[j]) {
+          u[row[j]] += delta;
+          v[j] -= delta;
+        } else {
+          minv[j] -= delta;
+        }
+      }
+      j0 = j1;
+    } while (row[j0] != 0);
+    // augment along the alternating path
+    do {
+      const int j1 = way[j0];
+      row[j0] = row[j1];
+      j0 = j1;
+    } while (j0 != 0);
+  }
+
+  for (int j = 1; j <= size; j++) {
+    columns[row[j] - 1] = j - 1;
+  }
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include "Utility/FrameTypes.h"
+
+namespace Leap {
+
+/// <summary>
+/// Stabilization of several hands or pointables at once
+/// </summary>
+/// <remarks>
+/// PositionalDeltaTracker follows a single hand.  This follows up to MAX_TARGETS of them, which are matched to the
+/// measurements of each frame by an optimal assignment rather than by the device's ids, so a target keeps its id
+/// when the device re-numbers a hand, when two hands cross, and through dropouts of up to the maximum dropout.
+/// A target which is not measured keeps its last position, and is removed once it has been missing for longer
+/// than that.  Measurements which can't be matched start new targets, and target ids are never reused.  Each
+/// target also holds a slot below MAX_TARGETS which no other tracked target holds, for ids which must come from
+/// a small range, such as touch ids.
+///
+/// The cost of matching a target to a measurement is the distance from the target's predicted position to the
+/// measured position, plus the difference between their velocities scaled by the velocity weight.  Pairs which
+/// are further apart than the maximum distance are never matched, and leaving a measurement or target unmatched
+/// costs the maximum distance.  The assignment is the Hungarian method on a row and a column for each measurement
+/// and target, at most 2*MAX_TARGETS of each, so an update takes bounded time and doesn't allocate.
+///
+/// As with PositionalDeltaTracker, each target accumulates a delta whenever the hand or pointable measuring it
+/// changes, so its tracked position is continuous.
+/// </remarks>
+class MultiPositionalDeltaTracker {
+public:
+  enum { MAX_TARGETS = 10 }; // as many as GestureInteractionManager's MAX_POINTABLES
+
+  struct Measurement {
+    int32_t handId;
+    int32_t pointableId;            // -1 if the position is the hand's
+    Vector  position;               // millimeters
+    Vector  velocity;               // millimeters per second
+    float   touchDistance;          // +1 .. -1, see Leap::Pointable::touchDistance
+  };
+
+  struct Target {
+    int32_t id;
+    int32_t slot;                   // the lowest not held by another target when this one was first seen
+    int32_t handId;                 // of the last measurement
+    int32_t pointableId;
+    Vector  position;               // the last measured position
+    Vector  velocity;
+    Vector  delta;
+    float   touchDistance;
+    int64_t firstSeen;              // microseconds
+    int64_t lastSeen;
+    bool    visible;                // measured in the last update
+
+    Vector getTrackedPosition(void) const { return position + delta; }
+  };
+
+  /// <summary>
+  /// Target ids start at firstId, so that they may be kept apart from other ids used alongside them
+  /// </summary>
+  MultiPositionalDeltaTracker(int32_t firstId = 0);
+
+  /// <summary>
+  /// Matches the measurements of a frame to the targets, and updates them
+  /// </summary>
+  /// <remarks>
+  /// Measurements past MAX_TARGETS, and new measurements while MAX_TARGETS targets are being tracked, are ignored.
+  /// </remarks>
+  void update(int64_t timestamp, const Measurement *measurements, int count);
+
+  /// <summary>
+  /// The targets, in the order they were first seen
+  /// </summary>
+  int count(void) const { return m_count; }
+  const Target& target(int index) const { return m_targets[index]; }
+  int numVisible(void) const;
+
+  /// <summary>
+  /// The index of the target with the given id, or -1 if it is not being tracked
+  /// </summary>
+  int find(int32_t id) const;
+
+  /// <summary>
+  /// The index of the target matched to each measurement in the last update, or -1
+  /// </summary>
+  int targetOfMeasurement(int measurement) const { return measurement < m_numMeasurements ? m_matched[measurement] : -1; }
+
+  void setMaxDropout(int64_t maxDropout) { m_maxDropout = maxDropout; }
+  void setMaxDistance(float maxDistance) { m_maxDistance = maxDistance; }
+  void setVelocityWeight(float velocityWeight) { m_velocityWeight = velocityWeight; }
+
+  void clear(void);
+
+private:
+  enum { MAX_ASSIGNMENT = 2*MAX_TARGETS }; // a row for each measurement and target, so that either may go unmatched
+
+  // the lowest slot which none of the first count targets holds
+  int freeSlot(int count) const;
+  // solves the assignment for the square cost matrix of the given size, leaving the column of each row in columns
+  void assign(int size, int *columns) const;
+
+  Target    m_targets[MAX_TARGETS];
+  int       m_count;
+  int32_t   m_nextId;
+  int64_t   m_maxDropout;           // microseconds
+  float     m_maxDistance;          // millimeters
+  float     m_velocityWeight;       // seconds
+  int64_t   m_timestamp;
+  double    m_cost[MAX_ASSIGNMENT][MAX_ASSIGNMENT];
+  int       m_matched[MAX_TARGETS];
+  int       m_numMeasurements;
+};
+
+}
@@ -0,0 +1,132 @@
+//ABOUT: The One Euro filter (Casiez, Roussel & Vogel, CHI 2012).
+//A first-order low-pass filter whose cutoff frequency rises with the speed of
+//the signal: at rest the cutoff is MinCutoff, which removes jitter, and it
+//grows by Beta for every unit/s of speed, so fast motion is followed with
+//little lag.  The speed is itself low-pass filtered at DerivativeCutoff.  All
+//axes share one cutoff, taken from the magnitude of the velocity, so the filter
+//doesn't distort the direction of motion.
+//
+//Unlike RollingMean, the smoothing depends on elapsed time rather than on the
+//number of updates: with a step duration of 1e-6 the frame_t arguments are
+//microseconds, so Update can be given timestamp differences directly.  Each
+//Update costs the same whatever the frame rate.
+//
+//The filter has no uncertainty model, so Unc2Cov is zero, and Predict doesn't
+//extrapolate.
+
+#ifndef OneEuroFilter_h
+#define OneEuroFilter_h
+
+#include "FilterBase.h"
+
+template <int dim>
+class OneEuroFilter : public FilterBase<dim> {
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW //Ensure alignment when allocated from heap
+
+  OneEuroFilter() {
+    StepDuration = 1.;
+    MinCutoff = 1.;
+    Beta = 0.;
+    DerivativeCutoff = 1.;
+    Reset();
+  };
+
+  virtual FilterBase<dim>* ChildCopy() const {
+    return(new OneEuroFilter<dim>(*this));
+  };
+
+  virtual bool Ready() const {
+    return(Updates > 0);
+  };
+  virtual void Reset() {
+    Updates = 0;
+    Position.setZero();
+    Velocity.setZero();
+  };
+
+  virtual const Eigen::Matrix<double,dim,1>& Predict(frame_t) const {
+    return(Position);
+  };
+  virtual const Eigen::Matrix<double,dim,dim>& Unc2Cov(frame_t) const {
+    C2.setZero();
+    return(C2);
+  };
+
+  //Update: Meas_C2Unc is ignored.  Weight scales the time step, so a measurement
+  //with less weight moves the estimate less.
+  virtual void Update(frame_t Step_Frames,
+                      const Eigen::Matrix<double,dim,1>& Meas_State,
+                      const Eigen::Matrix<double,dim,dim>&,
+                      double Weight) {
+    if (Weight <= 0.) {
+      return;
+    }
+    const double dt = StepDuration*(Step_Frames > 0 ? Step_Frames : 0)*Weight;
+    if (Updates == 0 || dt <= 0.) {
+      //Nothing to differentiate yet: take the measurement as it is
+      if (Updates == 0) {
+        Position = Meas_State;
+        Velocity.setZero();
+        Updates = 1;
+      }
+      return;
+    }
+    const Eigen::Matrix<double,dim,1> measuredVelocity = (Meas_State - Position)/dt;
+    Velocity += Smoothing(DerivativeCutoff, dt)*(measuredVelocity - Velocity);
+    const double cutoff = MinCutoff + Beta*Velocity.norm();
+    Position += Smoothing(cutoff, dt)*(Meas_State - Position);
+    Updates++;
+  };
+
+  virtual void Transform(const Eigen::Matrix<double,dim,dim>& Mul, const Eigen::Matrix<double,dim,1>& Add) {
+    Position = (Mul*Position + Add).eval();
+    Velocity = (Mul*Velocity).eval();
+  };
+
+  //SetStepDuration: The length in seconds of a frame_t step
+  void SetStepDuration(double newStepDuration) {
+    if (0. < newStepDuration) {
+      StepDuration = newStepDuration;
+    }
+  };
+  //SetMinCutoff: Cutoff frequency at rest, in Hz.  Lower removes more jitter.
+  void SetMinCutoff(double newMinCutoff) {
+    if (0. < newMinCutoff) {
+      MinCutoff = newMinCutoff;
+    }
+  };
+  //SetBeta: Increase of the cutoff frequency per unit/s of speed.  Higher lags less.
+  void SetBeta(double newBeta) {
+    if (0. <= newBeta) {
+      Beta = newBeta;
+    }
+  };
+  void SetDerivativeCutoff(double newDerivativeCutoff) {
+    if (0. < newDerivativeCutoff) {
+      DerivativeCutoff = newDerivativeCutoff;
+    }
+  };
+
+  const Eigen::Matrix<double,dim,1>& EstimatedVelocity() const { return(Velocity); };
+
+protected:
+  //Smoothing: The exponential smoothing factor of a first-order low-pass filter
+  //with the given cutoff, over a step of dt seconds
+  static double Smoothing(double Cutoff, double dt) {
+    const double tau = 1./(2.*3.14159265358979323846*Cutoff);
+    return(1./(1. + tau/dt));
+  };
+
+  double StepDuration;
+  double MinCutoff;
+  double Beta;
+  double DerivativeCutoff;
+  int Updates;
+  Eigen::Matrix<double,dim,1> Position;
+  Eigen::Matrix<double,dim,1> Velocity;
+
+  mutable Eigen::Matrix<double,dim,dim> C2;
+};
+
+#endif
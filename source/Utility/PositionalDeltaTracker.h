@@ -1,5 +1,5 @@
 #pragma once
-#include "Leap.h"
+#include "Utility/FrameTypes.h"
 #include <cassert>
 
 namespace Leap {
@@ -11,9 +11,8 @@ namespace Leap {
 /// This is for removing discontinuities in cursor/overlay position resulting
 /// from switching between pointable and palm positions for setting the cursor/
 /// overlay position.  Positional deltas are accumulated so that the output
-/// position is continuous.  There should be one of these objects per tracked
-/// hand, and tracking 2+ hands will require additional logic to determine which
-/// one of these objects corresponds to which hand.
+/// position is continuous.  This follows one hand; MultiPositionalDeltaTracker
+/// follows several, and determines which hand is which from frame to frame.
 /// </summary>
 class PositionalDeltaTracker {
 public:
@@ -52,6 +51,11 @@ public:
     assert(hand.isValid());
     setPosition(hand.id(), -1, hand.stabilizedPalmPosition());
   }
+  // the hand's palm at the given position, such as its stabilized position after further smoothing
+  void setPositionOf(const Hand &hand, const Vector &palmPosition) {
+    assert(hand.isValid());
+    setPosition(hand.id(), -1, palmPosition);
+  }
   void setPositionToStabilizedPositionOf(const Pointable &pointable) {
     assert(pointable.isValid());
     setPosition(pointable.hand().id(), pointable.id(), pointable.stabilizedTipPosition());
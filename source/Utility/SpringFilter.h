@@ -0,0 +1,144 @@
+//ABOUT: A critically-damped spring which follows a stream of positions.
+//The estimate is pulled towards each measurement by a spring with natural
+//angular frequency w and damping 2w, so it settles as fast as possible without
+//overshooting.  The frequency adapts to the speed of the measurements: at rest
+//it is 2*pi*MinCutoff, which removes jitter, and it grows by 2*pi*Beta for every
+//unit/s of speed, so fast motion is followed with little lag.  These match the
+//parameters of OneEuroFilter, so the two may be swapped without retuning.
+//
+//Each step is integrated exactly, holding the measurement fixed over the step,
+//so the filter is stable and costs the same for any step length.  Steps are
+//real time: with a step duration of 1e-6 the frame_t arguments are
+//microseconds, so Update can be given timestamp differences directly.
+//
+//The filter has no uncertainty model, so Unc2Cov is zero, and Predict doesn't
+//extrapolate.
+
+#ifndef SpringFilter_h
+#define SpringFilter_h
+
+#include "FilterBase.h"
+#include <cmath>
+
+template <int dim>
+class SpringFilter : public FilterBase<dim> {
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW //Ensure alignment when allocated from heap
+
+  SpringFilter() {
+    StepDuration = 1.;
+    MinCutoff = 1.;
+    Beta = 0.;
+    DerivativeCutoff = 1.;
+    Reset();
+  };
+
+  virtual FilterBase<dim>* ChildCopy() const {
+    return(new SpringFilter<dim>(*this));
+  };
+
+  virtual bool Ready() const {
+    return(Updates > 0);
+  };
+  virtual void Reset() {
+    Updates = 0;
+    Position.setZero();
+    Velocity.setZero();
+    LastMeas.setZero();
+    MeasVelocity.setZero();
+  };
+
+  virtual const Eigen::Matrix<double,dim,1>& Predict(frame_t) const {
+    return(Position);
+  };
+  virtual const Eigen::Matrix<double,dim,dim>& Unc2Cov(frame_t) const {
+    C2.setZero();
+    return(C2);
+  };
+
+  //Update: Meas_C2Unc is ignored.  Weight scales the time step, so a measurement
+  //with less weight moves the estimate less.
+  virtual void Update(frame_t Step_Frames,
+                      const Eigen::Matrix<double,dim,1>& Meas_State,
+                      const Eigen::Matrix<double,dim,dim>&,
+                      double Weight) {
+    if (Weight <= 0.) {
+      return;
+    }
+    const double dt = StepDuration*(Step_Frames > 0 ? Step_Frames : 0)*Weight;
+    if (Updates == 0 || dt <= 0.) {
+      if (Updates == 0) {
+        Position = Meas_State;
+        Velocity.setZero();
+        LastMeas = Meas_State;
+        MeasVelocity.setZero();
+        Updates = 1;
+      }
+      return;
+    }
+    //The speed of the measurements, low-pass filtered at DerivativeCutoff
+    const double tau = 1./(2.*Pi()*DerivativeCutoff);
+    MeasVelocity += ((Meas_State - LastMeas)/dt - MeasVelocity)/(1. + tau/dt);
+    LastMeas = Meas_State;
+
+    //Exact step of x'' = w^2*(Meas_State - x) - 2*w*x', for the offset e = x - Meas_State:
+    //e(t) = (e0 + (v0 + w*e0)*t)*exp(-w*t), v(t) = (v0 - w*(v0 + w*e0)*t)*exp(-w*t)
+    const double w = 2.*Pi()*(MinCutoff + Beta*MeasVelocity.norm());
+    const double decay = std::exp(-w*dt);
+    const Eigen::Matrix<double,dim,1> offset = Position - Meas_State;
+    const Eigen::Matrix<double,dim,1> drive = Velocity + w*offset;
+    Position = Meas_State + (offset + dt*drive)*decay;
+    Velocity = (Velocity - (w*dt)*drive)*decay;
+    Updates++;
+  };
+
+  virtual void Transform(const Eigen::Matrix<double,dim,dim>& Mul, const Eigen::Matrix<double,dim,1>& Add) {
+    Position = (Mul*Position + Add).eval();
+    LastMeas = (Mul*LastMeas + Add).eval();
+    Velocity = (Mul*Velocity).eval();
+    MeasVelocity = (Mul*MeasVelocity).eval();
+  };
+
+  //SetStepDuration: The length in seconds of a frame_t step
+  void SetStepDuration(double newStepDuration) {
+    if (0. < newStepDuration) {
+      StepDuration = newStepDuration;
+    }
+  };
+  //SetMinCutoff: Natural frequency at rest, in Hz.  Lower removes more jitter.
+  void SetMinCutoff(double newMinCutoff) {
+    if (0. < newMinCutoff) {
+      MinCutoff = newMinCutoff;
+    }
+  };
+  //SetBeta: Increase of the natural frequency per unit/s of speed.  Higher lags less.
+  void SetBeta(double newBeta) {
+    if (0. <= newBeta) {
+      Beta = newBeta;
+    }
+  };
+  void SetDerivativeCutoff(double newDerivativeCutoff) {
+    if (0. < newDerivativeCutoff) {
+      DerivativeCutoff = newDerivativeCutoff;
+    }
+  };
+
+  const Eigen::Matrix<double,dim,1>& EstimatedVelocity() const { return(Velocity); };
+
+protected:
+  static double Pi() { return(3.14159265358979323846); };
+
+  double StepDuration;
+  double MinCutoff;
+  double Beta;
+  double DerivativeCutoff;
+  int Updates;
+  Eigen::Matrix<double,dim,1> Position;
+  Eigen::Matrix<double,dim,1> Velocity;
+  Eigen::Matrix<double,dim,1> LastMeas;
+  Eigen::Matrix<double,dim,1> MeasVelocity;
+
+  mutable Eigen::Matrix<double,dim,dim> C2;
+};
+
+#endif
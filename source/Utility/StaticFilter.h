@@ -0,0 +1,301 @@
+//ABOUT: Static-polymorphism counterparts of FilterBase.
+//A static filter has the same methods as FilterBase (Ready, Reset, Predict,
+//Unc2Cov, Update, Transform), but they are not virtual, the scalar type may be
+//float or double, and the dimension is fixed at compile time.  Static filters
+//are held by value, so the per-frame calls are inlined and don't chase a
+//pointer.  StaticFilter is the CRTP base, which provides the matrix typedefs
+//and an Update for measurements without a covariance.
+//
+//FilterBaseAdapter exposes a static filter through the virtual FilterBase
+//interface (always in double precision) for code which chooses filters at
+//runtime.  PolymorphicFilter goes the other way: it wraps a FilterBase so that
+//a filter chosen at runtime can be used wherever a static filter is expected.
+
+#ifndef StaticFilter_h
+#define StaticFilter_h
+
+#include "FilterBase.h"
+
+template <class Derived, typename Scalar_, int Dim_>
+class StaticFilter {
+public:
+  typedef Scalar_ Scalar;
+  enum { Dim = Dim_ };
+  typedef Eigen::Matrix<Scalar,Dim_,1> StateVector;
+  typedef Eigen::Matrix<Scalar,Dim_,Dim_> CovarianceMatrix;
+
+  //Update: Gives data Meas_State with no uncertainty of its own
+  void Update(frame_t Step_Frames, const StateVector& Meas_State, Scalar Weight) {
+    derived().Update(Step_Frames, Meas_State, ZeroCovariance(), Weight);
+  };
+
+  Derived& derived() { return(*static_cast<Derived*>(this)); };
+  const Derived& derived() const { return(*static_cast<const Derived*>(this)); };
+
+protected:
+  static const CovarianceMatrix& ZeroCovariance() {
+    static const CovarianceMatrix zero = CovarianceMatrix::Zero();
+    return(zero);
+  };
+};
+
+//StaticRollingMean: RollingMean as a static filter
+template <typename Scalar, int Dim>
+class StaticRollingMean : public StaticFilter<StaticRollingMean<Scalar,Dim>,Scalar,Dim> {
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW //Ensure alignment when allocated from heap
+  typedef StaticFilter<StaticRollingMean<Scalar,Dim>,Scalar,Dim> Base;
+  typedef typename Base::StateVector StateVector;
+  typedef typename Base::CovarianceMatrix CovarianceMatrix;
+  using Base::Update;
+
+  StaticRollingMean() {
+    Sample = 1.; //DEFAULT: No filtering
+    Reset();
+  };
+
+  bool Ready() const {
+    if (1.-Integral > Sample) {
+      return(false);
+    }
+    return(true);
+  };
+  void Reset() {
+    NonZero = false;
+    Integral = 0.;
+    P1.setZero();
+    P2.setZero();
+  };
+
+  const StateVector& Predict(frame_t) const {
+    if (!NonZero) {
+      C1.setZero();
+      return(C1);
+    }
+    C1 = P1/Integral;
+    return(C1);
+  };
+  const CovarianceMatrix& Unc2Cov(frame_t) const {
+    if (!NonZero) {
+      C2.setZero();
+      return(C2);
+    }
+    C1 = P1/Integral;
+    C2 = P2/Integral - C1*C1.transpose();
+    return(C2);
+  };
+
+  void Update(frame_t,
+              const StateVector& Meas_State,
+              const CovarianceMatrix& Meas_C2Unc,
+              Scalar Weight) {
+    NonZero = true;
+    Scalar Filter = Weight*Sample;
+    Integral = Filter + (1-Filter)*Integral;
+    P1 = Filter*(Meas_State) + (1-Filter)*P1;
+    P2 = Filter*(Meas_C2Unc + Meas_State*Meas_State.transpose()) + (1-Filter)*P2;
+  };
+
+  void Transform(const CovarianceMatrix& Mul, const StateVector& Add) {
+    P2 = (Mul*P2*Mul.transpose() + (Mul*P1)*Add.transpose() + Add*(Mul*P1).transpose() + Add*Add.transpose()).eval();
+    P1 = (Mul*P1 + Add).eval();
+    //NOTE: C2' = P2' - P1'*P1'.t() == Mul*P2*Mul.t() - Mul*P1*P1.t()*Mul.t() == Mul*C2*Mul.t()
+  };
+
+  void SetWindow(double newWindow) {
+    if (1. <= newWindow) {
+      Sample = static_cast<Scalar>(1./newWindow);
+    }
+  };
+
+protected:
+  Scalar Sample;
+  bool NonZero;
+  Scalar Integral;
+  StateVector P1;
+  CovarianceMatrix P2;
+
+  mutable StateVector C1;
+  mutable CovarianceMatrix C2;
+};
+
+//StaticCategoricalRollingMean: RollingMean without the second moment, for
+//filters whose covariance is never read, such as the category probabilities
+//of a CategoricalFilter.  The mean follows exactly the same series, but each
+//Update is a single vector blend instead of also accumulating a Dim x Dim outer
+//product.  Meas_C2Unc is ignored.
+//NOTE: For one-hot measurements E[x*x.t()] == diag(E[x]), so Unc2Cov gives the
+//multinomial covariance diag(C1) - C1*C1.t(), which is what RollingMean would
+//report for the same updates.  For other probability vectors it is an upper bound.
+template <typename Scalar, int Dim>
+class StaticCategoricalRollingMean : public StaticFilter<StaticCategoricalRollingMean<Scalar,Dim>,Scalar,Dim> {
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW //Ensure alignment when allocated from heap
+  typedef StaticFilter<StaticCategoricalRollingMean<Scalar,Dim>,Scalar,Dim> Base;
+  typedef typename Base::StateVector StateVector;
+  typedef typename Base::CovarianceMatrix CovarianceMatrix;
+
+  StaticCategoricalRollingMean() {
+    Sample = 1.; //DEFAULT: No filtering
+    Reset();
+  };
+
+  bool Ready() const {
+    if (1.-Integral > Sample) {
+      return(false);
+    }
+    return(true);
+  };
+  void Reset() {
+    NonZero = false;
+    Integral = 0.;
+    P1.setZero();
+  };
+
+  const StateVector& Predict(frame_t) const {
+    if (!NonZero) {
+      C1.setZero();
+      return(C1);
+    }
+    C1 = P1/Integral;
+    return(C1);
+  };
+  const CovarianceMatrix& Unc2Cov(frame_t) const {
+    C2.setZero();
+    if (!NonZero) {
+      return(C2);
+    }
+    C1 = P1/Integral;
+    C2.diagonal() = C1;
+    C2 -= C1*C1.transpose();
+    return(C2);
+  };
+
+  void Update(frame_t, const StateVector& Meas_State, Scalar Weight) {
+    NonZero = true;
+    Scalar Filter = Weight*Sample;
+    Integral = Filter + (1-Filter)*Integral;
+    P1 = Filter*(Meas_State) + (1-Filter)*P1;
+  };
+  void Update(frame_t Step_Frames, const StateVector& Meas_State, const CovarianceMatrix&, Scalar Weight) {
+    Update(Step_Frames, Meas_State, Weight);
+  };
+
+  //Transform: Only the mean is kept, so the covariance is not transformed
+  void Transform(const CovarianceMatrix& Mul, const StateVector& Add) {
+    P1 = (Mul*P1 + Add).eval();
+  };
+
+  void SetWindow(double newWindow) {
+    if (1. <= newWindow) {
+      Sample = static_cast<Scalar>(1./newWindow);
+    }
+  };
+
+protected:
+  Scalar Sample;
+  bool NonZero;
+  Scalar Integral;
+  StateVector P1;
+
+  mutable StateVector C1;
+  mutable CovarianceMatrix C2;
+};
+
+//FilterBaseAdapter: A static filter behind the virtual FilterBase interface.
+//The static filter's own methods (such as SetWindow) remain accessible.
+template <class StaticFilterType>
+class FilterBaseAdapter : public FilterBase<StaticFilterType::Dim>, public StaticFilterType {
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW //Ensure alignment when allocated from heap
+  typedef typename StaticFilterType::Scalar Scalar;
+  typedef Eigen::Matrix<double,StaticFilterType::Dim,1> VectorD;
+  typedef Eigen::Matrix<double,StaticFilterType::Dim,StaticFilterType::Dim> MatrixD;
+
+  virtual FilterBase<StaticFilterType::Dim>* ChildCopy() const {
+    return(new FilterBaseAdapter<StaticFilterType>(*this));
+  };
+
+  virtual bool Ready() const {
+    return(StaticFilterType::Ready());
+  };
+  virtual void Reset() {
+    StaticFilterType::Reset();
+  };
+
+  virtual const VectorD& Predict(frame_t Pred_Frames) const {
+    return(ToDouble(StaticFilterType::Predict(Pred_Frames), C1));
+  };
+  virtual const MatrixD& Unc2Cov(frame_t Pred_Frames) const {
+    return(ToDouble(StaticFilterType::Unc2Cov(Pred_Frames), C2));
+  };
+
+  virtual void Update(frame_t Step_Frames,
+                      const VectorD& Meas_State,
+                      const MatrixD& Meas_C2Unc,
+                      double Weight) {
+    StaticFilterType::Update(Step_Frames,
+                             Meas_State.template cast<Scalar>(),
+                             Meas_C2Unc.template cast<Scalar>(),
+                             static_cast<Scalar>(Weight));
+  };
+
+  virtual void Transform(const MatrixD& Mul, const VectorD& Add) {
+    StaticFilterType::Transform(Mul.template cast<Scalar>(), Add.template cast<Scalar>());
+  };
+
+protected:
+  //ToDouble: Double precision results are passed through, others are converted into the cache
+  template <class Result>
+  static const Result& ToDouble(const Result& Value, Result&) { return(Value); };
+  template <class Result, class Value>
+  static const Result& ToDouble(const Value& Value_, Result& Cache) {
+    Cache = Value_.template cast<double>();
+    return(Cache);
+  };
+
+  mutable VectorD C1;
+  mutable MatrixD C2;
+};
+
+//PolymorphicFilter: A FilterBase chosen at runtime, as a static filter.
+//The wrapped filter is owned, and copied with ChildCopy.
+template <int Dim>
+class PolymorphicFilter : public StaticFilter<PolymorphicFilter<Dim>,double,Dim> {
+public:
+  typedef StaticFilter<PolymorphicFilter<Dim>,double,Dim> Base;
+  typedef typename Base::StateVector StateVector;
+  typedef typename Base::CovarianceMatrix CovarianceMatrix;
+  using Base::Update;
+
+  explicit PolymorphicFilter(FilterBase<Dim>* filter) : Filter(filter) { };
+  PolymorphicFilter(const PolymorphicFilter& other) : Filter(other.Filter->ChildCopy()) { };
+  PolymorphicFilter& operator=(const PolymorphicFilter& other) {
+    if (this != &other) {
+      FilterBase<Dim>* copy = other.Filter->ChildCopy();
+      delete Filter;
+      Filter = copy;
+    }
+    return(*this);
+  };
+  ~PolymorphicFilter() {
+    delete Filter;
+  };
+
+  bool Ready() const { return(Filter->Ready()); };
+  void Reset() { Filter->Reset(); };
+  const StateVector& Predict(frame_t Pred_Frames) const { return(Filter->Predict(Pred_Frames)); };
+  const CovarianceMatrix& Unc2Cov(frame_t Pred_Frames) const { return(Filter->Unc2Cov(Pred_Frames)); };
+  void Update(frame_t Step_Frames, const StateVector& Meas_State, const CovarianceMatrix& Meas_C2Unc, double Weight) {
+    Filter->Update(Step_Frames, Meas_State, Meas_C2Unc, Weight);
+  };
+  void Transform(const CovarianceMatrix& Mul, const StateVector& Add) { Filter->Transform(Mul, Add); };
+
+  FilterBase<Dim>& Get() { return(*Filter); };
+  const FilterBase<Dim>& Get() const { return(*Filter); };
+
+protected:
+  FilterBase<Dim>* Filter;
+};
+
+#endif
@@ -0,0 +1,272 @@
+// ///////////////////////////////////////////////////////////////////////////
+// TableStateMachine.h, a variant of StateMachine.h by Victor Dods
+// Copyright Leap Motion Inc.
+// ///////////////////////////////////////////////////////////////////////////
+
+#if !defined(_TABLESTATEMACHINE_H_)
+#define _TABLESTATEMACHINE_H_
+
+#include "StateMachine.h"
+#include "TransitionTrace.h"
+
+// This is StateMachine with its states registered once, in a table, instead of being passed to each
+// transition along with a name.  The inputs, the SM_ENTER and SM_EXIT semantics and the transition
+// loop are those of StateMachine, so see the comment there.
+//
+// StateMachine keeps the names of the current and next states as std::string, and copies them on every
+// input and every transition.  Here a state is an index into the table, so a transition is an integer
+// assignment and nothing is allocated.  The names are only looked up by the transition logger and by
+// CurrentStateName, and since each name is a single string in the table, names of the same machine may
+// be compared by address.
+//
+// Every transition, including those of Initialize and Shutdown, is recorded in the TransitionTrace under
+// the owner class name, along with the frame id given to SetTraceFrameId.  Unlike the transition logger,
+// this is cheap enough to leave on.
+//
+// The way this class is used is as follows:
+// - List the states of Widget once, as an X-macro, in the class definition
+//     #define WIDGET_STATES(STATE) STATE(State_Idle) STATE(State_Busy)
+//   and declare the ids and the table with it
+//     enum StateId { WIDGET_STATES(STATE_TABLE_ID) WIDGET__STATE_COUNT };
+//     static const TableStateMachine<Widget>::StateEntry s_states[WIDGET__STATE_COUNT];
+// - Define the table in the source file, where STATE_TABLE_ENTRY needs the owner class name
+//     #define WIDGET_STATE_ENTRY(x) STATE_TABLE_ENTRY(Widget, x)
+//     const TableStateMachine<Widget>::StateEntry Widget::s_states[] = { WIDGET_STATES(WIDGET_STATE_ENTRY) };
+// - Pass the table to SetOwnerClass, Initialize() with the initial state's id, and transition with
+//     #define TRANSITION_TO(x) m_state_machine.SetNextState(x##_Id)
+template <typename OwnerClass>
+class TableStateMachine
+{
+public:
+
+    typedef bool (OwnerClass::*State)(StateMachineInput);
+    typedef int StateId;
+
+    enum { NO_STATE = -1 };
+
+    struct StateEntry
+    {
+        State m_state;
+        char const *m_name;
+    };
+
+    TableStateMachine ();
+    ~TableStateMachine ();
+
+    /// The owner class name is used for transition logging and tracing.  The table must outlive the
+    /// state machine, and is indexed by StateId.
+    void SetOwnerClass (OwnerClass* owner_class, char const *owner_class_name, StateEntry const *state_table, StateId state_count);
+    /// The id of the frame being processed is read from frame_id whenever a transition is traced.
+    void SetTraceFrameId (int64_t const *frame_id) { m_trace_frame_id = frame_id; }
+    bool IsInitialized () const { return m_current_state != NO_STATE; }
+    bool IsTransitionLoggerEnabled () const { return m_transition_logger != NULL; }
+    std::ostream *TransitionLogger () const { return m_transition_logger; }
+    StateMachineInput TransitionLoggerIgnoreInput () const { return m_transition_logger_ignore_input; }
+    StateId CurrentState () const { return m_current_state; }
+    /// Will return the empty string if CurrentState returns NO_STATE.
+    char const *CurrentStateName () const { return StateName(m_current_state); }
+    StateId NextState () const { return m_next_state; }
+    /// Will return the empty string if NextState returns NO_STATE.
+    char const *NextStateName () const { return StateName(m_next_state); }
+    char const *StateName (StateId state) const { return state == NO_STATE ? "" : m_state_table[state].m_name; }
+
+    void Initialize (StateId initial_state);
+    /// Specifying NULL for transition_logger indicates that logging will be disabled.
+    void SetTransitionLogger (std::ostream *transition_logger, StateMachineInput transition_logger_ignore_input = SM_INVALID);
+    void RunCurrentState (StateMachineInput input);
+    void Shutdown ();
+
+    /// NO_STATE cancels an earlier requested transition.
+    void SetNextState (StateId state);
+
+private:
+
+    void LogTransition (StateMachineInput input) const;
+    void RunCurrentStatePrivate (StateMachineInput input);
+    void TraceTransition (StateId from_state, StateId to_state, StateMachineInput input) const
+    {
+        TransitionTrace::Add(m_trace_machine, from_state, to_state, input, m_trace_frame_id != NULL ? *m_trace_frame_id : -1);
+    }
+    bool CallCurrentState (StateMachineInput input)
+    {
+        return ((*m_owner_class).*(m_state_table[m_current_state].m_state))(input);
+    }
+
+    OwnerClass* m_owner_class;
+    char const *m_owner_class_name;
+    StateEntry const *m_state_table;
+    StateId m_state_count;
+    int m_trace_machine;
+    int64_t const *m_trace_frame_id;
+    std::ostream *m_transition_logger;
+    StateMachineInput m_transition_logger_ignore_input;
+    bool m_is_running_a_state;
+    StateId m_current_state;
+    StateId m_next_state;
+}; // end of class TableStateMachine
+
+// The enumerator and table entry of a state in an X-macro list of states; see above.
+#define STATE_TABLE_ID(x) x##_Id,
+#define STATE_TABLE_ENTRY(OwnerClass, x) { &OwnerClass::x, #x },
+
+template <typename OwnerClass>
+TableStateMachine<OwnerClass>::TableStateMachine ()
+  :
+  m_owner_class(NULL),
+  m_owner_class_name(""),
+  m_state_table(NULL),
+  m_state_count(0),
+  m_trace_machine(-1),
+  m_trace_frame_id(NULL),
+  m_transition_logger(NULL),
+  m_transition_logger_ignore_input(SM_INVALID),
+  m_is_running_a_state(false),
+  m_current_state(NO_STATE),
+  m_next_state(NO_STATE)
+{ }
+
+template <typename OwnerClass>
+TableStateMachine<OwnerClass>::~TableStateMachine ()
+{
+    Shutdown();
+}
+
+template <typename OwnerClass>
+void TableStateMachine<OwnerClass>::SetOwnerClass (OwnerClass* owner_class, char const *owner_class_name, StateEntry const *state_table, StateId state_count)
+{
+    assert(m_current_state == NO_STATE && "The table must not change while the state machine is initialized");
+    m_owner_class = owner_class;
+    m_owner_class_name = owner_class_name;
+    m_state_table = state_table;
+    m_state_count = state_count;
+    m_trace_machine = TransitionTrace::RegisterMachine(owner_class_name);
+    for (StateId state = 0; state < state_count; ++state)
+        TransitionTrace::RegisterState(m_trace_machine, state, state_table[state].m_name);
+}
+
+template <typename OwnerClass>
+void TableStateMachine<OwnerClass>::Initialize (StateId initial_state)
+{
+    // just make sure this happens only once at the beginning
+    assert(!m_is_running_a_state && "This method should not be used from inside a state");
+    assert(m_current_state == NO_STATE && "This state machine is already initialized");
+    assert(initial_state >= 0 && initial_state < m_state_count);
+
+    // set the current state and run it with SM_ENTER.
+    m_current_state = initial_state;
+    TraceTransition(NO_STATE, initial_state, SM_ENTER);
+    this->RunCurrentStatePrivate(SM_ENTER);
+}
+
+template <typename OwnerClass>
+void TableStateMachine<OwnerClass>::SetTransitionLogger (std::ostream *transition_logger, StateMachineInput transition_logger_ignore_input)
+{
+    assert(transition_logger_ignore_input == SM_INVALID || transition_logger_ignore_input <= SM_HIGHEST_USER_INPUT_VALUE);
+    m_transition_logger = transition_logger;
+    m_transition_logger_ignore_input = transition_logger_ignore_input;
+}
+
+template <typename OwnerClass>
+void TableStateMachine<OwnerClass>::RunCurrentState (StateMachineInput input)
+{
+    assert(input <= SM_HIGHEST_USER_INPUT_VALUE && "Users are not allowed to send state-machine-defined input");
+    this->RunCurrentStatePrivate(input);
+}
+
+template <typename OwnerClass>
+void TableStateMachine<OwnerClass>::Shutdown ()
+{
+    assert(!m_is_running_a_state);
+
+    // only actually shutdown if we're not already shutdown.
+    if (m_current_state != NO_STATE)
+    {
+        // run the current state with SM_EXIT and clear it.
+        this->RunCurrentStatePrivate(SM_EXIT);
+        TraceTransition(m_current_state, NO_STATE, SM_EXIT);
+        m_current_state = NO_STATE;
+    }
+}
+
+template <typename OwnerClass>
+void TableStateMachine<OwnerClass>::SetNextState (StateId state)
+{
+    assert(m_is_running_a_state && "This method should only be used from inside a state");
+    assert(m_current_state != NO_STATE && "This state machine has not been initialized");
+    assert(state == NO_STATE || (state >= 0 && state < m_state_count));
+
+    m_next_state = state;
+}
+
+template <typename OwnerClass>
+void TableStateMachine<OwnerClass>::LogTransition (StateMachineInput input) const
+{
+    assert(input != SM_INVALID);
+
+    if (m_transition_logger == NULL || input == m_transition_logger_ignore_input)
+        return; // logging disabled or we want to ignore this particular input
+
+    *m_transition_logger << m_owner_class_name << ": ";
+    if (input == SM_ENTER)
+        *m_transition_logger << "--> " << CurrentStateName();
+    else if (input == SM_EXIT)
+        *m_transition_logger << "<-- " << CurrentStateName();
+    else
+        *m_transition_logger << "input: " << input;
+    *m_transition_logger << std::endl;
+}
+
+template <typename OwnerClass>
+void TableStateMachine<OwnerClass>::RunCurrentStatePrivate (StateMachineInput input)
+{
+    assert(!m_is_running_a_state && "This method should not be used from inside a state");
+    assert(m_current_state != NO_STATE && "This state machine has not been initialized");
+
+    // NO_STATE is a sentinel value so we know if the state has transitioned
+    m_next_state = NO_STATE;
+
+    // if the state return true, the input was handled.  otherwise not.
+    m_is_running_a_state = true;
+    LogTransition(input);
+#ifndef NDEBUG
+    bool state_handled_the_input =
+#endif
+    CallCurrentState(input);
+    m_is_running_a_state = false;
+    // make sure that states always handle all input (with the exception of
+    // the StateMachine mechanism inputs)
+    if (input <= SM_HIGHEST_USER_INPUT_VALUE)
+        assert(state_handled_the_input && "All user-defined state machine input must be handled");
+
+    if (input == SM_EXIT && m_next_state != NO_STATE)
+        assert(false && "You must not transition while exiting a state");
+
+    // if a transition was requested, perform the necessary exit/enter machinery.
+    // this is a while-loop because you can transition during SM_ENTER.
+    StateMachineInput transition_input = input;
+    while (m_next_state != NO_STATE)
+    {
+        // save off the next state, to detect a transition requested on SM_EXIT (which is not allowed).
+        StateId real_next_state = m_next_state;
+        m_next_state = NO_STATE;
+        // call the current state with SM_EXIT, ignoring the return value
+        m_is_running_a_state = true;
+        LogTransition(SM_EXIT);
+        CallCurrentState(SM_EXIT);
+        m_is_running_a_state = false;
+        // if they requested a transition, assert
+        assert(m_next_state == NO_STATE && "You must not transition while exiting a state");
+
+        // set the current state to the new state
+        TraceTransition(m_current_state, real_next_state, transition_input);
+        transition_input = SM_ENTER; // any further transitions are requested on entering
+        m_current_state = real_next_state;
+        // call the current state with SM_ENTER, ignoring the return value
+        m_is_running_a_state = true;
+        LogTransition(SM_ENTER);
+        CallCurrentState(SM_ENTER);
+        m_is_running_a_state = false;
+    }
+}
+
+#endif // !defined(_TABLESTATEMACHINE_H_)
@@ -10,8 +10,13 @@
 #ifndef __TimedHistory_h__
 #define __TimedHistory_h__
 
+#include <algorithm>
 #include <cassert>
-#include <deque>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 /*
 design criteria for a buffer containing at least X seconds of history
@@ -21,11 +26,11 @@ design criteria for a buffer containing at least X seconds of history
 - there should be a "clear history" method which also resets the flag
 - the duration of history could (should) be run-time specifiable, and
   would affect the flag
-- the underlying container would be a deque, and it may be useful to
-  occasionally trim it in case it gets giant and then the number of
-  frames required to store drops (so there is a bunch of unused storage)
-- there needs to be a way to access all frames (maybe just direct const
-  access to the underlying deque)
+- the underlying container is a ring buffer whose capacity follows the
+  number of frames the history duration spans at the measured frame rate,
+  so that adding a frame in steady state does no allocation
+- there needs to be a way to access all frames (iteration, or the two
+  contiguous arrays of the ring buffer through contiguousRanges)
 - there needs to be a way to access frames based on "X seconds ago"
   * probably accepting a duration of history and returning a range of frames
 - there needs to be a way of adding frames (and updating the "current time")
@@ -37,111 +42,288 @@ design criteria for a buffer containing at least X seconds of history
 */
 
 // Time can be specified independently, e.g. an unsigned type -- Duration should be signed.
+//
+// The frames live in a ring buffer, most recent first: begin() is the most recent frame and rbegin() the oldest.
+// The capacity is a power of two which only grows, either when a frame arrives while the buffer is full of
+// history that must be kept, or ahead of time through reserveForFrameInterval.  Since timestamps are
+// nondecreasing from rbegin to begin, lookups by age are binary searches.
 template <typename Frame, typename Duration, typename Time = Duration>
-class TimedHistory : private std::deque<std::pair<Time,Frame> > {
+class TimedHistory {
 public:
 
-  typedef std::deque<std::pair<Time,Frame> > TimeAndFramePairDeque;
   typedef std::pair<Time,Frame> TimeAndFramePair;
+  typedef Frame frame_type;
+  typedef Duration duration_type;
+  typedef Time time_type;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
 
-  TimedHistory (Duration historyDuration) : m_historyDuration(historyDuration) { }
-
-  // expose a bunch of the STL container class types and methods
-  typedef typename TimeAndFramePairDeque::size_type size_type;
-  typedef typename TimeAndFramePairDeque::iterator iterator;
-  typedef typename TimeAndFramePairDeque::const_iterator const_iterator;
-  typedef typename TimeAndFramePairDeque::reverse_iterator reverse_iterator;
-  typedef typename TimeAndFramePairDeque::const_reverse_iterator const_reverse_iterator;
-  using TimeAndFramePairDeque::begin;
-  using TimeAndFramePairDeque::end;
-  using TimeAndFramePairDeque::rbegin;
-  using TimeAndFramePairDeque::rend;
-//   using TimeAndFramePairDeque::cbegin;
-//   using TimeAndFramePairDeque::cend;
-//   using TimeAndFramePairDeque::crbegin;
-//   using TimeAndFramePairDeque::crend;
-  using TimeAndFramePairDeque::size;
-  using TimeAndFramePairDeque::empty;
-//   using TimeAndFramePairDeque::shrink_to_fit;
-  using TimeAndFramePairDeque::operator[];
-  using TimeAndFramePairDeque::at;
-  using TimeAndFramePairDeque::front;
-  using TimeAndFramePairDeque::back;
-  using TimeAndFramePairDeque::clear;
+  // random access iterator over the history in most-recent-first order
+  template <typename Value, typename History>
+  class Iterator {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef TimeAndFramePair value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Value* pointer;
+    typedef Value& reference;
+
+    Iterator () : m_history(nullptr), m_index(0) { }
+    Iterator (History *history, size_type index) : m_history(history), m_index(index) { }
+    // allows iterator to const_iterator conversion
+    template <typename OtherValue, typename OtherHistory>
+    Iterator (const Iterator<OtherValue,OtherHistory> &other) : m_history(other.history()), m_index(other.index()) { }
+
+    reference operator* () const { return m_history->slot(m_index); }
+    pointer operator-> () const { return &m_history->slot(m_index); }
+    reference operator[] (difference_type n) const { return m_history->slot(m_index + n); }
+
+    Iterator &operator++ () { ++m_index; return *this; }
+    Iterator &operator-- () { --m_index; return *this; }
+    Iterator operator++ (int) { Iterator it(*this); ++m_index; return it; }
+    Iterator operator-- (int) { Iterator it(*this); --m_index; return it; }
+    Iterator &operator+= (difference_type n) { m_index += n; return *this; }
+    Iterator &operator-= (difference_type n) { m_index -= n; return *this; }
+    Iterator operator+ (difference_type n) const { return Iterator(m_history, m_index + n); }
+    Iterator operator- (difference_type n) const { return Iterator(m_history, m_index - n); }
+
+    template <typename OtherValue, typename OtherHistory>
+    difference_type operator- (const Iterator<OtherValue,OtherHistory> &other) const {
+      return static_cast<difference_type>(m_index) - static_cast<difference_type>(other.index());
+    }
+    template <typename OtherValue, typename OtherHistory>
+    bool operator== (const Iterator<OtherValue,OtherHistory> &other) const { return m_index == other.index(); }
+    template <typename OtherValue, typename OtherHistory>
+    bool operator!= (const Iterator<OtherValue,OtherHistory> &other) const { return m_index != other.index(); }
+    template <typename OtherValue, typename OtherHistory>
+    bool operator< (const Iterator<OtherValue,OtherHistory> &other) const { return m_index < other.index(); }
+    template <typename OtherValue, typename OtherHistory>
+    bool operator> (const Iterator<OtherValue,OtherHistory> &other) const { return m_index > other.index(); }
+    template <typename OtherValue, typename OtherHistory>
+    bool operator<= (const Iterator<OtherValue,OtherHistory> &other) const { return m_index <= other.index(); }
+    template <typename OtherValue, typename OtherHistory>
+    bool operator>= (const Iterator<OtherValue,OtherHistory> &other) const { return m_index >= other.index(); }
+
+    History *history () const { return m_history; }
+    size_type index () const { return m_index; }
+
+  private:
+    History *m_history;
+    size_type m_index;
+  };
+
+  // expose the STL container class types
+  typedef Iterator<TimeAndFramePair,TimedHistory> iterator;
+  typedef Iterator<const TimeAndFramePair,const TimedHistory> const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  TimedHistory (Duration historyDuration, size_type initialCapacity = 16)
+    :
+    m_historyDuration(historyDuration),
+    m_head(0),
+    m_size(0),
+    m_discardCount(0)
+  {
+    m_buffer.resize(roundUpToPowerOfTwo(initialCapacity));
+  }
+
+  iterator begin () { return iterator(this, 0); }
+  iterator end () { return iterator(this, m_size); }
+  const_iterator begin () const { return const_iterator(this, 0); }
+  const_iterator end () const { return const_iterator(this, m_size); }
+  reverse_iterator rbegin () { return reverse_iterator(end()); }
+  reverse_iterator rend () { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin () const { return const_reverse_iterator(end()); }
+  const_reverse_iterator rend () const { return const_reverse_iterator(begin()); }
+
+  size_type size () const { return m_size; }
+  bool empty () const { return m_size == 0; }
+  size_type capacity () const { return m_buffer.size(); }
+  Duration historyDuration () const { return m_historyDuration; }
+
+  // index 0 is the most recent frame
+  TimeAndFramePair &operator[] (size_type index) { return slot(index); }
+  const TimeAndFramePair &operator[] (size_type index) const { return slot(index); }
+  TimeAndFramePair &at (size_type index) {
+    if (index >= m_size) {
+      throw std::out_of_range("TimedHistory::at");
+    }
+    return slot(index);
+  }
+  const TimeAndFramePair &at (size_type index) const {
+    if (index >= m_size) {
+      throw std::out_of_range("TimedHistory::at");
+    }
+    return slot(index);
+  }
+  TimeAndFramePair &front () { return slot(0); }
+  const TimeAndFramePair &front () const { return slot(0); }
+  TimeAndFramePair &back () { return slot(m_size - 1); }
+  const TimeAndFramePair &back () const { return slot(m_size - 1); }
+
+  // keeps the capacity, and so does not release the stored frames until they are overwritten
+  void clear () {
+    m_size = 0;
+    m_discardCount = 0;
+  }
+
+  /// <summary>
+  /// Exposes the history as at most two contiguous arrays which together run from the most recent frame to
+  /// the oldest: first holds firstCount pairs, then second holds secondCount pairs.
+  /// </summary>
+  void contiguousRanges (const TimeAndFramePair *&first, size_type &firstCount, const TimeAndFramePair *&second, size_type &secondCount) const {
+    firstCount = std::min(m_size, m_buffer.size() - m_head);
+    secondCount = m_size - firstCount;
+    first = m_buffer.empty() ? nullptr : &m_buffer[m_head];
+    second = m_buffer.empty() ? nullptr : &m_buffer[0];
+  }
 
   Time oldestFrameTime () const {
     if (empty()) {
       return static_cast<Time>(0); // not really a sentinel value, just a dummy
     } else {
-      return rbegin()->first;
+      return back().first;
     }
   }
   Time mostRecentFrameTime () const {
     if (empty()) {
       return static_cast<Time>(0); // not really a sentinel value, just a dummy
     } else {
-      return begin()->first;
+      return front().first;
     }
   }
   bool hasSufficientHistory () const {
     if (empty()) {
       return false;
     } else {
-      return static_cast<Duration>(begin()->first - rbegin()->first) >= m_historyDuration;
+      return static_cast<Duration>(front().first - back().first) >= m_historyDuration;
     }
   }
+  // returns the most recent frame at least age older than the most recent frame, or end() if there is none
   const_iterator getFrameHavingAgeAtLeast (Duration age) const {
-    // TODO: implement faster search algorithm
-    const_iterator it = begin(); // begin is the most recent
-    if (it == end())
-      return it;
-
-    Time mostRecentTime = it->first; // time of the most recent frame
-    while (it != end() && static_cast<Duration>(mostRecentTime - it->first) < age) {
-      ++it;
+    if (empty()) {
+      return end();
+    }
+    const Time mostRecentTime = front().first;
+    // ages are nondecreasing with the index, so find the first index whose age reaches age
+    size_type low = 0;
+    size_type high = m_size;
+    while (low < high) {
+      const size_type middle = low + (high - low)/2;
+      if (static_cast<Duration>(mostRecentTime - slot(middle).first) < age) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
     }
-    return it; // this may return end()
+    return const_iterator(this, low); // this may return end()
   }
 
   // frames must be added in nondecreasing time order
   void addFrame (Time time, const Frame &frame) {
+    addFrameAndReturnDiscards(time, frame);
+    cleanUpDiscards();
+  }
+
+  /// <summary>
+  /// Adds a frame, and returns the number of frames it pushed out of the history.
+  /// </summary>
+  /// <remarks>
+  /// The discarded frames stay readable through discardsBegin/discardsEnd, oldest last, until cleanUpDiscards
+  /// or the next add.  This is what lets an aggregate over the history subtract the frames that leave it
+  /// instead of recomputing over the whole history each frame (see TimedHistoryWindow).
+  /// </remarks>
+  size_type addFrameAndReturnDiscards (Time time, const Frame &frame) {
     if (!empty()) {
-      assert(time >= begin()->first);
+      assert(time >= front().first);
+    }
+    const size_type previousSize = m_size;
+    purgeExcessHistory(time);
+    m_discardCount = previousSize - m_size;
+    // the new frame takes the slot beyond the oldest discard, so that must not be a discard itself
+    if (previousSize == m_buffer.size()) {
+      grow(2*m_buffer.size());
     }
-    this->push_front(TimeAndFramePair(time, frame));
-    purgeExcessHistory();
+    m_head = (m_head - 1) & (m_buffer.size() - 1);
+    TimeAndFramePair &pair = m_buffer[m_head];
+    pair.first = time;
+    pair.second = frame;
+    ++m_size;
+    return m_discardCount;
+  }
+  // the discarded frames directly follow the retained ones, so an iterator may run on from end() into them
+  const_iterator discardsBegin () const { return end(); }
+  const_iterator discardsEnd () const { return const_iterator(this, m_size + m_discardCount); }
+  size_type discardCount () const { return m_discardCount; }
+  void cleanUpDiscards () {
+    m_discardCount = 0;
   }
-  //void addFrameAndReturnDiscards (const Frame &frame, TimeType frameTime, range-of-frames &X); // or return a deque/vector of frames
-  //void cleanUpDiscards (); // necessary to call after addFrameAndReturnDiscards
 
   void setHistoryDuration (Duration historyDuration) {
     m_historyDuration = historyDuration;
-    purgeExcessHistory();
+    m_discardCount = 0;
+    if (!empty()) {
+      purgeExcessHistory(front().first);
+    }
   }
   // TODO: version of setHistoryDuration which returns discarded frames?
 
+  /// <summary>
+  /// Grows the buffer to hold the history duration at the given interval between frames, so that frames arriving
+  /// at that rate will never cause an allocation.  The capacity is never reduced.
+  /// </summary>
+  void reserveForFrameInterval (Duration frameInterval) {
+    if (frameInterval <= static_cast<Duration>(0)) {
+      return;
+    }
+    // the history keeps one frame beyond the duration, the frame being added makes another, and the one it
+    // discards must stay readable until the add has completed
+    const size_type needed = static_cast<size_type>(m_historyDuration/frameInterval) + 3;
+    if (needed > m_buffer.size()) {
+      grow(roundUpToPowerOfTwo(needed));
+    }
+  }
+
 private:
 
-  void purgeExcessHistory () {
-    if (empty()) {
-      return; // nothing to do
-    }
+  TimeAndFramePair &slot (size_type index) { return m_buffer[(m_head + index) & (m_buffer.size() - 1)]; }
+  const TimeAndFramePair &slot (size_type index) const { return m_buffer[(m_head + index) & (m_buffer.size() - 1)]; }
+
+  // discards the frames which are not needed to cover the history duration once a frame at time is added
+  void purgeExcessHistory (Time mostRecentTime) {
     // ensure that, by looking at the second-to-oldest frame, we will have enough history
     // after popping -- repeat this process until it's no longer true.
-    Time mostRecentTime = begin()->first;
-    reverse_iterator it = rbegin();
-    ++it;
-    while (it != rend() && static_cast<Duration>(mostRecentTime - it->first) >= m_historyDuration) {
-      ++it;
-      this->pop_back();
+    while (m_size >= 2 && static_cast<Duration>(mostRecentTime - slot(m_size - 2).first) >= m_historyDuration) {
+      --m_size;
+    }
+  }
+
+  void grow (size_type newCapacity) {
+    std::vector<TimeAndFramePair> buffer(newCapacity);
+    for (size_type i = 0; i < m_size + m_discardCount; ++i) {
+      buffer[i] = slot(i);
     }
+    m_buffer.swap(buffer);
+    m_head = 0;
   }
 
-  // the oldest frame will be at rbegin, the most recent will be at begin -- referring to the inherited std::deque
+  static size_type roundUpToPowerOfTwo (size_type n) {
+    size_type capacity = 1;
+    while (capacity < n) {
+      capacity <<= 1;
+    }
+    return capacity;
+  }
 
   // the amount of history to keep -- any frames past the first frame that comprise this
   // history duration will be discarded.
   Duration m_historyDuration;
+
+  std::vector<TimeAndFramePair> m_buffer;
+  size_type m_head; // the buffer index of the most recent frame
+  size_type m_size;
+  size_type m_discardCount; // frames beyond m_size which the last add discarded
 };
 
 #endif //__TimedHistory_h__
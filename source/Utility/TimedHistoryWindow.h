@@ -0,0 +1,203 @@
+/*==================================================================================================================
+
+    Copyright (c) 2010 - 2014 Leap Motion. All rights reserved.
+
+  The intellectual and technical concepts contained herein are proprietary and confidential to Leap Motion, and are
+  protected by trade secret or copyright law. Dissemination of this information or reproduction of this material is
+  strictly forbidden unless prior written permission is obtained from Leap Motion.
+
+===================================================================================================================*/
+#ifndef __TimedHistoryWindow_h__
+#define __TimedHistoryWindow_h__
+
+#include "TimedHistory.h"
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/*
+A TimedHistoryWindow maintains an aggregate over the frames of a TimedHistory which are younger than a given age,
+i.e. the frames from begin() up to getFrameHavingAgeAtLeast(age).  Rather than walking that range every frame, the
+window adds each new frame to the aggregate as it arrives and removes frames as they age out of the window, so
+each update costs O(1) amortized regardless of the frame rate.
+
+Any number of windows of different ages may follow the same history.  Each must be updated exactly once after
+every addFrameAndReturnDiscards on the history (and before the discards are cleaned up), and reset whenever the
+history is cleared.  The window age should not exceed the history duration, since frames the history discards
+leave every window.
+
+The Aggregate type provides reset(), add(value) and remove(value), where value is the history's frame type.
+Frames are always removed in the order they were added.
+*/
+template <typename History, typename Aggregate>
+class TimedHistoryWindow {
+public:
+
+  typedef typename History::duration_type Duration;
+  typedef typename History::size_type size_type;
+
+  TimedHistoryWindow (Duration age) : m_age(age), m_count(0), m_sufficientHistory(false) { }
+
+  void update (const History &history) {
+    assert(!history.empty());
+    assert(m_count <= history.size() - 1 + history.discardCount());
+    const typename History::time_type mostRecentTime = history.front().first;
+    m_aggregate.add(history.front().second);
+    ++m_count;
+    // the oldest frame in the window is at index m_count - 1, which lies among the discards if the history
+    // has dropped it
+    typename History::const_iterator oldest = history.begin() + (m_count - 1);
+    while (m_count > 0 && (m_count > history.size() || static_cast<Duration>(mostRecentTime - oldest->first) >= m_age)) {
+      m_aggregate.remove(oldest->second);
+      --m_count;
+      --oldest;
+    }
+    m_sufficientHistory = history.size() > m_count;
+  }
+
+  void reset () {
+    m_aggregate.reset();
+    m_count = 0;
+    m_sufficientHistory = false;
+  }
+
+  // true if the history reaches back to the window age, as when getFrameHavingAgeAtLeast(age) is not end()
+  bool hasSufficientHistory () const { return m_sufficientHistory; }
+  // the number of frames in the window
+  size_type count () const { return m_count; }
+  Duration age () const { return m_age; }
+  const Aggregate &aggregate () const { return m_aggregate; }
+
+private:
+
+  Duration m_age;
+  size_type m_count;
+  bool m_sufficientHistory;
+  Aggregate m_aggregate;
+};
+
+// counts of each category, for values convertible to an index in [0, CATEGORY_COUNT)
+template <typename Category, unsigned int CATEGORY_COUNT>
+class HistogramAggregate {
+public:
+  HistogramAggregate () { reset(); }
+
+  void reset () {
+    m_total = 0;
+    for (unsigned int i = 0; i < CATEGORY_COUNT; ++i) {
+      m_counts[i] = 0;
+    }
+  }
+  void add (const Category &c) { ++m_counts[static_cast<unsigned int>(c)]; ++m_total; }
+  void remove (const Category &c) { --m_counts[static_cast<unsigned int>(c)]; --m_total; }
+
+  size_t count (const Category &c) const { return m_counts[static_cast<unsigned int>(c)]; }
+  size_t total () const { return m_total; }
+  float fraction (const Category &c) const { return m_total ? static_cast<float>(count(c))/m_total : 0.0f; }
+
+private:
+  size_t m_counts[CATEGORY_COUNT];
+  size_t m_total;
+};
+
+// running sum and mean.  For floating-point values, the sum accumulates rounding error over very long runs.
+template <typename T>
+class SumAggregate {
+public:
+  SumAggregate () { reset(); }
+
+  void reset () { m_sum = T(0); m_count = 0; }
+  void add (const T &value) { m_sum += value; ++m_count; }
+  void remove (const T &value) { m_sum -= value; --m_count; }
+
+  const T &sum () const { return m_sum; }
+  size_t count () const { return m_count; }
+  T mean () const { return m_count ? m_sum/static_cast<T>(m_count) : T(0); }
+
+private:
+  T m_sum;
+  size_t m_count;
+};
+
+// minimum and maximum, by keeping monotonic queues of the values which may still become the extreme
+template <typename T>
+class MinMaxAggregate {
+public:
+  MinMaxAggregate () { reset(); }
+
+  void reset () {
+    m_added = 0;
+    m_removed = 0;
+    m_min.clear();
+    m_max.clear();
+  }
+  void add (const T &value) {
+    // a value can never again be the minimum once a smaller one arrives after it; likewise for the maximum
+    while (!m_min.empty() && !(m_min.back().value < value)) {
+      m_min.popBack();
+    }
+    m_min.pushBack(Entry(value, m_added));
+    while (!m_max.empty() && !(value < m_max.back().value)) {
+      m_max.popBack();
+    }
+    m_max.pushBack(Entry(value, m_added));
+    ++m_added;
+  }
+  void remove (const T &) {
+    if (!m_min.empty() && m_min.front().sequence == m_removed) {
+      m_min.popFront();
+    }
+    if (!m_max.empty() && m_max.front().sequence == m_removed) {
+      m_max.popFront();
+    }
+    ++m_removed;
+  }
+
+  bool empty () const { return m_added == m_removed; }
+  // only valid when not empty
+  const T &minimum () const { return m_min.front().value; }
+  const T &maximum () const { return m_max.front().value; }
+
+private:
+  struct Entry {
+    Entry () : sequence(0) { }
+    Entry (const T &v, size_t s) : value(v), sequence(s) { }
+    T value;
+    size_t sequence;
+  };
+
+  // a growable ring of entries, so that steady-state updates do not allocate
+  class EntryQueue {
+  public:
+    EntryQueue () : m_entries(8), m_front(0), m_size(0) { }
+    void clear () { m_front = 0; m_size = 0; }
+    bool empty () const { return m_size == 0; }
+    const Entry &front () const { return m_entries[m_front]; }
+    const Entry &back () const { return m_entries[(m_front + m_size - 1) & (m_entries.size() - 1)]; }
+    void popFront () { m_front = (m_front + 1) & (m_entries.size() - 1); --m_size; }
+    void popBack () { --m_size; }
+    void pushBack (const Entry &entry) {
+      if (m_size == m_entries.size()) {
+        std::vector<Entry> entries(2*m_entries.size());
+        for (size_t i = 0; i < m_size; ++i) {
+          entries[i] = m_entries[(m_front + i) & (m_entries.size() - 1)];
+        }
+        m_entries.swap(entries);
+        m_front = 0;
+      }
+      m_entries[(m_front + m_size) & (m_entries.size() - 1)] = entry;
+      ++m_size;
+    }
+  private:
+    std::vector<Entry> m_entries; // the size is a power of two
+    size_t m_front;
+    size_t m_size;
+  };
+
+  size_t m_added;
+  size_t m_removed;
+  EntryQueue m_min;
+  EntryQueue m_max;
+};
+
+#endif //__TimedHistoryWindow_h__
@@ -0,0 +1,244 @@
+#include "stdafx.h"
+#include "TransitionTrace.h"
+#include "LatencyMonitor.h"
+#include "StateMachine.h"
+#include <boost/thread/mutex.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+static const char MAGIC[4] = {'L', 'P', 'S', 'T'};
+static const uint16_t VERSION = 1;
+
+TransitionTrace::Slot TransitionTrace::s_slots[TransitionTrace::CAPACITY];
+std::atomic<uint64_t> TransitionTrace::s_head(0);
+
+// the names, which are registered once per state machine and only read when dumping
+static boost::mutex s_namesMutex;
+static int          s_machineCount = 0;
+static const char*  s_machineNames[TransitionTrace::MAX_MACHINES];
+static int          s_stateCounts[TransitionTrace::MAX_MACHINES];
+static const char*  s_stateNames[TransitionTrace::MAX_MACHINES][TransitionTrace::MAX_STATES];
+
+int TransitionTrace::RegisterMachine(const char* machineName) {
+  boost::mutex::scoped_lock lock(s_namesMutex);
+  for (int i = 0; i < s_machineCount; i++) {
+    if (std::strcmp(s_machineNames[i], machineName) == 0) {
+      return i;
+    }
+  }
+  if (s_machineCount == MAX_MACHINES) {
+    return -1;
+  }
+  s_machineNames[s_machineCount] = machineName;
+  s_stateCounts[s_machineCount] = 0;
+  return s_machineCount++;
+}
+
+void TransitionTrace::RegisterState(int machine, int state, const char* stateName) {
+  if (machine < 0 || state < 0 || state >= MAX_STATES) {
+    return;
+  }
+  boost::mutex::scoped_lock lock(s_namesMutex);
+  for (int i = s_stateCounts[machine]; i < state; i++) {
+    s_stateNames[machine][i] = "";
+  }
+  s_stateNames[machine][state] = stateName;
+  s_stateCounts[machine] = std::max(s_stateCounts[machine], state + 1);
+}
+
+const char* TransitionTrace::MachineName(int machine) {
+  boost::mutex::scoped_lock lock(s_namesMutex);
+  return machine >= 0 && machine < s_machineCount ? s_machineNames[machine] : "";
+}
+
+const char* TransitionTrace::StateName(int machine, int state) {
+  boost::mutex::scoped_lock lock(s_namesMutex);
+  if (machine < 0 || machine >= s_machineCount || state < 0 || state >= s_stateCounts[machine]) {
+    return "";
+  }
+  return s_stateNames[machine][state];
+}
+
+void TransitionTrace::Add(int machine, int fromState, int toState, uint32_t input, int64_t frameId) {
+  if (machine < 0) {
+    return;
+  }
+  const uint64_t index = s_head.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = s_slots[index & (CAPACITY - 1)];
+  slot.sequence.store(2*index + 1, std::memory_order_relaxed);
+  // the release stores keep the odd sequence ahead of the record, and the record ahead of the even sequence
+  slot.words[0].store(static_cast<uint64_t>(LatencyMonitor::Now()), std::memory_order_release);
+  slot.words[1].store(static_cast<uint64_t>(frameId), std::memory_order_release);
+  slot.words[2].store(input | static_cast<uint64_t>(machine) << 32, std::memory_order_release);
+  slot.words[3].store(static_cast<uint16_t>(fromState) | static_cast<uint64_t>(static_cast<uint16_t>(toState)) << 16,
+                      std::memory_order_release);
+  slot.sequence.store(2*index + 2, std::memory_order_release);
+}
+
+size_t TransitionTrace::Snapshot(Record* records, size_t capacity) {
+  const uint64_t head = s_head.load(std::memory_order_acquire);
+  const uint64_t available = std::min<uint64_t>(head, std::min<uint64_t>(capacity, CAPACITY));
+  size_t count = 0;
+  for (uint64_t index = head - available; index < head; index++) {
+    const Slot& slot = s_slots[index & (CAPACITY - 1)];
+    const uint64_t written = 2*index + 2;
+    if (slot.sequence.load(std::memory_order_acquire) != written) {
+      continue; // still being written, or already overwritten by a newer record
+    }
+    uint64_t words[4];
+    for (int i = 0; i < 4; i++) {
+      words[i] = slot.words[i].load(std::memory_order_acquire);
+    }
+    if (slot.sequence.load(std::memory_order_relaxed) != written) {
+      continue; // overwritten while it was being read
+    }
+    Record& record = records[count++];
+    record.timestamp = static_cast<int64_t>(words[0]);
+    record.frameId = static_cast<int64_t>(words[1]);
+    record.input = static_cast<uint32_t>(words[2]);
+    record.machine = static_cast<uint16_t>(words[2] >> 32);
+    record.fromState = static_cast<int16_t>(words[3] & 0xffff);
+    record.toState = static_cast<int16_t>((words[3] >> 16) & 0xffff);
+    record.reserved = 0;
+    record.reserved2 = 0;
+  }
+  return count;
+}
+
+static bool WriteName(std::FILE* file, const char* name) {
+  const uint16_t length = static_cast<uint16_t>(std::strlen(name));
+  return std::fwrite(&length, sizeof(length), 1, file) == 1 &&
+         std::fwrite(name, 1, length, file) == length;
+}
+
+bool TransitionTrace::Dump(const std::string& fileName) {
+  std::vector<Record> records(CAPACITY);
+  records.resize(Snapshot(&records[0], records.size()));
+
+  std::FILE* file = std::fopen(fileName.c_str(), "wb");
+  if (!file) {
+    return false;
+  }
+  boost::mutex::scoped_lock lock(s_namesMutex);
+  DumpHeader header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.headerSize = sizeof(DumpHeader);
+  header.recordSize = sizeof(Record);
+  header.machineCount = static_cast<uint16_t>(s_machineCount);
+  header.recordCount = static_cast<uint32_t>(records.size());
+  header.transitionCount = TransitionCount();
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+  for (int machine = 0; ok && machine < s_machineCount; machine++) {
+    const uint16_t stateCount = static_cast<uint16_t>(s_stateCounts[machine]);
+    ok = WriteName(file, s_machineNames[machine]) && std::fwrite(&stateCount, sizeof(stateCount), 1, file) == 1;
+    for (int state = 0; ok && state < stateCount; state++) {
+      ok = WriteName(file, s_stateNames[machine][state]);
+    }
+  }
+  if (ok && !records.empty()) {
+    ok = std::fwrite(&records[0], sizeof(Record), records.size(), file) == records.size();
+  }
+  return std::fclose(file) == 0 && ok;
+}
+
+// reads the dump sequentially, failing once anything runs past its end
+class DumpReader {
+public:
+  DumpReader(const std::vector<char>& data) : m_data(data), m_position(0) { }
+  bool Read(void* out, size_t size) {
+    if (m_data.size() - m_position < size) {
+      return false;
+    }
+    std::memcpy(out, &m_data[m_position], size);
+    m_position += size;
+    return true;
+  }
+  bool ReadName(std::string& name) {
+    uint16_t length;
+    if (!Read(&length, sizeof(length)) || m_data.size() - m_position < length) {
+      return false;
+    }
+    name.assign(m_data.begin() + m_position, m_data.begin() + m_position + length);
+    m_position += length;
+    return true;
+  }
+  void Skip(size_t size) { m_position += std::min(size, m_data.size() - m_position); }
+private:
+  const std::vector<char>& m_data;
+  size_t m_position;
+};
+
+static const std::string& NameOf(const std::vector<std::string>& names, int index) {
+  static const std::string none("-");
+  return index >= 0 && index < static_cast<int>(names.size()) ? names[index] : none;
+}
+
+bool TransitionTrace::Decode(const std::string& fileName, std::ostream& stream) {
+  std::vector<char> data;
+  std::FILE* file = std::fopen(fileName.c_str(), "rb");
+  if (!file) {
+    return false;
+  }
+  char buffer[4096];
+  size_t size;
+  while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.insert(data.end(), buffer, buffer + size);
+  }
+  std::fclose(file);
+
+  DumpReader reader(data);
+  DumpHeader header;
+  if (!reader.Read(&header, sizeof(header)) || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header.version != VERSION || header.headerSize < sizeof(DumpHeader) || header.recordSize < sizeof(Record)) {
+    return false;
+  }
+  reader.Skip(header.headerSize - sizeof(DumpHeader));
+
+  std::vector<std::string> machineNames(header.machineCount);
+  std::vector<std::vector<std::string> > stateNames(header.machineCount);
+  for (int machine = 0; machine < header.machineCount; machine++) {
+    uint16_t stateCount;
+    if (!reader.ReadName(machineNames[machine]) || !reader.Read(&stateCount, sizeof(stateCount))) {
+      return false;
+    }
+    stateNames[machine].resize(stateCount);
+    for (int state = 0; state < stateCount; state++) {
+      if (!reader.ReadName(stateNames[machine][state])) {
+        return false;
+      }
+    }
+  }
+
+  stream << header.recordCount << " of " << header.transitionCount << " transitions" << std::endl;
+  int64_t firstTimestamp = 0;
+  for (uint32_t i = 0; i < header.recordCount; i++) {
+    Record record;
+    if (!reader.Read(&record, sizeof(record))) {
+      return false;
+    }
+    reader.Skip(header.recordSize - sizeof(Record));
+    if (i == 0) {
+      firstTimestamp = record.timestamp;
+    }
+    static const std::vector<std::string> noStates;
+    const std::vector<std::string>& states = record.machine < header.machineCount ? stateNames[record.machine] : noStates;
+    stream << std::fixed << std::setprecision(3) << std::setw(12) << (record.timestamp - firstTimestamp)/1e6 << " ms"
+           << "  frame " << std::setw(8) << record.frameId << "  "
+           << NameOf(machineNames, record.machine) << ": "
+           << NameOf(states, record.fromState) << " -> " << NameOf(states, record.toState) << "  on ";
+    if (record.input == SM_ENTER) {
+      stream << "enter";
+    } else if (record.input == SM_EXIT) {
+      stream << "exit";
+    } else {
+      stream << "input " << record.input;
+    }
+    stream << std::endl;
+  }
+  return true;
+}
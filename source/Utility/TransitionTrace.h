@@ -0,0 +1,108 @@
+#if !defined(__TransitionTrace_h__)
+#define __TransitionTrace_h__
+#include "common.h"
+#include <iosfwd>
+#include <string>
+#include ATOMIC_HEADER
+
+/// <summary>
+/// Always-on binary trace of the most recent transitions of every TableStateMachine
+/// </summary>
+/// <remarks>
+/// Each transition is a fixed-size record of when it happened, which state machine made it, the states it
+/// left and entered, the input which caused it and the frame being processed.  Records go into a ring of
+/// CAPACITY slots which the newest overwrite, so the trace uses fixed memory, and recording is a handful of
+/// atomic stores: no lock, no allocation and no formatting, unlike StateMachine's transition logger.
+///
+/// The ring may be written by several threads at once, and is read only on demand.  Each slot carries a
+/// sequence number which is odd while the slot is being written, so a reader skips the slots which are being
+/// overwritten as it reads them instead of returning torn records.
+///
+/// Dump writes the ring to a file together with the names of the state machines and their states, so that
+/// Decode can print it offline.  A dump is a DumpHeader; then, for each state machine, its name and the number
+/// of its states as a uint16_t followed by each state's name, where a name is a uint16_t length followed by its
+/// characters; then the records, oldest first.  All values are little-endian.
+///
+/// The application dumps the ring to transition_dump_file, when that is set, as it shuts down and when an
+/// unhandled exception terminates it.
+/// </remarks>
+class TransitionTrace {
+public:
+  enum {
+    CAPACITY = 4096,                // records, a power of two
+    MAX_MACHINES = 16,
+    MAX_STATES = 64,                // of each state machine
+    NO_STATE = -1                   // the state before a state machine is initialized and after it is shut down
+  };
+
+  struct Record {
+    int64_t  timestamp;             // monotonic nanoseconds, see LatencyMonitor::Now
+    int64_t  frameId;               // -1 if the state machine doesn't know its frame
+    uint32_t input;                 // a StateMachineInput
+    uint16_t machine;
+    int16_t  fromState;
+    int16_t  toState;
+    uint16_t reserved;
+    uint32_t reserved2;
+  };
+
+  struct DumpHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint16_t recordSize;
+    uint16_t machineCount;
+    uint32_t recordCount;
+    uint64_t transitionCount;       // recorded since startup, including those already overwritten
+  };
+
+  /// <summary>
+  /// Names a state machine, returning its id, or -1 if MAX_MACHINES have been registered
+  /// </summary>
+  /// <remarks>
+  /// State machines are identified by name, so every instance of a mode shares an id.  Not for the hot path:
+  /// registration takes a lock.
+  /// </remarks>
+  static int RegisterMachine(const char* machineName);
+  static void RegisterState(int machine, int state, const char* stateName);
+
+  /// <summary>
+  /// Records a transition; safe to call from any thread
+  /// </summary>
+  static void Add(int machine, int fromState, int toState, uint32_t input, int64_t frameId);
+
+  /// <summary>
+  /// Copies up to capacity of the newest records, oldest first, into records and returns how many were copied
+  /// </summary>
+  static size_t Snapshot(Record* records, size_t capacity);
+
+  /// <summary>
+  /// The number of transitions recorded since startup
+  /// </summary>
+  static uint64_t TransitionCount() { return s_head.load(std::memory_order_acquire); }
+
+  /// <summary>
+  /// Writes a snapshot of the ring and the names of the state machines to the named file
+  /// </summary>
+  static bool Dump(const std::string& fileName);
+
+  /// <summary>
+  /// Writes a line per record of the named dump, and returns false if it can't be read
+  /// </summary>
+  static bool Decode(const std::string& fileName, std::ostream& stream);
+
+  static const char* MachineName(int machine);
+  static const char* StateName(int machine, int state);
+
+private:
+  // a Record packed into words, so that it may be written and read with atomic operations alone
+  struct Slot {
+    std::atomic<uint64_t> sequence;   // 2*index + 1 while record index is being written, 2*index + 2 after
+    std::atomic<uint64_t> words[4];
+  };
+
+  static Slot                  s_slots[CAPACITY];
+  static std::atomic<uint64_t> s_head;
+};
+
+#endif // __TransitionTrace_h__
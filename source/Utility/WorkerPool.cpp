@@ -0,0 +1,98 @@
+#include "stdafx.h"
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int workerCount) :
+  m_workerCount(std::max(0, std::min(workerCount, static_cast<int>(MAX_WORKERS)))),
+  m_started(false),
+  m_body(nullptr),
+  m_count(0),
+  m_next(0),
+  m_generation(0),
+  m_busy(0),
+  m_stop(false)
+{
+}
+
+WorkerPool::~WorkerPool() {
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  m_stop = true;
+  m_startCondition.notify_all();
+  lock.unlock();
+
+  m_threads.join_all();
+}
+
+int WorkerPool::DefaultWorkerCount() {
+  const int cores = static_cast<int>(boost::thread::hardware_concurrency());
+  return std::max(0, std::min(cores - 1, static_cast<int>(MAX_WORKERS)));
+}
+
+void WorkerPool::ParallelFor(int count, const std::function<void(int)>& body) {
+  if (count <= INLINE_COUNT || m_workerCount == 0) {
+    for (int i = 0; i < count; i++) {
+      body(i);
+    }
+    return;
+  }
+  if (!m_started) {
+    start();
+  }
+
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  m_body = &body;
+  m_count = count;
+  m_next = 0;
+  m_generation++;
+  m_startCondition.notify_all();
+  lock.unlock();
+
+  runItems(&body, count);
+
+  // Wait for the workers which joined this call to finish their bodies.  Any which join after this see no work.
+  lock.lock();
+  m_doneCondition.wait(lock, [this] () {return m_busy == 0;});
+  m_body = nullptr;
+  m_count = 0;
+}
+
+void WorkerPool::start() {
+  // Workers which start after the first call has already finished see no work, and wait for the next one
+  for (int i = 0; i < m_workerCount; i++) {
+    m_threads.create_thread([this] () {this->loop();});
+  }
+  m_started = true;
+}
+
+void WorkerPool::loop() {
+  uint64_t generation = 0;
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  for (;;) {
+    m_startCondition.wait(lock, [&, this] () {return m_stop || m_generation != generation;});
+    if (m_stop) {
+      return;
+    }
+    generation = m_generation;
+    if (!m_body) {
+      // Woke too late: the call is over, and m_next may be reset for the next one at any moment
+      continue;
+    }
+
+    // Joining under the lock means ParallelFor cannot return, and so cannot reset m_next, until we are done
+    const std::function<void(int)>* body = m_body;
+    const int count = m_count;
+    m_busy++;
+    lock.unlock();
+    runItems(body, count);
+    lock.lock();
+    if (--m_busy == 0) {
+      m_doneCondition.notify_one();
+    }
+  }
+}
+
+void WorkerPool::runItems(const std::function<void(int)>* body, int count) {
+  for (int i = m_next++; i < count; i = m_next++) {
+    (*body)(i);
+  }
+}
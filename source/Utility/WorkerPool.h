@@ -0,0 +1,74 @@
+#if !defined(__WorkerPool_h__)
+#define __WorkerPool_h__
+#include "common.h"
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include ATOMIC_HEADER
+#include FUNCTIONAL_HEADER
+
+/// <summary>
+/// A few persistent threads for splitting short, independent pieces of work across cores
+/// </summary>
+/// <remarks>
+/// The threads are started once, by the first call to ParallelFor which does not run inline, so a pool which
+/// never has enough work to share, such as that of an overlay which is never drawn, costs no threads.  They then
+/// wait on a condition between calls, so a call costs a wakeup rather than a thread creation.  The calling thread
+/// takes part in the work, and claims indices from the same counter as the workers, so a call never waits for a
+/// worker which has yet to wake: the barrier at the end only waits for workers which are still running a body.
+///
+/// ParallelFor is meant to be called from one thread at a time, and the bodies must not call it.
+/// </remarks>
+class WorkerPool {
+public:
+  /// <summary>
+  /// A pool of the given number of workers, started when first needed; with none, every call runs on the calling
+  /// thread
+  /// </summary>
+  explicit WorkerPool(int workerCount = DefaultWorkerCount());
+  ~WorkerPool();
+
+  /// <summary>
+  /// One fewer than the number of cores, so that the calling thread has one to itself, up to MAX_WORKERS
+  /// </summary>
+  static int DefaultWorkerCount();
+
+  int WorkerCount() const { return m_workerCount; }
+
+  /// <summary>
+  /// Calls body with each index from 0 to count - 1, returning once every call has returned
+  /// </summary>
+  /// <remarks>
+  /// The calls are made in no particular order and on any thread.  When there are no more than
+  /// INLINE_COUNT of them, waking the workers would cost more than it saves, so they are made in order on the
+  /// calling thread.
+  /// </remarks>
+  void ParallelFor(int count, const std::function<void(int)>& body);
+
+  static const int MAX_WORKERS = 7;
+  static const int INLINE_COUNT = 2;
+
+private:
+  void start();
+  void loop();
+  void runItems(const std::function<void(int)>* body, int count);
+
+  const int m_workerCount;
+  // only touched by ParallelFor, so it needs no lock
+  bool m_started;
+  boost::thread_group m_threads;
+
+  // The work of the current call, which workers copy when they join it.  Guarded by m_mutex, except for
+  // m_next, which hands out the indices.
+  boost::mutex m_mutex;
+  boost::condition_variable m_startCondition;
+  boost::condition_variable m_doneCondition;
+  const std::function<void(int)>* m_body;
+  int m_count;
+  std::atomic<int> m_next;
+  uint64_t m_generation;
+  int m_busy;
+  bool m_stop;
+};
+
+#endif // __WorkerPool_h__